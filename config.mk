@@ -3,3 +3,6 @@ pio = pio
 
 # clang-format path
 clang-format = clang-format-7
+
+# python 3 path (PlatformIO's one will do)
+python = python3
@@ -0,0 +1,705 @@
+/*
+Host benchmark of the DSDL codecs and libcanard transfers.
+
+For each message type it measures
+- encode: <type>_encode() of a filled in message,
+- decode: <type>_decode() of a transfer received by libcanard, "allocations"
+  are bytes of dynamic arrays taken from `dyn_arr_buf`,
+- roundtrip: encode, canardBroadcast()/canardRequestOrRespond(), all frames
+  passed to canardHandleRxFrame() of another instance and decode, "allocations"
+  are peak libcanard memory pool usage of the sender and receiver.
+
+Results are printed as JSON lines, one object per measurement (see README.md).
+Payloads use dynamic arrays at their max. length, so they are the worst case
+for the firmware.
+*/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_CYCLES 1
+#else
+#define HAVE_CYCLES 0
+#endif
+
+#include "canard.h"
+#include "automation/GetInventory.h"
+#include "automation/GetValues.h"
+#include "automation/SetValues.h"
+#include "automation/Sync.h"
+#include "automation/TellValues.h"
+#include "uavcan/protocol/GetNodeInfo.h"
+#include "uavcan/protocol/GetTransportStats.h"
+#include "uavcan/protocol/NodeStatus.h"
+#include "uavcan/protocol/RestartNode.h"
+#include "uavcan/protocol/debug/LogMessage.h"
+#include "uavcan/protocol/param/ExecuteOpcode.h"
+#include "uavcan/protocol/param/GetSet.h"
+
+#define TX_NODE_ID 10
+#define RX_NODE_ID 20
+#define MEM_POOL_SIZE 4096
+#define DYN_ARR_BUF_SIZE 1024
+#define DEFAULT_ITERATIONS 100000
+
+// any message of the benchmarked types
+typedef union
+{
+    automation_SetValues set_values;
+    automation_TellValues tell_values;
+    automation_GetValuesRequest get_values_req;
+    automation_GetValuesResponse get_values_resp;
+    automation_Sync sync;
+    automation_GetInventoryResponse get_inventory_resp;
+    uavcan_protocol_NodeStatus node_status;
+    uavcan_protocol_GetNodeInfoResponse get_node_info_resp;
+    uavcan_protocol_RestartNodeRequest restart_node_req;
+    uavcan_protocol_RestartNodeResponse restart_node_resp;
+    uavcan_protocol_GetTransportStatsResponse get_transport_stats_resp;
+    uavcan_protocol_debug_LogMessage log_message;
+    uavcan_protocol_param_GetSetRequest get_set_req;
+    uavcan_protocol_param_GetSetResponse get_set_resp;
+    uavcan_protocol_param_ExecuteOpcodeRequest execute_opcode_req;
+} msg_t;
+
+typedef struct
+{
+    const char *type;
+    const char *variant;
+    uint64_t signature;
+    uint16_t data_type_id;
+    CanardTransferType transfer_type;
+    uint16_t max_size;
+    void (*fill)(msg_t *msg);
+    uint32_t (*encode)(msg_t *msg, void *buf);
+    int32_t (*decode)(const CanardRxTransfer *transfer, uint16_t payload_len, msg_t *msg, uint8_t **dyn_arr_buf);
+} codec_t;
+
+// type-safe adapters of the generated functions to codec_t
+#define CODEC_FUNCTIONS(prefix, member)                                                                      \
+    static uint32_t prefix##_enc(msg_t *msg, void *buf)                                                       \
+    {                                                                                                         \
+        return prefix##_encode(&msg->member, buf);                                                            \
+    }                                                                                                         \
+    static int32_t prefix##_dec(const CanardRxTransfer *transfer, uint16_t len, msg_t *msg, uint8_t **dyn)    \
+    {                                                                                                         \
+        return prefix##_decode(transfer, len, &msg->member, dyn);                                             \
+    }
+
+CODEC_FUNCTIONS(automation_SetValues, set_values)
+CODEC_FUNCTIONS(automation_TellValues, tell_values)
+CODEC_FUNCTIONS(automation_GetValuesRequest, get_values_req)
+CODEC_FUNCTIONS(automation_GetValuesResponse, get_values_resp)
+CODEC_FUNCTIONS(automation_Sync, sync)
+CODEC_FUNCTIONS(automation_GetInventoryResponse, get_inventory_resp)
+CODEC_FUNCTIONS(uavcan_protocol_NodeStatus, node_status)
+CODEC_FUNCTIONS(uavcan_protocol_GetNodeInfoResponse, get_node_info_resp)
+CODEC_FUNCTIONS(uavcan_protocol_RestartNodeRequest, restart_node_req)
+CODEC_FUNCTIONS(uavcan_protocol_RestartNodeResponse, restart_node_resp)
+CODEC_FUNCTIONS(uavcan_protocol_GetTransportStatsResponse, get_transport_stats_resp)
+CODEC_FUNCTIONS(uavcan_protocol_debug_LogMessage, log_message)
+CODEC_FUNCTIONS(uavcan_protocol_param_GetSetRequest, get_set_req)
+CODEC_FUNCTIONS(uavcan_protocol_param_GetSetResponse, get_set_resp)
+CODEC_FUNCTIONS(uavcan_protocol_param_ExecuteOpcodeRequest, execute_opcode_req)
+
+static bool bools[AUTOMATION_DIGITALVALUES_VALUES_MAX_LENGTH];
+static uint16_t words[AUTOMATION_ANALOGVALUES_VALUES_MAX_LENGTH];
+static uavcan_protocol_CANIfaceStats iface_stats[UAVCAN_PROTOCOL_GETTRANSPORTSTATS_RESPONSE_CAN_IFACE_STATS_MAX_LENGTH];
+static uint8_t text[256];
+
+static void fill_digital(automation_Values *values)
+{
+    values->union_tag = AUTOMATION_VALUES_DIGITAL_VALUES;
+    values->digital_values.values.len = AUTOMATION_DIGITALVALUES_VALUES_MAX_LENGTH;
+    values->digital_values.values.data = bools;
+}
+
+static void fill_analog(automation_Values *values)
+{
+    values->union_tag = AUTOMATION_VALUES_ANALOG_VALUES;
+    values->analog_values.values.len = AUTOMATION_ANALOGVALUES_VALUES_MAX_LENGTH;
+    values->analog_values.values.data = words;
+}
+
+static void fill_set_values_digital(msg_t *msg)
+{
+    msg->set_values.node_id = RX_NODE_ID;
+    msg->set_values.index = 0;
+    fill_digital(&msg->set_values.values);
+}
+
+static void fill_set_values_analog(msg_t *msg)
+{
+    msg->set_values.node_id = RX_NODE_ID;
+    msg->set_values.index = 0;
+    fill_analog(&msg->set_values.values);
+}
+
+static void fill_tell_values_digital(msg_t *msg)
+{
+    msg->tell_values.port_type.port_type = AUTOMATION_PORTTYPE_INPUT;
+    msg->tell_values.index = 0;
+    fill_digital(&msg->tell_values.values);
+}
+
+static void fill_tell_values_analog(msg_t *msg)
+{
+    msg->tell_values.port_type.port_type = AUTOMATION_PORTTYPE_INPUT;
+    msg->tell_values.index = 0;
+    fill_analog(&msg->tell_values.values);
+}
+
+static void fill_get_values_req(msg_t *msg)
+{
+    msg->get_values_req.port_type.port_type = AUTOMATION_PORTTYPE_INPUT;
+    msg->get_values_req.index = 0;
+    msg->get_values_req.vals_type.value_type = AUTOMATION_VALUETYPE_ANALOG;
+    msg->get_values_req.length = AUTOMATION_ANALOGVALUES_VALUES_MAX_LENGTH;
+}
+
+static void fill_get_values_resp(msg_t *msg)
+{
+    msg->get_values_resp.result = 0;
+    msg->get_values_resp.port_type.port_type = AUTOMATION_PORTTYPE_INPUT;
+    msg->get_values_resp.index = 0;
+    fill_analog(&msg->get_values_resp.values);
+}
+
+static void fill_sync(msg_t *msg)
+{
+    msg->sync.counter = 42;
+}
+
+static void fill_get_inventory_resp(msg_t *msg)
+{
+    msg->get_inventory_resp.dis_num = 64;
+    msg->get_inventory_resp.dos_num = 64;
+    msg->get_inventory_resp.ais_num = 16;
+    msg->get_inventory_resp.aos_num = 16;
+    msg->get_inventory_resp.tell_inputs = true;
+}
+
+static void fill_status(uavcan_protocol_NodeStatus *status)
+{
+    status->uptime_sec = 123456;
+    status->health = UAVCAN_PROTOCOL_NODESTATUS_HEALTH_OK;
+    status->mode = UAVCAN_PROTOCOL_NODESTATUS_MODE_OPERATIONAL;
+    status->sub_mode = 0;
+    status->vendor_specific_status_code = 0x1234;
+}
+
+static void fill_node_status(msg_t *msg)
+{
+    fill_status(&msg->node_status);
+}
+
+static void fill_get_node_info_resp(msg_t *msg)
+{
+    uavcan_protocol_GetNodeInfoResponse *info = &msg->get_node_info_resp;
+
+    memset(info, 0, sizeof(*info));
+    fill_status(&info->status);
+    info->software_version.major = 1;
+    info->software_version.minor = 2;
+    info->software_version.optional_field_flags = UAVCAN_PROTOCOL_SOFTWAREVERSION_OPTIONAL_FIELD_FLAG_VCS_COMMIT;
+    info->software_version.vcs_commit = 0xDEADBEEF;
+    info->hardware_version.major = 1;
+    memset(info->hardware_version.unique_id, 0xA5, sizeof(info->hardware_version.unique_id));
+    // no node sends the certificate
+    info->hardware_version.certificate_of_authenticity.len = 0;
+    info->hardware_version.certificate_of_authenticity.data = text;
+    info->name.len = UAVCAN_PROTOCOL_GETNODEINFO_RESPONSE_NAME_MAX_LENGTH;
+    info->name.data = text;
+}
+
+static void fill_restart_node_req(msg_t *msg)
+{
+    msg->restart_node_req.magic_number = UAVCAN_PROTOCOL_RESTARTNODE_REQUEST_MAGIC_NUMBER;
+}
+
+static void fill_restart_node_resp(msg_t *msg)
+{
+    msg->restart_node_resp.ok = true;
+}
+
+static void fill_get_transport_stats_resp(msg_t *msg)
+{
+    msg->get_transport_stats_resp.transfers_tx = 1000000;
+    msg->get_transport_stats_resp.transfers_rx = 2000000;
+    msg->get_transport_stats_resp.transfer_errors = 3;
+    msg->get_transport_stats_resp.can_iface_stats.len = UAVCAN_PROTOCOL_GETTRANSPORTSTATS_RESPONSE_CAN_IFACE_STATS_MAX_LENGTH;
+    msg->get_transport_stats_resp.can_iface_stats.data = iface_stats;
+}
+
+static void fill_log_message(msg_t *msg)
+{
+    msg->log_message.level.value = UAVCAN_PROTOCOL_DEBUG_LOGLEVEL_WARNING;
+    msg->log_message.source.len = UAVCAN_PROTOCOL_DEBUG_LOGMESSAGE_SOURCE_MAX_LENGTH;
+    msg->log_message.source.data = text;
+    msg->log_message.text.len = UAVCAN_PROTOCOL_DEBUG_LOGMESSAGE_TEXT_MAX_LENGTH;
+    msg->log_message.text.data = text;
+}
+
+static void fill_get_set_req(msg_t *msg)
+{
+    memset(&msg->get_set_req, 0, sizeof(msg->get_set_req));
+    msg->get_set_req.index = 0;
+    msg->get_set_req.value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE;
+    msg->get_set_req.value.integer_value = 100;
+    msg->get_set_req.name.len = UAVCAN_PROTOCOL_PARAM_GETSET_REQUEST_NAME_MAX_LENGTH;
+    msg->get_set_req.name.data = text;
+}
+
+static void fill_get_set_resp(msg_t *msg)
+{
+    uavcan_protocol_param_GetSetResponse *resp = &msg->get_set_resp;
+
+    memset(resp, 0, sizeof(*resp));
+    resp->value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE;
+    resp->value.integer_value = 100;
+    resp->default_value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE;
+    resp->default_value.integer_value = 10;
+    resp->max_value.union_tag = UAVCAN_PROTOCOL_PARAM_NUMERICVALUE_INTEGER_VALUE;
+    resp->max_value.integer_value = 1000;
+    resp->min_value.union_tag = UAVCAN_PROTOCOL_PARAM_NUMERICVALUE_INTEGER_VALUE;
+    resp->min_value.integer_value = 1;
+    resp->name.len = UAVCAN_PROTOCOL_PARAM_GETSET_RESPONSE_NAME_MAX_LENGTH;
+    resp->name.data = text;
+}
+
+static void fill_execute_opcode_req(msg_t *msg)
+{
+    msg->execute_opcode_req.opcode = UAVCAN_PROTOCOL_PARAM_EXECUTEOPCODE_REQUEST_OPCODE_SAVE;
+    msg->execute_opcode_req.argument = 0;
+}
+
+#define CODEC(name, variant_, prefix, id, sig, transfer_type_, max_size_, fill_)                              \
+    {                                                                                                         \
+        .type = name, .variant = variant_, .signature = sig, .data_type_id = id,                              \
+        .transfer_type = transfer_type_, .max_size = max_size_, .fill = fill_, .encode = prefix##_enc,        \
+        .decode = prefix##_dec                                                                                \
+    }
+
+static const codec_t codecs[] = {
+    CODEC("automation.SetValues", "digital", automation_SetValues,
+          AUTOMATION_SETVALUES_ID, AUTOMATION_SETVALUES_SIGNATURE, CanardTransferTypeBroadcast,
+          AUTOMATION_SETVALUES_MAX_SIZE, fill_set_values_digital),
+    CODEC("automation.SetValues", "analog", automation_SetValues,
+          AUTOMATION_SETVALUES_ID, AUTOMATION_SETVALUES_SIGNATURE, CanardTransferTypeBroadcast,
+          AUTOMATION_SETVALUES_MAX_SIZE, fill_set_values_analog),
+    CODEC("automation.TellValues", "digital", automation_TellValues,
+          AUTOMATION_TELLVALUES_ID, AUTOMATION_TELLVALUES_SIGNATURE, CanardTransferTypeBroadcast,
+          AUTOMATION_TELLVALUES_MAX_SIZE, fill_tell_values_digital),
+    CODEC("automation.TellValues", "analog", automation_TellValues,
+          AUTOMATION_TELLVALUES_ID, AUTOMATION_TELLVALUES_SIGNATURE, CanardTransferTypeBroadcast,
+          AUTOMATION_TELLVALUES_MAX_SIZE, fill_tell_values_analog),
+    CODEC("automation.GetValues", "request", automation_GetValuesRequest,
+          AUTOMATION_GETVALUES_ID, AUTOMATION_GETVALUES_SIGNATURE, CanardTransferTypeRequest,
+          AUTOMATION_GETVALUES_REQUEST_MAX_SIZE, fill_get_values_req),
+    CODEC("automation.GetValues", "response", automation_GetValuesResponse,
+          AUTOMATION_GETVALUES_ID, AUTOMATION_GETVALUES_SIGNATURE, CanardTransferTypeResponse,
+          AUTOMATION_GETVALUES_RESPONSE_MAX_SIZE, fill_get_values_resp),
+    CODEC("automation.Sync", "", automation_Sync,
+          AUTOMATION_SYNC_ID, AUTOMATION_SYNC_SIGNATURE, CanardTransferTypeBroadcast,
+          AUTOMATION_SYNC_MAX_SIZE, fill_sync),
+    CODEC("automation.GetInventory", "response", automation_GetInventoryResponse,
+          AUTOMATION_GETINVENTORY_ID, AUTOMATION_GETINVENTORY_SIGNATURE, CanardTransferTypeResponse,
+          AUTOMATION_GETINVENTORY_RESPONSE_MAX_SIZE, fill_get_inventory_resp),
+    CODEC("uavcan.protocol.NodeStatus", "", uavcan_protocol_NodeStatus,
+          UAVCAN_PROTOCOL_NODESTATUS_ID, UAVCAN_PROTOCOL_NODESTATUS_SIGNATURE, CanardTransferTypeBroadcast,
+          UAVCAN_PROTOCOL_NODESTATUS_MAX_SIZE, fill_node_status),
+    CODEC("uavcan.protocol.GetNodeInfo", "response", uavcan_protocol_GetNodeInfoResponse,
+          UAVCAN_PROTOCOL_GETNODEINFO_ID, UAVCAN_PROTOCOL_GETNODEINFO_SIGNATURE, CanardTransferTypeResponse,
+          UAVCAN_PROTOCOL_GETNODEINFO_RESPONSE_MAX_SIZE, fill_get_node_info_resp),
+    CODEC("uavcan.protocol.RestartNode", "request", uavcan_protocol_RestartNodeRequest,
+          UAVCAN_PROTOCOL_RESTARTNODE_ID, UAVCAN_PROTOCOL_RESTARTNODE_SIGNATURE, CanardTransferTypeRequest,
+          UAVCAN_PROTOCOL_RESTARTNODE_REQUEST_MAX_SIZE, fill_restart_node_req),
+    CODEC("uavcan.protocol.RestartNode", "response", uavcan_protocol_RestartNodeResponse,
+          UAVCAN_PROTOCOL_RESTARTNODE_ID, UAVCAN_PROTOCOL_RESTARTNODE_SIGNATURE, CanardTransferTypeResponse,
+          UAVCAN_PROTOCOL_RESTARTNODE_RESPONSE_MAX_SIZE, fill_restart_node_resp),
+    CODEC("uavcan.protocol.GetTransportStats", "response", uavcan_protocol_GetTransportStatsResponse,
+          UAVCAN_PROTOCOL_GETTRANSPORTSTATS_ID, UAVCAN_PROTOCOL_GETTRANSPORTSTATS_SIGNATURE,
+          CanardTransferTypeResponse, UAVCAN_PROTOCOL_GETTRANSPORTSTATS_RESPONSE_MAX_SIZE,
+          fill_get_transport_stats_resp),
+    CODEC("uavcan.protocol.debug.LogMessage", "", uavcan_protocol_debug_LogMessage,
+          UAVCAN_PROTOCOL_DEBUG_LOGMESSAGE_ID, UAVCAN_PROTOCOL_DEBUG_LOGMESSAGE_SIGNATURE,
+          CanardTransferTypeBroadcast, UAVCAN_PROTOCOL_DEBUG_LOGMESSAGE_MAX_SIZE, fill_log_message),
+    CODEC("uavcan.protocol.param.GetSet", "request", uavcan_protocol_param_GetSetRequest,
+          UAVCAN_PROTOCOL_PARAM_GETSET_ID, UAVCAN_PROTOCOL_PARAM_GETSET_SIGNATURE, CanardTransferTypeRequest,
+          UAVCAN_PROTOCOL_PARAM_GETSET_REQUEST_MAX_SIZE, fill_get_set_req),
+    CODEC("uavcan.protocol.param.GetSet", "response", uavcan_protocol_param_GetSetResponse,
+          UAVCAN_PROTOCOL_PARAM_GETSET_ID, UAVCAN_PROTOCOL_PARAM_GETSET_SIGNATURE, CanardTransferTypeResponse,
+          UAVCAN_PROTOCOL_PARAM_GETSET_RESPONSE_MAX_SIZE, fill_get_set_resp),
+    CODEC("uavcan.protocol.param.ExecuteOpcode", "request", uavcan_protocol_param_ExecuteOpcodeRequest,
+          UAVCAN_PROTOCOL_PARAM_EXECUTEOPCODE_ID, UAVCAN_PROTOCOL_PARAM_EXECUTEOPCODE_SIGNATURE,
+          CanardTransferTypeRequest, UAVCAN_PROTOCOL_PARAM_EXECUTEOPCODE_REQUEST_MAX_SIZE,
+          fill_execute_opcode_req),
+};
+
+#define CODECS_LEN (sizeof(codecs) / sizeof(codecs[0]))
+
+
+// timing
+
+typedef struct
+{
+    struct timespec time;
+    uint64_t cycles;
+} stamp_t;
+
+static void stamp(stamp_t *s)
+{
+#if HAVE_CYCLES
+    s->cycles = __rdtsc();
+#else
+    s->cycles = 0;
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &s->time);
+}
+
+static double elapsed_ns(const stamp_t *start, const stamp_t *end)
+{
+    return (end->time.tv_sec - start->time.tv_sec) * 1e9 + (end->time.tv_nsec - start->time.tv_nsec);
+}
+
+
+// result output
+
+typedef struct
+{
+    const char *bench;
+    const codec_t *codec;
+    uint32_t bytes;
+    // CAN frames per transfer
+    uint32_t frames;
+    uint32_t iterations;
+    stamp_t start;
+    stamp_t end;
+    // bytes of dynamic arrays per decode
+    uint32_t alloc_bytes;
+    // peak memory pools usage of roundtrip [blocks]
+    uint16_t tx_pool_peak;
+    uint16_t rx_pool_peak;
+} result_t;
+
+static void print_result(const result_t *r)
+{
+    const double ns = elapsed_ns(&r->start, &r->end);
+    const double ns_per_op = ns / r->iterations;
+
+    printf("{\"bench\":\"%s\",\"type\":\"%s\",\"variant\":\"%s\",\"bytes\":%u,\"frames\":%u,"
+           "\"iterations\":%u,\"ns_per_op\":%.1f,",
+           r->bench, r->codec->type, r->codec->variant, r->bytes, r->frames, r->iterations, ns_per_op);
+#if HAVE_CYCLES
+    printf("\"cycles_per_op\":%.1f,", (double)(r->end.cycles - r->start.cycles) / r->iterations);
+#else
+    printf("\"cycles_per_op\":null,");
+#endif
+    printf("\"mb_per_s\":%.2f,\"frames_per_s\":%.0f,\"alloc_bytes\":%u,"
+           "\"tx_pool_peak_bytes\":%u,\"rx_pool_peak_bytes\":%u}\n",
+           r->bytes * 1e3 / ns_per_op,
+           (strcmp(r->bench, "roundtrip") == 0) ? r->frames * 1e9 / ns_per_op : 0,
+           r->alloc_bytes,
+           r->tx_pool_peak * CANARD_MEM_BLOCK_SIZE,
+           r->rx_pool_peak * CANARD_MEM_BLOCK_SIZE);
+}
+
+
+// libcanard instances
+
+typedef enum
+{
+    MODE_DECODE,
+    MODE_ROUNDTRIP
+} bench_mode_t;
+
+typedef struct
+{
+    const codec_t *codec;
+    bench_mode_t mode;
+    uint32_t iterations;
+    uint8_t payload[512];
+    uint32_t payload_len;
+    uint32_t received;
+    bool failed;
+    result_t *result;
+} bench_t;
+
+static CanardInstance tx_ins;
+static CanardInstance rx_ins;
+static uint8_t tx_pool[MEM_POOL_SIZE];
+static uint8_t rx_pool[MEM_POOL_SIZE];
+static uint64_t now_usec;
+static volatile uint32_t sink;
+
+static bool should_accept(const CanardInstance *ins,
+                          uint64_t *out_data_type_signature,
+                          uint16_t data_type_id,
+                          CanardTransferType transfer_type,
+                          uint8_t source_node_id)
+{
+    bench_t *b = canardGetUserReference((CanardInstance *)ins);
+
+    (void)source_node_id;
+    if (data_type_id == b->codec->data_type_id && transfer_type == b->codec->transfer_type)
+    {
+        *out_data_type_signature = b->codec->signature;
+        return true;
+    }
+    return false;
+}
+
+// decodes and checks that the message encodes to the same payload
+static bool decode_checked(bench_t *b, CanardRxTransfer *transfer)
+{
+    msg_t msg;
+    uint8_t dyn_buf[DYN_ARR_BUF_SIZE];
+    uint8_t *dyn = dyn_buf;
+    uint8_t encoded[512] = {0};
+
+    if (b->codec->decode(transfer, transfer->payload_len, &msg, &dyn) < 0)
+    {
+        return false;
+    }
+    b->result->alloc_bytes = dyn - dyn_buf;
+    return b->codec->encode(&msg, encoded) == b->payload_len && memcmp(encoded, b->payload, b->payload_len) == 0;
+}
+
+static void on_reception(CanardInstance *ins, CanardRxTransfer *transfer)
+{
+    bench_t *b = canardGetUserReference(ins);
+
+    b->received++;
+    if (b->mode == MODE_ROUNDTRIP)
+    {
+        msg_t msg;
+        uint8_t dyn_buf[DYN_ARR_BUF_SIZE];
+        uint8_t *dyn = dyn_buf;
+
+        sink += b->codec->decode(transfer, transfer->payload_len, &msg, &dyn);
+        canardReleaseRxTransferPayload(ins, transfer);
+        return;
+    }
+
+    if (!decode_checked(b, transfer))
+    {
+        b->failed = true;
+    }
+
+    stamp(&b->result->start);
+    for (uint32_t i = 0; i < b->iterations; i++)
+    {
+        msg_t msg;
+        uint8_t dyn_buf[DYN_ARR_BUF_SIZE];
+        uint8_t *dyn = dyn_buf;
+
+        sink += b->codec->decode(transfer, transfer->payload_len, &msg, &dyn);
+    }
+    stamp(&b->result->end);
+    canardReleaseRxTransferPayload(ins, transfer);
+}
+
+static void init_instances(bench_t *b)
+{
+    canardInit(&tx_ins, tx_pool, sizeof(tx_pool), on_reception, should_accept, b);
+    canardSetLocalNodeID(&tx_ins, TX_NODE_ID);
+    canardInit(&rx_ins, rx_pool, sizeof(rx_pool), on_reception, should_accept, b);
+    canardSetLocalNodeID(&rx_ins, RX_NODE_ID);
+}
+
+// queues `b->payload` in tx_ins as a transfer to rx_ins
+static int16_t send(bench_t *b, uint8_t *transfer_id)
+{
+    const codec_t *c = b->codec;
+
+    if (c->transfer_type == CanardTransferTypeBroadcast)
+    {
+        return canardBroadcast(&tx_ins, c->signature, c->data_type_id, transfer_id,
+                               CANARD_TRANSFER_PRIORITY_MEDIUM, b->payload, b->payload_len);
+    }
+
+    const CanardRequestResponse kind = (c->transfer_type == CanardTransferTypeRequest) ? CanardRequest : CanardResponse;
+    int16_t res = canardRequestOrRespond(&tx_ins, RX_NODE_ID, c->signature, c->data_type_id, transfer_id,
+                                         CANARD_TRANSFER_PRIORITY_MEDIUM, kind, b->payload, b->payload_len);
+    // responses reuse the request transfer ID, act as a stream of requests
+    if (kind == CanardResponse)
+    {
+        *transfer_id = (*transfer_id + 1) & 31;
+    }
+    return res;
+}
+
+// passes all frames of tx_ins queue to rx_ins, returns the number of frames
+static uint32_t deliver(bench_t *b)
+{
+    uint32_t frames = 0;
+
+    for (const CanardCANFrame *frame; (frame = canardPeekTxQueue(&tx_ins)) != NULL;)
+    {
+        now_usec += 100;
+        if (canardHandleRxFrame(&rx_ins, frame, now_usec) < 0)
+        {
+            b->failed = true;
+        }
+        canardPopTxQueue(&tx_ins);
+        frames++;
+    }
+    return frames;
+}
+
+
+// benchmarks
+
+static bool bench_encode(const codec_t *c, uint32_t iterations)
+{
+    msg_t msg;
+    uint8_t buf[512];
+    result_t r = {.bench = "encode", .codec = c, .iterations = iterations};
+
+    c->fill(&msg);
+    r.bytes = c->encode(&msg, buf);
+    stamp(&r.start);
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        sink += c->encode(&msg, buf);
+    }
+    stamp(&r.end);
+    print_result(&r);
+    return r.bytes <= c->max_size;
+}
+
+static bool bench_decode(const codec_t *c, uint32_t iterations)
+{
+    msg_t msg;
+    result_t r = {.bench = "decode", .codec = c, .iterations = iterations};
+    bench_t b = {.codec = c, .mode = MODE_DECODE, .iterations = iterations, .result = &r};
+    uint8_t transfer_id = 0;
+
+    c->fill(&msg);
+    b.payload_len = c->encode(&msg, b.payload);
+    r.bytes = b.payload_len;
+    init_instances(&b);
+    if (send(&b, &transfer_id) < 0)
+    {
+        return false;
+    }
+    r.frames = deliver(&b);
+    if (b.failed || b.received != 1)
+    {
+        return false;
+    }
+    print_result(&r);
+    return true;
+}
+
+static bool bench_roundtrip(const codec_t *c, uint32_t iterations)
+{
+    msg_t msg;
+    result_t r = {.bench = "roundtrip", .codec = c, .iterations = iterations};
+    bench_t b = {.codec = c, .mode = MODE_ROUNDTRIP, .result = &r};
+    uint8_t transfer_id = 0;
+    uint32_t frames = 0;
+    CanardPoolAllocatorStatistics tx_stats, rx_stats;
+
+    c->fill(&msg);
+    init_instances(&b);
+    stamp(&r.start);
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        b.payload_len = c->encode(&msg, b.payload);
+        if (send(&b, &transfer_id) < 0)
+        {
+            return false;
+        }
+        frames += deliver(&b);
+    }
+    stamp(&r.end);
+    if (b.failed || b.received != iterations)
+    {
+        return false;
+    }
+
+    tx_stats = canardGetPoolAllocatorStatistics(&tx_ins);
+    rx_stats = canardGetPoolAllocatorStatistics(&rx_ins);
+    r.bytes = b.payload_len;
+    r.frames = frames / iterations;
+    r.tx_pool_peak = tx_stats.peak_usage_blocks;
+    r.rx_pool_peak = rx_stats.peak_usage_blocks;
+    print_result(&r);
+    return true;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-n ITERATIONS] [TYPE_FILTER]\n"
+            "Benchmarks types whose name contains TYPE_FILTER (all by default).\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = DEFAULT_ITERATIONS;
+    const char *filter = "";
+    int failures = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            iterations = strtoul(argv[++i], NULL, 0);
+        }
+        else if (argv[i][0] != '-')
+        {
+            filter = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (iterations == 0)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    for (size_t i = 0; i < sizeof(text); i++)
+    {
+        text[i] = 'a' + i % 26;
+    }
+    for (size_t i = 0; i < AUTOMATION_DIGITALVALUES_VALUES_MAX_LENGTH; i++)
+    {
+        bools[i] = i % 3 == 0;
+    }
+    for (size_t i = 0; i < AUTOMATION_ANALOGVALUES_VALUES_MAX_LENGTH; i++)
+    {
+        words[i] = i * 4099;
+    }
+
+    printf("{\"bench\":\"meta\",\"compiler\":\"%s\",\"cycles\":%s,\"mem_block_size\":%u,\"iterations\":%u}\n",
+           __VERSION__, HAVE_CYCLES ? "\"tsc\"" : "null", CANARD_MEM_BLOCK_SIZE, iterations);
+
+    for (size_t i = 0; i < CODECS_LEN; i++)
+    {
+        const codec_t *c = &codecs[i];
+
+        if (strstr(c->type, filter) == NULL)
+        {
+            continue;
+        }
+        if (!bench_encode(c, iterations) || !bench_decode(c, iterations) || !bench_roundtrip(c, iterations))
+        {
+            fflush(stdout);
+            fprintf(stderr, "%s %s: transfer or codec check failed\n", c->type, c->variant);
+            failures++;
+        }
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,192 @@
+/*
+Host check of the packed bool arrays codec (uavcan_bool_array.c) against the
+generic one, a 1 bit canardEncodeScalar() / canardDecodeScalar() call per item.
+
+Encoding is checked at bit offsets 0..MAX_OFFSET for all lengths up to
+AUTOMATION_DIGITALVALUES_VALUES_MAX_LENGTH, into buffers of random bits (the
+surrounding bits must be kept). Decoding is checked the same way on single and
+multi frame transfers received by libcanard. Returns 1 on a mismatch.
+*/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "canard.h"
+#include "automation/DigitalValues.h"
+#include "uavcan_bool_array.h"
+
+#define MAX_LEN AUTOMATION_DIGITALVALUES_VALUES_MAX_LENGTH
+#define MAX_OFFSET 40
+#define PATTERNS 16
+// multi frame transfers are checked with payloads of this length
+#define PAYLOAD_LEN ((MAX_OFFSET + MAX_LEN + 7) / 8 + 8)
+
+#define TEST_DATA_TYPE_ID 20000
+#define TEST_SIGNATURE 0x0123456789ABCDEFULL
+
+static unsigned failures;
+
+static void fill_random(void *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        ((uint8_t *)buf)[i] = (uint8_t)rand();
+    }
+}
+
+static void random_values(bool *values, uint8_t len, unsigned pattern)
+{
+    for (uint8_t i = 0; i < len; i++)
+    {
+        // all false, all true and random
+        values[i] = (pattern == 0) ? false : (pattern == 1) ? true : rand() & 1;
+    }
+}
+
+static void fail(const char *what, uint32_t offset, uint8_t len, unsigned pattern)
+{
+    if (failures++ < 10)
+    {
+        fprintf(stderr, "%s mismatch: offset %u, len %u, pattern %u\n", what, offset, len, pattern);
+    }
+}
+
+static uint32_t generic_encode(void *msg_buf, uint32_t offset, const bool *values, uint8_t len)
+{
+    for (uint8_t i = 0; i < len; i++)
+    {
+        canardEncodeScalar(msg_buf, offset++, 1, &values[i]);
+    }
+    return offset;
+}
+
+static int32_t generic_decode(const CanardRxTransfer *transfer, uint32_t offset, bool *values, uint8_t len)
+{
+    for (uint8_t i = 0; i < len; i++)
+    {
+        int16_t ret = canardDecodeScalar(transfer, offset++, 1, false, &values[i]);
+        if (ret != 1)
+        {
+            return (ret < 0) ? ret : -CANARD_ERROR_INTERNAL;
+        }
+    }
+    return (int32_t)offset;
+}
+
+static void check_encode(void)
+{
+    uint8_t generic[PAYLOAD_LEN], packed[PAYLOAD_LEN];
+    bool values[MAX_LEN];
+
+    for (unsigned pattern = 0; pattern < PATTERNS; pattern++)
+    {
+        for (uint32_t offset = 0; offset <= MAX_OFFSET; offset++)
+        {
+            for (uint8_t len = 0; len <= MAX_LEN; len++)
+            {
+                random_values(values, len, pattern);
+                fill_random(generic, sizeof(generic));
+                memcpy(packed, generic, sizeof(packed));
+                if (generic_encode(generic, offset, values, len) != uavcan_encode_bool_array(packed, offset, values, len) ||
+                    memcmp(generic, packed, sizeof(packed)) != 0)
+                {
+                    fail("encode", offset, len, pattern);
+                }
+            }
+        }
+    }
+}
+
+static void check_decode_transfer(const CanardRxTransfer *transfer)
+{
+    bool generic[MAX_LEN], packed[MAX_LEN];
+
+    for (uint32_t offset = 0; offset <= MAX_OFFSET; offset++)
+    {
+        for (uint8_t len = 0; len <= MAX_LEN; len++)
+        {
+            int32_t generic_res = generic_decode(transfer, offset, generic, len);
+            int32_t packed_res = uavcan_decode_bool_array(transfer, offset, packed, len);
+
+            // both fail when the payload is too short
+            if ((generic_res < 0) != (packed_res < 0) ||
+                (generic_res >= 0 && (generic_res != packed_res || memcmp(generic, packed, len) != 0)))
+            {
+                fail("decode", offset, len, transfer->payload_len);
+            }
+        }
+    }
+}
+
+static unsigned transfers;
+
+static bool should_accept(const CanardInstance *ins,
+                          uint64_t *out_data_type_signature,
+                          uint16_t data_type_id,
+                          CanardTransferType transfer_type,
+                          uint8_t source_node_id)
+{
+    (void)ins;
+    (void)source_node_id;
+    *out_data_type_signature = TEST_SIGNATURE;
+    return data_type_id == TEST_DATA_TYPE_ID && transfer_type == CanardTransferTypeBroadcast;
+}
+
+static void on_reception(CanardInstance *ins, CanardRxTransfer *transfer)
+{
+    transfers++;
+    check_decode_transfer(transfer);
+    canardReleaseRxTransferPayload(ins, transfer);
+}
+
+static void check_decode(void)
+{
+    static uint8_t tx_pool[1024], rx_pool[1024];
+    CanardInstance tx, rx;
+    uint8_t payload[PAYLOAD_LEN];
+    uint8_t transfer_id = 0;
+    uint64_t now_usec = 1;
+    unsigned sent = 0;
+
+    canardInit(&tx, tx_pool, sizeof(tx_pool), on_reception, should_accept, NULL);
+    canardSetLocalNodeID(&tx, 10);
+    canardInit(&rx, rx_pool, sizeof(rx_pool), on_reception, should_accept, NULL);
+    canardSetLocalNodeID(&rx, 20);
+
+    for (unsigned pattern = 0; pattern < PATTERNS; pattern++)
+    {
+        // single frame and multi frame transfers
+        for (uint16_t len = 1; len <= PAYLOAD_LEN; len += 6)
+        {
+            fill_random(payload, len);
+            if (canardBroadcast(&tx, TEST_SIGNATURE, TEST_DATA_TYPE_ID, &transfer_id,
+                                CANARD_TRANSFER_PRIORITY_LOW, payload, len) < 0)
+            {
+                fprintf(stderr, "canardBroadcast failed\n");
+                failures++;
+                return;
+            }
+            sent++;
+            for (const CanardCANFrame *frame; (frame = canardPeekTxQueue(&tx)) != NULL; canardPopTxQueue(&tx))
+            {
+                canardHandleRxFrame(&rx, frame, now_usec += 100);
+            }
+        }
+    }
+    if (transfers != sent)
+    {
+        fprintf(stderr, "%u of %u transfers received\n", transfers, sent);
+        failures++;
+    }
+}
+
+int main(void)
+{
+    srand(1);
+    check_encode();
+    check_decode();
+    printf("bool arrays codec: %s (%u transfers)\n", failures ? "FAILED" : "OK", transfers);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+/*
+Host check of the remote nodes table (uavcan_node_table.c) with more nodes on
+the bus than table entries (UAVCAN_NODE_TABLE_SIZE 2, as on AVR slaves).
+
+Two other slaves fill the table before the master is heard of, the master is
+then pinned (as WITH_FAILSAFE slave firmware does) and its OFFLINE and RESTARTED
+events must still be reported. Returns 1 on a failure.
+*/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "uavcan_node.h"
+
+#if !UAVCAN_WITH_NODE_TABLE || UAVCAN_NODE_TABLE_SIZE != 2
+#error "build with -DUAVCAN_WITH_NODE_TABLE=1 -DUAVCAN_NODE_TABLE_SIZE=2"
+#endif
+
+#define MASTER 50
+#define SLAVE_A 52
+#define SLAVE_B 53
+#define SLAVE_C 54
+
+uavcan_node_t uavcan_default_node;
+
+static uint64_t now_usec;
+static unsigned failures;
+
+// the last event per node ID
+static int events[128];
+static unsigned events_count;
+
+uint64_t uavcan_uptime_usec(void)
+{
+    return now_usec;
+}
+
+void uavcan_on_remote_node_event(uint8_t node_id,
+                                 uavcan_remote_node_event_t event,
+                                 const uavcan_remote_node_t *remote)
+{
+    events[node_id] = event;
+    events_count++;
+}
+
+static void check(bool ok, const char *what)
+{
+    if (!ok)
+    {
+        failures++;
+        fprintf(stderr, "FAILED: %s\n", what);
+    }
+}
+
+static void node_status(uint8_t node_id, uint32_t uptime_sec)
+{
+    uavcan_protocol_NodeStatus status;
+
+    memset(&status, 0, sizeof(status));
+    status.uptime_sec = uptime_sec;
+    uavcan_node_table_status(&uavcan_default_node.node_table, node_id, &status, now_usec);
+}
+
+// advance time by `ms`, others broadcast NodeStatus every 1 s
+static void run(uint32_t ms, bool master_alive, uint32_t master_uptime_base)
+{
+    for (uint32_t t = 0; t < ms; t += 100)
+    {
+        now_usec += 100 * 1000ULL;
+        if (now_usec % 1000000ULL == 0)
+        {
+            uint32_t uptime = now_usec / 1000000ULL;
+            node_status(SLAVE_A, uptime);
+            node_status(SLAVE_B, uptime);
+            node_status(SLAVE_C, uptime);
+            if (master_alive)
+            {
+                node_status(MASTER, uptime - master_uptime_base);
+            }
+        }
+        uavcan_node_table_update(&uavcan_default_node.node_table);
+    }
+}
+
+int main(void)
+{
+    memset(events, 0xff, sizeof(events));
+    now_usec = 1000ULL * 1000;
+
+    // other slaves fill the table first (e.g. PLC restarting)
+    run(2000, false, 0);
+    check(uavcan_get_remote_node(SLAVE_A) && uavcan_get_remote_node(SLAVE_B), "slaves tracked");
+    check(uavcan_get_node_table()->overflows > 0, "slave C overflows");
+
+    // the master sets outputs, it's pinned and tracked from its NodeStatus on
+    check(uavcan_pin_remote_node(MASTER, true), "master pinned");
+    run(5000, true, 0);
+    const uavcan_remote_node_t *master = uavcan_get_remote_node(MASTER);
+    check(master != NULL && master->online, "master online");
+    check(master != NULL && master->interval == 1000, "master interval");
+
+    // master restarts
+    run(2000, true, 6);
+    check(events[MASTER] == UAVCAN_REMOTE_NODE_RESTARTED, "master restart reported");
+
+    // master goes offline while other nodes keep broadcasting
+    run(UAVCAN_NODE_TIMEOUT + 1000, false, 0);
+    check(events[MASTER] == UAVCAN_REMOTE_NODE_OFFLINE, "master offline reported");
+    check(uavcan_get_remote_node(MASTER) != NULL, "offline master kept");
+
+    // an unpinned offline master makes room for other nodes
+    uavcan_pin_remote_node(MASTER, false);
+    run(5000, false, 0);
+    check(uavcan_get_remote_node(MASTER) == NULL, "unpinned master replaced");
+
+    // a master which never sends NodeStatus after it's pinned goes offline too
+    events[MASTER] = -1;
+    check(uavcan_pin_remote_node(MASTER, true), "master pinned again");
+    run(UAVCAN_NODE_TIMEOUT + 1000, false, 0);
+    check(events[MASTER] == UAVCAN_REMOTE_NODE_OFFLINE, "silent pinned master offline");
+
+    printf("node table: %u events, %s\n", events_count, failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
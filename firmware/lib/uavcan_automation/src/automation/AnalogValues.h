@@ -17,32 +17,33 @@ extern "C"
 #endif
 
 /******************************* Source text **********************************
-# Shoud be dynamic array but I got coredumps with dynamic array decoding.
-# 32+6 bits fit into one packet for all contexts it is used in
-uint2 values_len
-uint16[2] values
+# Up to 16 values (256+5 bits) make a multi-frame transfer, but one GetValues
+# request can fetch whole analog input image of a common node.
+uint16[<=16] values
 ******************************************************************************/
 
 /********************* DSDL signature source definition ***********************
 automation.AnalogValues
-saturated uint2 values_len
-saturated uint16[2] values
+saturated uint16[<=16] values
 ******************************************************************************/
 
 #define AUTOMATION_ANALOGVALUES_NAME                       "automation.AnalogValues"
-#define AUTOMATION_ANALOGVALUES_SIGNATURE                  (0x192B9898F4134A94ULL)
+#define AUTOMATION_ANALOGVALUES_SIGNATURE                  (0x21C4E1D8C5D7547AULL)
 
-#define AUTOMATION_ANALOGVALUES_MAX_SIZE                   ((34 + 7)/8)
+#define AUTOMATION_ANALOGVALUES_MAX_SIZE                   ((261 + 7)/8)
 
 // Constants
 
-#define AUTOMATION_ANALOGVALUES_VALUES_LENGTH                                            2
+#define AUTOMATION_ANALOGVALUES_VALUES_MAX_LENGTH                                        16
 
 typedef struct
 {
     // FieldTypes
-    uint8_t    values_len;                    // bit len 2
-    uint16_t   values[2];                     // Static Array 16bit[2] max items
+    struct
+    {
+        uint8_t    len;                       // Dynamic array length
+        uint16_t*  data;                      // Dynamic Array 16bit[16] max items
+    } values;
 
 } automation_AnalogValues;
 
@@ -17,33 +17,35 @@ extern "C"
 #endif
 
 /******************************* Source text **********************************
-# Shoud be dynamic array but dynamic bool arrays compilation is broken.
+# Dynamic bool arrays compilation is broken in the code generator, codecs were
+# fixed by hand.
 # see: https://github.com/UAVCAN/libcanard/issues/135
-# 32+6 bits fit into one packet for all contexts it is used in
-uint6 values_len
-bool[32] values
+# The length matches GetValues.length limit.
+bool[<=63] values
 ******************************************************************************/
 
 /********************* DSDL signature source definition ***********************
 automation.DigitalValues
-saturated uint6 values_len
-saturated bool[32] values
+saturated bool[<=63] values
 ******************************************************************************/
 
 #define AUTOMATION_DIGITALVALUES_NAME                      "automation.DigitalValues"
-#define AUTOMATION_DIGITALVALUES_SIGNATURE                 (0xE02C971A9499EC08ULL)
+#define AUTOMATION_DIGITALVALUES_SIGNATURE                 (0x9941F1D77A5F2A4BULL)
 
-#define AUTOMATION_DIGITALVALUES_MAX_SIZE                  ((38 + 7)/8)
+#define AUTOMATION_DIGITALVALUES_MAX_SIZE                  ((69 + 7)/8)
 
 // Constants
 
-#define AUTOMATION_DIGITALVALUES_VALUES_LENGTH                                           32
+#define AUTOMATION_DIGITALVALUES_VALUES_MAX_LENGTH                                       63
 
 typedef struct
 {
     // FieldTypes
-    uint8_t    values_len;                    // bit len 6
-    bool       values[32];                    // Static Array 1bit[32] max items
+    struct
+    {
+        uint8_t    len;                       // Dynamic array length
+        bool*      data;                      // Dynamic Array 1bit[63] max items
+    } values;
 
 } automation_DigitalValues;
 
@@ -0,0 +1,98 @@
+/*
+ * UAVCAN data structure definition for libcanard.
+ *
+ * Autogenerated, do not edit.
+ *
+ */
+
+#ifndef __AUTOMATION_GETINVENTORY
+#define __AUTOMATION_GETINVENTORY
+
+#include <stdint.h>
+#include "canard.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/******************************* Source text **********************************
+# I/O inventory of a node. PLC asks every node it discovers, so remote blocks
+# don't have to be configured by hand.
+
+---
+
+# number of DIs, DOs, AIs and AOs (indices 0 .. num-1 of GetValues, SetValues)
+uint8 dis_num
+uint8 dos_num
+uint8 ais_num
+uint8 aos_num
+
+# inputs are reported by the node on change (TellValues), don't poll them
+bool tell_inputs
+******************************************************************************/
+
+/********************* DSDL signature source definition ***********************
+automation.GetInventory
+---
+saturated uint8 dis_num
+saturated uint8 dos_num
+saturated uint8 ais_num
+saturated uint8 aos_num
+saturated bool tell_inputs
+******************************************************************************/
+
+#define AUTOMATION_GETINVENTORY_ID                         201
+#define AUTOMATION_GETINVENTORY_NAME                       "automation.GetInventory"
+#define AUTOMATION_GETINVENTORY_SIGNATURE                  (0x4F66A9B0180C4CDULL)
+
+#define AUTOMATION_GETINVENTORY_REQUEST_MAX_SIZE           ((0 + 7)/8)
+
+typedef struct
+{
+    uint8_t empty;
+} automation_GetInventoryRequest;
+
+extern
+uint32_t automation_GetInventoryRequest_encode(automation_GetInventoryRequest* source, void* msg_buf);
+
+extern
+int32_t automation_GetInventoryRequest_decode(const CanardRxTransfer* transfer, uint16_t payload_len, automation_GetInventoryRequest* dest, uint8_t** dyn_arr_buf);
+
+extern
+uint32_t automation_GetInventoryRequest_encode_internal(automation_GetInventoryRequest* source, void* msg_buf, uint32_t offset, uint8_t root_item);
+
+extern
+int32_t automation_GetInventoryRequest_decode_internal(const CanardRxTransfer* transfer, uint16_t payload_len, automation_GetInventoryRequest* dest, uint8_t** dyn_arr_buf, int32_t offset);
+
+#define AUTOMATION_GETINVENTORY_RESPONSE_MAX_SIZE          ((33 + 7)/8)
+
+// Constants
+
+typedef struct
+{
+    // FieldTypes
+    uint8_t    dis_num;                       // bit len 8
+    uint8_t    dos_num;                       // bit len 8
+    uint8_t    ais_num;                       // bit len 8
+    uint8_t    aos_num;                       // bit len 8
+    bool       tell_inputs;                   // bit len 1
+
+} automation_GetInventoryResponse;
+
+extern
+uint32_t automation_GetInventoryResponse_encode(automation_GetInventoryResponse* source, void* msg_buf);
+
+extern
+int32_t automation_GetInventoryResponse_decode(const CanardRxTransfer* transfer, uint16_t payload_len, automation_GetInventoryResponse* dest, uint8_t** dyn_arr_buf);
+
+extern
+uint32_t automation_GetInventoryResponse_encode_internal(automation_GetInventoryResponse* source, void* msg_buf, uint32_t offset, uint8_t root_item);
+
+extern
+int32_t automation_GetInventoryResponse_decode_internal(const CanardRxTransfer* transfer, uint16_t payload_len, automation_GetInventoryResponse* dest, uint8_t** dyn_arr_buf, int32_t offset);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __AUTOMATION_GETINVENTORY
\ No newline at end of file
@@ -53,7 +53,7 @@ automation.Values values
 
 #define AUTOMATION_GETVALUES_ID                            200
 #define AUTOMATION_GETVALUES_NAME                          "automation.GetValues"
-#define AUTOMATION_GETVALUES_SIGNATURE                     (0x870C90B105F49030ULL)
+#define AUTOMATION_GETVALUES_SIGNATURE                     (0x450D219EC1D16B00ULL)
 
 #define AUTOMATION_GETVALUES_REQUEST_MAX_SIZE              ((17 + 7)/8)
 
@@ -81,7 +81,7 @@ uint32_t automation_GetValuesRequest_encode_internal(automation_GetValuesRequest
 extern
 int32_t automation_GetValuesRequest_decode_internal(const CanardRxTransfer* transfer, uint16_t payload_len, automation_GetValuesRequest* dest, uint8_t** dyn_arr_buf, int32_t offset);
 
-#define AUTOMATION_GETVALUES_RESPONSE_MAX_SIZE             ((50 + 7)/8)
+#define AUTOMATION_GETVALUES_RESPONSE_MAX_SIZE             ((273 + 7)/8)
 
 // Constants
 #define AUTOMATION_GETVALUES_RESPONSE_OK                                      0 // 0
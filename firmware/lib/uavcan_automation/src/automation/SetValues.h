@@ -35,9 +35,9 @@ automation.Values values
 
 #define AUTOMATION_SETVALUES_ID                            20000
 #define AUTOMATION_SETVALUES_NAME                          "automation.SetValues"
-#define AUTOMATION_SETVALUES_SIGNATURE                     (0x1CB5D277F64E623CULL)
+#define AUTOMATION_SETVALUES_SIGNATURE                     (0xDEB46358326B990CULL)
 
-#define AUTOMATION_SETVALUES_MAX_SIZE                      ((55 + 7)/8)
+#define AUTOMATION_SETVALUES_MAX_SIZE                      ((278 + 7)/8)
 
 // Constants
 
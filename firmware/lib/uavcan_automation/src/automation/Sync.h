@@ -0,0 +1,63 @@
+/*
+ * UAVCAN data structure definition for libcanard.
+ *
+ * Autogenerated, do not edit.
+ *
+ */
+
+#ifndef __AUTOMATION_SYNC
+#define __AUTOMATION_SYNC
+
+#include <stdint.h>
+#include "canard.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/******************************* Source text **********************************
+# Bus-wide synchronization (like CANopen SYNC). On reception, every node latches
+# its inputs (following GetValues requests are served from this snapshot) and
+# applies outputs staged by SetValues since the previous Sync.
+
+# incremented with every Sync, allows to detect missed ones
+uint8 counter
+******************************************************************************/
+
+/********************* DSDL signature source definition ***********************
+automation.Sync
+saturated uint8 counter
+******************************************************************************/
+
+#define AUTOMATION_SYNC_ID                                 20002
+#define AUTOMATION_SYNC_NAME                               "automation.Sync"
+#define AUTOMATION_SYNC_SIGNATURE                          (0xC2C5481BEBBA0400ULL)
+
+#define AUTOMATION_SYNC_MAX_SIZE                           ((8 + 7)/8)
+
+// Constants
+
+typedef struct
+{
+    // FieldTypes
+    uint8_t    counter;                       // bit len 8
+
+} automation_Sync;
+
+extern
+uint32_t automation_Sync_encode(automation_Sync* source, void* msg_buf);
+
+extern
+int32_t automation_Sync_decode(const CanardRxTransfer* transfer, uint16_t payload_len, automation_Sync* dest, uint8_t** dyn_arr_buf);
+
+extern
+uint32_t automation_Sync_encode_internal(automation_Sync* source, void* msg_buf, uint32_t offset, uint8_t root_item);
+
+extern
+int32_t automation_Sync_decode_internal(const CanardRxTransfer* transfer, uint16_t payload_len, automation_Sync* dest, uint8_t** dyn_arr_buf, int32_t offset);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __AUTOMATION_SYNC
\ No newline at end of file
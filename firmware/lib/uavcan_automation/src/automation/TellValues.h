@@ -36,9 +36,9 @@ automation.Values values
 
 #define AUTOMATION_TELLVALUES_ID                           20001
 #define AUTOMATION_TELLVALUES_NAME                         "automation.TellValues"
-#define AUTOMATION_TELLVALUES_SIGNATURE                    (0x9D12BA899BA75CE1ULL)
+#define AUTOMATION_TELLVALUES_SIGNATURE                    (0x5F130BA65F82A7D1ULL)
 
-#define AUTOMATION_TELLVALUES_MAX_SIZE                     ((48 + 7)/8)
+#define AUTOMATION_TELLVALUES_MAX_SIZE                     ((271 + 7)/8)
 
 // Constants
 
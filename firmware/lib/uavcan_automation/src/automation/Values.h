@@ -33,9 +33,9 @@ automation.AnalogValues analog_values
 ******************************************************************************/
 
 #define AUTOMATION_VALUES_NAME                             "automation.Values"
-#define AUTOMATION_VALUES_SIGNATURE                        (0x508F04A46E815A46ULL)
+#define AUTOMATION_VALUES_SIGNATURE                        (0x4A65E755D85C6E92ULL)
 
-#define AUTOMATION_VALUES_MAX_SIZE                         ((39 + 7)/8)
+#define AUTOMATION_VALUES_MAX_SIZE                         ((262 + 7)/8)
 
 // Constants
 
@@ -36,14 +36,21 @@ uint32_t automation_AnalogValues_encode_internal(automation_AnalogValues* source
 {
     uint32_t c = 0;
 
-    source->values_len = CANARD_INTERNAL_SATURATE_UNSIGNED(source->values_len, 3)
-    canardEncodeScalar(msg_buf, offset, 2, (void*)&source->values_len); // 3
-    offset += 2;
+    // Dynamic Array (values)
+    if (! root_item)
+    {
+        // - Add array length
+        canardEncodeScalar(msg_buf, offset, 5, (void*)&source->values.len);
+        offset += 5;
+    }
 
-    // Static array (values)
-    for (c = 0; c < 2; c++)
+    // - Add array items
+    for (c = 0; c < source->values.len; c++)
     {
-        canardEncodeScalar(msg_buf, offset, 16, (void*)(source->values + c)); // 65535
+        canardEncodeScalar(msg_buf,
+                           offset,
+                           16,
+                           (void*)(source->values.data + c));// 65535
         offset += 16;
     }
 
@@ -86,20 +93,53 @@ int32_t automation_AnalogValues_decode_internal(
     int32_t ret = 0;
     uint32_t c = 0;
 
-    ret = canardDecodeScalar(transfer, (uint32_t)offset, 2, false, (void*)&dest->values_len);
-    if (ret != 2)
+    // Dynamic Array (values)
+    //  - Last item in struct & Root item & (Array Size > 8 bit), tail array optimization
+    if (payload_len)
+    {
+        //  - Calculate Array length from MSG length
+        dest->values.len = ((payload_len * 8) - offset ) / 16; // 16 bit array item size
+    }
+    else
+    {
+        // - Array length 5 bits
+        ret = canardDecodeScalar(transfer,
+                                 (uint32_t)offset,
+                                 5,
+                                 false,
+                                 (void*)&dest->values.len); // 65535
+        if (ret != 5)
+        {
+            goto automation_AnalogValues_error_exit;
+        }
+        offset += 5;
+    }
+
+    if (dest->values.len > 16)
     {
         goto automation_AnalogValues_error_exit;
     }
-    offset += 2;
 
-    // Static array (values)
-    for (c = 0; c < 2; c++)
+    //  - Get Array
+    if (dyn_arr_buf)
     {
-        ret = canardDecodeScalar(transfer, (uint32_t)offset, 16, false, (void*)(dest->values + c));
-        if (ret != 16)
+        dest->values.data = (uint16_t*)*dyn_arr_buf;
+    }
+
+    for (c = 0; c < dest->values.len; c++)
+    {
+        if (dyn_arr_buf)
         {
-            goto automation_AnalogValues_error_exit;
+            ret = canardDecodeScalar(transfer,
+                                     (uint32_t)offset,
+                                     16,
+                                     false,
+                                     (void*)*dyn_arr_buf); // 65535
+            if (ret != 16)
+            {
+                goto automation_AnalogValues_error_exit;
+            }
+            *dyn_arr_buf = (uint8_t*)(((uint16_t*)*dyn_arr_buf) + 1);
         }
         offset += 16;
     }
@@ -6,6 +6,7 @@
  */
 #include "automation/DigitalValues.h"
 #include "canard.h"
+#include "uavcan_bool_array.h"
 
 #ifndef CANARD_INTERNAL_SATURATE
 #define CANARD_INTERNAL_SATURATE(x, max) ( ((x) > max) ? max : ( (-(x) > max) ? (-max) : (x) ) );
@@ -34,18 +35,14 @@ uint32_t automation_DigitalValues_encode_internal(automation_DigitalValues* sour
   uint32_t offset,
   uint8_t CANARD_MAYBE_UNUSED(root_item))
 {
-    uint32_t c = 0;
-
-    source->values_len = CANARD_INTERNAL_SATURATE_UNSIGNED(source->values_len, 63)
-    canardEncodeScalar(msg_buf, offset, 6, (void*)&source->values_len); // 63
+    // Dynamic Array (values)
+    //  - Array item size < 8 bit, no tail array optimization
+    // - Add array length
+    canardEncodeScalar(msg_buf, offset, 6, (void*)&source->values.len);
     offset += 6;
 
-    // Static array (values)
-    for (c = 0; c < 32; c++)
-    {
-        canardEncodeScalar(msg_buf, offset, 1, (void*)(source->values + c)); // 1
-        offset += 1;
-    }
+    // - Add array items (packed, not bit by bit)
+    offset = uavcan_encode_bool_array(msg_buf, offset, source->values.data, source->values.len);
 
     return offset;
 }
@@ -84,25 +81,38 @@ int32_t automation_DigitalValues_decode_internal(
   int32_t offset)
 {
     int32_t ret = 0;
-    uint32_t c = 0;
 
-    ret = canardDecodeScalar(transfer, (uint32_t)offset, 6, false, (void*)&dest->values_len);
+    // Dynamic Array (values)
+    //  - Array item size < 8 bit, no tail array optimization
+    // - Array length 6 bits
+    ret = canardDecodeScalar(transfer,
+                             (uint32_t)offset,
+                             6,
+                             false,
+                             (void*)&dest->values.len); // 1
     if (ret != 6)
     {
         goto automation_DigitalValues_error_exit;
     }
     offset += 6;
 
-    // Static array (values)
-    for (c = 0; c < 32; c++)
+    if (dest->values.len > 63)
+    {
+        goto automation_DigitalValues_error_exit;
+    }
+
+    //  - Get Array (packed, not bit by bit)
+    if (dyn_arr_buf)
     {
-        ret = canardDecodeScalar(transfer, (uint32_t)offset, 1, false, (void*)(dest->values + c));
-        if (ret != 1)
+        dest->values.data = (bool*)*dyn_arr_buf;
+        ret = uavcan_decode_bool_array(transfer, (uint32_t)offset, dest->values.data, dest->values.len);
+        if (ret < 0)
         {
             goto automation_DigitalValues_error_exit;
         }
-        offset += 1;
+        *dyn_arr_buf = (uint8_t*)(((bool*)*dyn_arr_buf) + dest->values.len);
     }
+    offset += dest->values.len;
     return offset;
 
 automation_DigitalValues_error_exit:
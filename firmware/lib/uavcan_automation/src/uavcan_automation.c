@@ -6,23 +6,20 @@
 #include "automation/SetValues.h"
 #include "automation/GetValues.h"
 #include "automation/TellValues.h"
+#include "automation/Sync.h"
+#include "automation/GetInventory.h"
 
 #include "uavcan_automation.h"
+#include "uavcan_bool_array.h"
 
 
-// more correct but usable inside function only
-/*
-#define max(a, b) \
-    ({ __typeof__ (a) _a = (a); \
-       __typeof__ (b) _b = (b); \
-     _a > _b ? _a : _b; })
-*/
-#define max(a, b) (((a) > (b)) ? (a) : (b))
-
-static void handle_SetValues(CanardInstance *ins, CanardRxTransfer *transfer);
-static void handle_TellValues(CanardInstance *ins, CanardRxTransfer *transfer);
-static void handle_GetValues_req(CanardInstance *ins, CanardRxTransfer *transfer);
-static void handle_GetValues_resp(CanardInstance *ins, CanardRxTransfer *transfer);
+static void handle_SetValues(uavcan_automation_t *a, CanardInstance *ins, CanardRxTransfer *transfer);
+static void handle_TellValues(uavcan_automation_t *a, CanardInstance *ins, CanardRxTransfer *transfer);
+static void handle_Sync(uavcan_automation_t *a, CanardInstance *ins, CanardRxTransfer *transfer);
+static void handle_GetValues_req(uavcan_automation_t *a, CanardInstance *ins, CanardRxTransfer *transfer);
+static void handle_GetValues_resp(uavcan_automation_t *a, CanardInstance *ins, CanardRxTransfer *transfer);
+static void handle_GetInventory_req(uavcan_automation_t *a, CanardInstance *ins, CanardRxTransfer *transfer);
+static void handle_GetInventory_resp(uavcan_automation_t *a, CanardInstance *ins, CanardRxTransfer *transfer);
 
 bool uavcan_automation_should_accept_transfer(const CanardInstance *ins,
                                               uint64_t *out_data_type_signature,
@@ -42,6 +39,9 @@ bool uavcan_automation_should_accept_transfer(const CanardInstance *ins,
         case AUTOMATION_TELLVALUES_ID:
             *out_data_type_signature = AUTOMATION_TELLVALUES_SIGNATURE;
             return true;
+        case AUTOMATION_SYNC_ID:
+            *out_data_type_signature = AUTOMATION_SYNC_SIGNATURE;
+            return true;
         }
         break;
     case CanardTransferTypeRequest:
@@ -51,6 +51,9 @@ bool uavcan_automation_should_accept_transfer(const CanardInstance *ins,
         case AUTOMATION_GETVALUES_ID:
             *out_data_type_signature = AUTOMATION_GETVALUES_SIGNATURE;
             return true;
+        case AUTOMATION_GETINVENTORY_ID:
+            *out_data_type_signature = AUTOMATION_GETINVENTORY_SIGNATURE;
+            return true;
         }
         break;
     }
@@ -58,16 +61,100 @@ bool uavcan_automation_should_accept_transfer(const CanardInstance *ins,
     return false;
 }
 
-// compute max size for all handled messages
-#define buff_size \
-    max(AUTOMATION_SETVALUES_MAX_SIZE, \
-        max(AUTOMATION_GETVALUES_REQUEST_MAX_SIZE, \
-            AUTOMATION_GETVALUES_RESPONSE_MAX_SIZE))
+// decoder moves the pointer, so it must start from the beginning every time
+#define DYN_BUFF_PTR(a) ((uint8_t *)&(a)->dyn_buff)
 
-uint8_t buff[buff_size];
-uint8_t *buff_ptr = buff;
+static uint8_t default_set_dos(uavcan_automation_t *a, uint8_t source_node_id, uint8_t output_id, const bool *values, uint8_t len)
+{
+    return automation_set_dos(source_node_id, output_id, values, len);
+}
 
-bool uavcan_automation_on_transfer_received(CanardInstance *ins, CanardRxTransfer *transfer)
+static uint8_t default_set_aos(uavcan_automation_t *a, uint8_t source_node_id, uint8_t output_id, const uint16_t *values, uint8_t len)
+{
+    return automation_set_aos(source_node_id, output_id, values, len);
+}
+
+static uint8_t default_get_dis(uavcan_automation_t *a, uint8_t source_node_id, uint8_t index, bool *values, uint8_t len)
+{
+    return automation_get_dis(source_node_id, index, values, len);
+}
+
+static uint8_t default_get_ais(uavcan_automation_t *a, uint8_t source_node_id, uint8_t index, uint16_t *values, uint8_t len)
+{
+    return automation_get_ais(source_node_id, index, values, len);
+}
+
+static void default_on_get_dis_response(uavcan_automation_t *a, uint8_t source_node_id, uint8_t transfer_id, uint8_t index, const automation_values_t *values)
+{
+    automation_on_get_dis_response(source_node_id, transfer_id, index, values);
+}
+
+static void default_on_get_ais_response(uavcan_automation_t *a, uint8_t source_node_id, uint8_t transfer_id, uint8_t index, const automation_values_t *values)
+{
+    automation_on_get_ais_response(source_node_id, transfer_id, index, values);
+}
+
+static void default_on_get_values_error(uavcan_automation_t *a, uint8_t source_node_id, uint8_t transfer_id, uint8_t index, uint8_t result)
+{
+    automation_on_get_values_error(source_node_id, transfer_id, index, result);
+}
+
+static void default_on_tell_dis(uavcan_automation_t *a, uint8_t source_node_id, uint8_t index, const automation_values_t *values)
+{
+    automation_on_tell_dis(source_node_id, index, values);
+}
+
+static void default_on_tell_ais(uavcan_automation_t *a, uint8_t source_node_id, uint8_t index, const automation_values_t *values)
+{
+    automation_on_tell_ais(source_node_id, index, values);
+}
+
+static void default_on_sync(uavcan_automation_t *a, uint8_t source_node_id, uint8_t counter)
+{
+    automation_on_sync(source_node_id, counter);
+}
+
+static void default_get_inventory(uavcan_automation_t *a, uint8_t source_node_id, automation_GetInventoryResponse *inventory)
+{
+    automation_get_inventory(source_node_id, inventory);
+}
+
+static void default_on_get_inventory_response(uavcan_automation_t *a, uint8_t source_node_id, uint8_t transfer_id, const automation_GetInventoryResponse *inventory)
+{
+    automation_on_get_inventory_response(source_node_id, transfer_id, inventory);
+}
+
+// the global callbacks
+static const uavcan_automation_callbacks_t default_callbacks = {
+    default_set_dos,
+    default_set_aos,
+    default_get_dis,
+    default_get_ais,
+    default_on_get_dis_response,
+    default_on_get_ais_response,
+    default_on_get_values_error,
+    default_on_tell_dis,
+    default_on_tell_ais,
+    default_on_sync,
+    default_get_inventory,
+    default_on_get_inventory_response,
+};
+
+uavcan_automation_t uavcan_default_automation = {
+    .node = &uavcan_default_node,
+    .callbacks = &default_callbacks,
+};
+
+void uavcan_automation_init(uavcan_automation_t *a,
+                            uavcan_node_t *node,
+                            const uavcan_automation_callbacks_t *callbacks)
+{
+    memset(a, 0, sizeof(*a));
+    a->node = node;
+    a->callbacks = callbacks;
+}
+
+bool uavcan_automation_handle_transfer(uavcan_automation_t *a, CanardInstance *ins, CanardRxTransfer *transfer)
 {
     switch (transfer->transfer_type)
     {
@@ -76,10 +163,13 @@ bool uavcan_automation_on_transfer_received(CanardInstance *ins, CanardRxTransfe
         switch (transfer->data_type_id)
         {
         case AUTOMATION_SETVALUES_ID:
-            handle_SetValues(ins, transfer);
+            handle_SetValues(a, ins, transfer);
             return true;
         case AUTOMATION_TELLVALUES_ID:
-            handle_TellValues(ins, transfer);
+            handle_TellValues(a, ins, transfer);
+            return true;
+        case AUTOMATION_SYNC_ID:
+            handle_Sync(a, ins, transfer);
             return true;
         }
         break;
@@ -89,7 +179,10 @@ bool uavcan_automation_on_transfer_received(CanardInstance *ins, CanardRxTransfe
         switch (transfer->data_type_id)
         {
         case AUTOMATION_GETVALUES_ID:
-            handle_GetValues_req(ins, transfer);
+            handle_GetValues_req(a, ins, transfer);
+            return true;
+        case AUTOMATION_GETINVENTORY_ID:
+            handle_GetInventory_req(a, ins, transfer);
             return true;
         }
         break;
@@ -99,7 +192,10 @@ bool uavcan_automation_on_transfer_received(CanardInstance *ins, CanardRxTransfe
         switch (transfer->data_type_id)
         {
         case AUTOMATION_GETVALUES_ID:
-            handle_GetValues_resp(ins, transfer);
+            handle_GetValues_resp(a, ins, transfer);
+            return true;
+        case AUTOMATION_GETINVENTORY_ID:
+            handle_GetInventory_resp(a, ins, transfer);
             return true;
         }
         break;
@@ -107,63 +203,161 @@ bool uavcan_automation_on_transfer_received(CanardInstance *ins, CanardRxTransfe
     return false;
 }
 
-static void handle_TellValues(CanardInstance *ins, CanardRxTransfer *transfer)
+bool uavcan_automation_on_transfer_received(CanardInstance *ins, CanardRxTransfer *transfer)
+{
+    return uavcan_automation_handle_transfer(&uavcan_default_automation, ins, transfer);
+}
+
+/*
+Received values are not decoded by handlers, application callbacks get
+automation_values_t and decode them straight to their destination by
+automation_read_*(). Generated decoders skip dynamic arrays when dyn_arr_buf is
+NULL, so they are used for the headers.
+
+Values is the last field of both TellValues and GetValuesResponse =>
+AnalogValues use tail array optimization (no length field).
+*/
+#define TELLVALUES_VALUES_OFFSET (1 + 8)
+#define GETVALUES_RESPONSE_VALUES_OFFSET (2 + 1 + 8)
+
+// `end` is the offset returned by the header decoder (values skipped), it must
+// match and the values must be in the payload
+static bool values_init(automation_values_t *values, CanardInstance *ins, const CanardRxTransfer *transfer,
+                        const automation_Values *decoded, uint32_t offset, int32_t end)
+{
+    if (end > (int32_t)transfer->payload_len * 8)
+    {
+        return false;
+    }
+
+    values->ins = ins;
+    values->transfer = transfer;
+    // skip union tag
+    offset += 1;
+    if (decoded->union_tag == AUTOMATION_VALUES_DIGITAL_VALUES)
+    {
+        values->offset = offset + 6;
+        values->len = decoded->digital_values.values.len;
+        return end == (int32_t)(values->offset + values->len);
+    }
+    values->offset = offset;
+    values->len = decoded->analog_values.values.len;
+    return end == (int32_t)(values->offset + values->len * 16);
+}
+
+bool automation_read_dis(const automation_values_t *values, uint8_t first, uint8_t count, bool *dest)
+{
+    if (first + count > values->len)
+    {
+        return false;
+    }
+    if (uavcan_decode_bool_array(values->transfer, values->offset + first, dest, count) < 0)
+    {
+        uavcan_stats_decode_error(values->ins);
+        return false;
+    }
+    return true;
+}
+
+bool automation_read_ais(const automation_values_t *values, uint8_t first, uint8_t count, uint16_t *dest)
+{
+    if (first + count > values->len)
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (canardDecodeScalar(values->transfer, values->offset + (first + i) * 16U, 16, false, &dest[i]) != 16)
+        {
+            uavcan_stats_decode_error(values->ins);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void handle_TellValues(uavcan_automation_t *a, CanardInstance *ins, CanardRxTransfer *transfer)
 {
     automation_TellValues tv;
+    automation_values_t values;
 
-    if (automation_TellValues_decode(transfer, (uint16_t)transfer->payload_len, &tv, &buff_ptr) < 0)
+    int32_t end = automation_TellValues_decode(transfer, (uint16_t)transfer->payload_len, &tv, NULL);
+    if (end < 0 || !values_init(&values, ins, transfer, &tv.values, TELLVALUES_VALUES_OFFSET, end))
     {
+        uavcan_stats_decode_error(ins);
         uavcan_error("a.TV decode failed");
         return;
     }
-        if (tv.values.union_tag == AUTOMATION_VALUES_DIGITAL_VALUES)
-        {
-            if(tv.port_type.port_type == AUTOMATION_PORTTYPE_INPUT) {
-                automation_on_tell_dis(transfer->source_node_id, tv.index, tv.values.digital_values.values, tv.values.digital_values.values_len);
-            } else {
-                // TODO: on_tell_dos
-            }
-        }
-        else
-        {
-            if(tv.port_type.port_type == AUTOMATION_PORTTYPE_INPUT) {
-                automation_on_tell_ais(transfer->source_node_id, tv.index, tv.values.analog_values.values, tv.values.analog_values.values_len);
-            } else {
-                // TODO: on_tell_aos
-            }
-        }
+    if (tv.port_type.port_type != AUTOMATION_PORTTYPE_INPUT)
+    {
+        // TODO: on_tell_dos/aos
+        return;
+    }
+    if (tv.values.union_tag == AUTOMATION_VALUES_DIGITAL_VALUES)
+    {
+        a->callbacks->on_tell_dis(a, transfer->source_node_id, tv.index, &values);
+    }
+    else
+    {
+        a->callbacks->on_tell_ais(a, transfer->source_node_id, tv.index, &values);
+    }
+}
+
+static void handle_Sync(uavcan_automation_t *a, CanardInstance *ins, CanardRxTransfer *transfer)
+{
+    automation_Sync sync;
+    uint8_t *dyn_ptr = DYN_BUFF_PTR(a);
+
+    if (automation_Sync_decode(transfer, (uint16_t)transfer->payload_len, &sync, &dyn_ptr) < 0)
+    {
+        uavcan_stats_decode_error(ins);
+        uavcan_error("a.S decode failed");
+        return;
+    }
+    a->callbacks->on_sync(a, transfer->source_node_id, sync.counter);
 }
 
-static void handle_SetValues(CanardInstance *ins, CanardRxTransfer *transfer)
+static void handle_SetValues(uavcan_automation_t *a, CanardInstance *ins, CanardRxTransfer *transfer)
 {
     automation_SetValues sv;
+    uint8_t *dyn_ptr = DYN_BUFF_PTR(a);
+    uint8_t node_id;
 
-    if (automation_SetValues_decode(transfer, (uint16_t)transfer->payload_len, &sv, &buff_ptr) < 0)
+    // SetValues is a broadcast, skip decoding of values for other nodes
+    // (node_id is the first field)
+    if (canardDecodeScalar(transfer, 0, 8, false, &node_id) == 8 && node_id != canardGetLocalNodeID(ins))
+    {
+        return;
+    }
+    if (automation_SetValues_decode(transfer, (uint16_t)transfer->payload_len, &sv, &dyn_ptr) < 0)
     {
+        uavcan_stats_decode_error(ins);
         uavcan_error("a.SV decode failed");
         return;
     }
-    if (sv.node_id == UAVCAN_NODE_ID)
+    if (sv.node_id == canardGetLocalNodeID(ins))
     {
         if (sv.values.union_tag == AUTOMATION_VALUES_DIGITAL_VALUES)
         {
-            automation_set_dos(transfer->source_node_id, sv.index, sv.values.digital_values.values, sv.values.digital_values.values_len);
+            a->callbacks->set_dos(a, transfer->source_node_id, sv.index, sv.values.digital_values.values.data, sv.values.digital_values.values.len);
         }
         else
         {
-            //automation_set_aos(transfer->source_node_id, sv.index, sv.values.analog_values.values.data, sv.values.analog_values.values.len);
-            automation_set_aos(transfer->source_node_id, sv.index, sv.values.analog_values.values, sv.values.analog_values.values_len);
+            a->callbacks->set_aos(a, transfer->source_node_id, sv.index, sv.values.analog_values.values.data, sv.values.analog_values.values.len);
         }
     }
 }
 
-static void handle_GetValues_req(CanardInstance *ins, CanardRxTransfer *transfer)
+static void handle_GetValues_req(uavcan_automation_t *a, CanardInstance *ins, CanardRxTransfer *transfer)
 {
     automation_GetValuesRequest req;
     automation_GetValuesResponse resp;
+    uint8_t buff[AUTOMATION_GETVALUES_RESPONSE_MAX_SIZE];
+    uint8_t *dyn_ptr = DYN_BUFF_PTR(a);
 
-    if (automation_GetValuesRequest_decode(transfer, (uint16_t)transfer->payload_len, &req, &buff_ptr) < 0)
+    if (automation_GetValuesRequest_decode(transfer, (uint16_t)transfer->payload_len, &req, &dyn_ptr) < 0)
     {
+        uavcan_stats_decode_error(ins);
         uavcan_error("a.GV req decode failed");
         return;
     }
@@ -174,25 +368,29 @@ static void handle_GetValues_req(CanardInstance *ins, CanardRxTransfer *transfer
         return;
     }
 
+    // error responses carry no values (empty array)
+    memset(&resp, 0, sizeof(resp));
+    resp.port_type.port_type = AUTOMATION_PORTTYPE_INPUT;
+    resp.index = req.index;
+
     switch (req.vals_type.value_type)
     {
     case AUTOMATION_VALUETYPE_DIGITAL:
-        if (req.length > AUTOMATION_DIGITALVALUES_VALUES_LENGTH)
+        resp.values.union_tag = AUTOMATION_VALUES_DIGITAL_VALUES;
+        if (req.length > AUTOMATION_DIGITALVALUES_VALUES_MAX_LENGTH)
         {
             uavcan_error("a.GV: len too big");
             resp.result = AUTOMATION_GETVALUES_RESPONSE_BAD_ARGUMENT;
         }
         else
         {
-            resp.result = automation_get_dis(transfer->source_node_id, req.index, resp.values.digital_values.values, req.length);
-            resp.port_type.port_type = AUTOMATION_PORTTYPE_INPUT;
-            resp.index = req.index;
-            resp.values.union_tag = AUTOMATION_VALUES_DIGITAL_VALUES;
-            resp.values.digital_values.values_len = req.length;
+            resp.result = a->callbacks->get_dis(a, transfer->source_node_id, req.index, a->dyn_buff.digital, req.length);
+            resp.values.digital_values.values.data = a->dyn_buff.digital;
+            resp.values.digital_values.values.len = req.length;
         }
         break;
     case AUTOMATION_VALUETYPE_ANALOG:
-        /*
+        resp.values.union_tag = AUTOMATION_VALUES_ANALOG_VALUES;
         if (req.length > AUTOMATION_ANALOGVALUES_VALUES_MAX_LENGTH)
         {
             uavcan_error("a.GV: len too big");
@@ -200,36 +398,21 @@ static void handle_GetValues_req(CanardInstance *ins, CanardRxTransfer *transfer
         }
         else
         {
-            uint16_t values[AUTOMATION_ANALOGVALUES_VALUES_MAX_LENGTH];
-            resp.result = automation_get_ais(transfer->source_node_id, req.index, values, req.length);
-            resp.values.analog_values.values.data = values;
-            resp.values.union_tag = AUTOMATION_VALUES_ANALOG_VALUES;
+            resp.result = a->callbacks->get_ais(a, transfer->source_node_id, req.index, a->dyn_buff.analog, req.length);
+            resp.values.analog_values.values.data = a->dyn_buff.analog;
             resp.values.analog_values.values.len = req.length;
         }
-        */
-        if (req.length > AUTOMATION_ANALOGVALUES_VALUES_LENGTH)
-        {
-            uavcan_error("a.GV: len too big");
-            resp.result = AUTOMATION_GETVALUES_RESPONSE_BAD_ARGUMENT;
-        }
-        else
-        {
-            resp.result = automation_get_ais(transfer->source_node_id, req.index, resp.values.analog_values.values, req.length);
-            resp.port_type.port_type = AUTOMATION_PORTTYPE_INPUT;
-            resp.index = req.index;
-            resp.values.union_tag = AUTOMATION_VALUES_ANALOG_VALUES;
-            resp.values.analog_values.values_len = req.length;
-        }
         break;
     default:
-        resp.result = AUTOMATION_GETVALUES_RESPONSE_BAD_ARGUMENT;
         uavcan_error("Unexpected value type");
-        return;
+        resp.values.union_tag = AUTOMATION_VALUES_DIGITAL_VALUES;
+        resp.result = AUTOMATION_GETVALUES_RESPONSE_BAD_ARGUMENT;
+        break;
     }
-    resp.index = req.index;
 
     uint32_t len = automation_GetValuesResponse_encode(&resp, buff);
-    if (uavcan_send_response(
+    if (uavcan_node_send_response(
+            a->node,
             transfer,
             AUTOMATION_GETVALUES_SIGNATURE,
             AUTOMATION_GETVALUES_ID,
@@ -240,19 +423,21 @@ static void handle_GetValues_req(CanardInstance *ins, CanardRxTransfer *transfer
     }
 }
 
-static void handle_GetValues_resp(CanardInstance *ins, CanardRxTransfer *transfer)
+static void handle_GetValues_resp(uavcan_automation_t *a, CanardInstance *ins, CanardRxTransfer *transfer)
 {
     automation_GetValuesResponse resp;
+    automation_values_t values;
 
-    if (automation_GetValuesResponse_decode(transfer, transfer->payload_len, &resp, &buff_ptr) < 0)
+    int32_t end = automation_GetValuesResponse_decode(transfer, transfer->payload_len, &resp, NULL);
+    if (end < 0 || !values_init(&values, ins, transfer, &resp.values, GETVALUES_RESPONSE_VALUES_OFFSET, end))
     {
+        uavcan_stats_decode_error(ins);
         uavcan_error("a.GV resp decode failed");
         return;
     }
 
     if (resp.result != AUTOMATION_GETVALUES_RESPONSE_OK) {
-        // TODO: error response callback
-        uavcan_error("Error response: GetValues(%d,%d,%d) = %d", transfer->source_node_id, resp.values.union_tag, resp.index, resp.result);
+        a->callbacks->on_get_values_error(a, transfer->source_node_id, transfer->transfer_id, resp.index, resp.result);
         return;
     }
 
@@ -260,14 +445,14 @@ static void handle_GetValues_resp(CanardInstance *ins, CanardRxTransfer *transfe
     {
     case AUTOMATION_VALUES_DIGITAL_VALUES:
         if(resp.port_type.port_type == AUTOMATION_PORTTYPE_INPUT) {
-            automation_on_get_dis_response(transfer->source_node_id, resp.index, resp.values.digital_values.values, resp.values.digital_values.values_len);
+            a->callbacks->on_get_dis_response(a, transfer->source_node_id, transfer->transfer_id, resp.index, &values);
         } else {
             // TODO: get dos
         }
         return;
     case AUTOMATION_VALUES_ANALOG_VALUES:
         if(resp.port_type.port_type == AUTOMATION_PORTTYPE_INPUT) {
-            automation_on_get_ais_response(transfer->source_node_id, resp.index, resp.values.analog_values.values, resp.values.analog_values.values_len);
+            a->callbacks->on_get_ais_response(a, transfer->source_node_id, transfer->transfer_id, resp.index, &values);
         } else {
             // TODO: get aos
         }
@@ -275,149 +460,277 @@ static void handle_GetValues_resp(CanardInstance *ins, CanardRxTransfer *transfe
     }
 }
 
-static uint8_t tell_transfer_id = 0;
+static void handle_GetInventory_req(uavcan_automation_t *a, CanardInstance *ins, CanardRxTransfer *transfer)
+{
+    automation_GetInventoryResponse resp;
+    uint8_t buff[AUTOMATION_GETINVENTORY_RESPONSE_MAX_SIZE];
+
+    memset(&resp, 0, sizeof(resp));
+    a->callbacks->get_inventory(a, transfer->source_node_id, &resp);
+
+    uint32_t len = automation_GetInventoryResponse_encode(&resp, buff);
+    if (uavcan_node_send_response(
+            a->node,
+            transfer,
+            AUTOMATION_GETINVENTORY_SIGNATURE,
+            AUTOMATION_GETINVENTORY_ID,
+            buff,
+            len))
+    {
+        uavcan_error("a.GI resp TX failed");
+    }
+}
+
+static void handle_GetInventory_resp(uavcan_automation_t *a, CanardInstance *ins, CanardRxTransfer *transfer)
+{
+    automation_GetInventoryResponse resp;
 
-static int16_t automation_send_tell_d(uint8_t port_type, uint8_t index, const bool *values, uint8_t len, uint8_t priority) {
+    if (automation_GetInventoryResponse_decode(transfer, (uint16_t)transfer->payload_len, &resp, NULL) < 0)
+    {
+        uavcan_stats_decode_error(ins);
+        uavcan_error("a.GI resp decode failed");
+        return;
+    }
+    a->callbacks->on_get_inventory_response(a, transfer->source_node_id, transfer->transfer_id, &resp);
+}
+
+static int16_t automation_send_tell_d(uavcan_automation_t *a, uint8_t port_type, uint8_t index, const bool *values, uint8_t len, uint8_t priority) {
     uint8_t buff[AUTOMATION_TELLVALUES_MAX_SIZE];
     automation_TellValues msg;
 
-    if(len > AUTOMATION_DIGITALVALUES_VALUES_LENGTH) {
+    if(len > AUTOMATION_DIGITALVALUES_VALUES_MAX_LENGTH) {
         return -1;
     }
 
     msg.port_type.port_type = port_type;
     msg.index = index;
     msg.values.union_tag = AUTOMATION_VALUES_DIGITAL_VALUES;
-    msg.values.digital_values.values_len = len;
-    for(int i=0; i<len; i++) {
-        msg.values.digital_values.values[i] = values[i];
-    }
+    msg.values.digital_values.values.len = len;
+    msg.values.digital_values.values.data = (bool *)values;
     uint32_t msg_len = automation_TellValues_encode(&msg, buff);
 
-    return uavcan_broadcast(
+    return uavcan_node_broadcast(
+        a->node,
         AUTOMATION_TELLVALUES_SIGNATURE,
         AUTOMATION_TELLVALUES_ID,
-        &tell_transfer_id,
+        &a->tell_transfer_id,
         priority,
         buff,
         msg_len);
 }
 
-static int16_t automation_send_tell_a(uint8_t port_type, uint8_t index, const uint16_t *values, uint8_t len, uint8_t priority) {
+static int16_t automation_send_tell_a(uavcan_automation_t *a, uint8_t port_type, uint8_t index, const uint16_t *values, uint8_t len, uint8_t priority) {
     uint8_t buff[AUTOMATION_TELLVALUES_MAX_SIZE];
     automation_TellValues msg;
 
-    if(len > AUTOMATION_ANALOGVALUES_VALUES_LENGTH) {
+    if(len > AUTOMATION_ANALOGVALUES_VALUES_MAX_LENGTH) {
         return -1;
     }
 
     msg.port_type.port_type = port_type;
     msg.index = index;
     msg.values.union_tag = AUTOMATION_VALUES_ANALOG_VALUES;
-    msg.values.analog_values.values_len = len;
-    for(int i=0; i<len; i++) {
-        msg.values.analog_values.values[i] = values[i];
-    }
+    msg.values.analog_values.values.len = len;
+    msg.values.analog_values.values.data = (uint16_t *)values;
     uint32_t msg_len = automation_TellValues_encode(&msg, buff);
 
-    return uavcan_broadcast(
+    return uavcan_node_broadcast(
+        a->node,
         AUTOMATION_TELLVALUES_SIGNATURE,
         AUTOMATION_TELLVALUES_ID,
-        &tell_transfer_id,
+        &a->tell_transfer_id,
         priority,
         buff,
         msg_len);
 }
 
-int16_t automation_send_tell_dis(uint8_t index, const bool *values, uint8_t len) {
-    return automation_send_tell_d(AUTOMATION_PORTTYPE_INPUT, index, values, len, CANARD_TRANSFER_PRIORITY_MEDIUM);
+int16_t uavcan_automation_send_tell_dis(uavcan_automation_t *a, uint8_t index, const bool *values, uint8_t len) {
+    return automation_send_tell_d(a, AUTOMATION_PORTTYPE_INPUT, index, values, len, CANARD_TRANSFER_PRIORITY_MEDIUM);
 }
-int16_t automation_send_tell_ais(uint8_t index, const uint16_t *values, uint8_t len) {
-    return automation_send_tell_a(AUTOMATION_PORTTYPE_INPUT, index, values, len, CANARD_TRANSFER_PRIORITY_MEDIUM);
+int16_t uavcan_automation_send_tell_ais(uavcan_automation_t *a, uint8_t index, const uint16_t *values, uint8_t len) {
+    return automation_send_tell_a(a, AUTOMATION_PORTTYPE_INPUT, index, values, len, CANARD_TRANSFER_PRIORITY_MEDIUM);
 }
 
-int16_t automation_send_set_dos(uint8_t destination_node_id, uint8_t index, const bool *values, uint8_t values_len, uint8_t priority)
+int16_t uavcan_automation_send_sync(uavcan_automation_t *a)
+{
+    uint8_t buff[AUTOMATION_SYNC_MAX_SIZE];
+    automation_Sync sync;
+
+    sync.counter = a->sync_counter;
+    uint32_t len = automation_Sync_encode(&sync, buff);
+
+    int16_t res = uavcan_node_broadcast(
+        a->node,
+        AUTOMATION_SYNC_SIGNATURE,
+        AUTOMATION_SYNC_ID,
+        &a->sync_transfer_id,
+        CANARD_TRANSFER_PRIORITY_HIGHEST,
+        buff,
+        len);
+    if (res >= 0)
+    {
+        a->sync_counter++;
+    }
+    return res;
+}
+
+int16_t uavcan_automation_send_get_inventory(uavcan_automation_t *a, uint8_t destination_node_id)
+{
+    if (destination_node_id > CANARD_MAX_NODE_ID)
+    {
+        return -1;
+    }
+    uint8_t transfer_id = a->get_inventory_transfer_id;
+
+    // empty request
+    int16_t res = uavcan_node_send_request(
+        a->node,
+        destination_node_id,
+        AUTOMATION_GETINVENTORY_SIGNATURE,
+        AUTOMATION_GETINVENTORY_ID,
+        &a->get_inventory_transfer_id,
+        CANARD_TRANSFER_PRIORITY_LOW,
+        NULL,
+        0);
+
+    return (res < 0) ? res : transfer_id;
+}
+
+int16_t uavcan_automation_send_set_dos(uavcan_automation_t *a, uint8_t destination_node_id, uint8_t index, const bool *values, uint8_t values_len, uint8_t priority)
 {
     uint8_t buff[AUTOMATION_SETVALUES_MAX_SIZE];
     automation_SetValues sv;
-    static uint8_t transfer_id = 0;
+
+    if (values_len > AUTOMATION_DIGITALVALUES_VALUES_MAX_LENGTH)
+    {
+        return -1;
+    }
 
     sv.node_id = destination_node_id;
     sv.values.union_tag = AUTOMATION_VALUES_DIGITAL_VALUES;
     sv.index = index;
-    for (uint8_t i = 0; i < values_len; i++)
-    {
-        sv.values.digital_values.values[i] = values[i];
-    }
-    sv.values.digital_values.values_len = values_len;
+    sv.values.digital_values.values.data = (bool *)values;
+    sv.values.digital_values.values.len = values_len;
 
     uint32_t len = automation_SetValues_encode(&sv, buff);
 
-    return uavcan_broadcast(
+    return uavcan_node_broadcast(
+        a->node,
         AUTOMATION_SETVALUES_SIGNATURE,
         AUTOMATION_SETVALUES_ID,
-        &transfer_id,
+        &a->set_dos_transfer_id,
         priority,
         buff,
         len);
 }
 
-int16_t automation_send_set_aos(uint8_t destination_node_id, uint8_t index, const uint16_t *values, uint8_t values_len, uint8_t priority)
+int16_t uavcan_automation_send_set_aos(uavcan_automation_t *a, uint8_t destination_node_id, uint8_t index, const uint16_t *values, uint8_t values_len, uint8_t priority)
 {
     uint8_t buff[AUTOMATION_SETVALUES_MAX_SIZE];
     automation_SetValues sv;
-    static uint8_t transfer_id = 0;
+
+    if (values_len > AUTOMATION_ANALOGVALUES_VALUES_MAX_LENGTH)
+    {
+        return -1;
+    }
 
     sv.node_id = destination_node_id;
     sv.values.union_tag = AUTOMATION_VALUES_ANALOG_VALUES;
     sv.index = index;
-    for (uint8_t i = 0; i < values_len; i++)
-    {
-        //sv.values.analog_values.values.data[i] = values[i];
-        sv.values.analog_values.values[i] = values[i];
-    }
-    sv.values.analog_values.values_len = values_len;
+    sv.values.analog_values.values.data = (uint16_t *)values;
+    sv.values.analog_values.values.len = values_len;
 
     uint32_t len = automation_SetValues_encode(&sv, buff);
 
-    return uavcan_broadcast(
+    return uavcan_node_broadcast(
+        a->node,
         AUTOMATION_SETVALUES_SIGNATURE,
         AUTOMATION_SETVALUES_ID,
-        &transfer_id,
+        &a->set_aos_transfer_id,
         priority,
         buff,
         len);
 }
 
-static int16_t send_get_values(uint8_t destination_node_id, uint8_t port_type, uint8_t vals_type, uint8_t index, uint8_t len)
+static int16_t send_get_values(uavcan_automation_t *a, uint8_t destination_node_id, uint8_t port_type, uint8_t vals_type, uint8_t index, uint8_t len)
 {
-    static uint8_t transfer_id = 0;
+    if (destination_node_id > CANARD_MAX_NODE_ID)
+    {
+        return -1;
+    }
+    uint8_t transfer_id = a->get_transfer_ids[destination_node_id];
     uint8_t buff[AUTOMATION_GETVALUES_REQUEST_MAX_SIZE];
     automation_GetValuesRequest req;
 
+    req.port_type.port_type = port_type;
     req.index = index;
     req.length = len;
     req.vals_type.value_type = vals_type;
     uint32_t msg_len = automation_GetValuesRequest_encode(&req, buff);
 
-    return uavcan_send_request(
+    int16_t res = uavcan_node_send_request(
+        a->node,
         destination_node_id,
         AUTOMATION_GETVALUES_SIGNATURE,
         AUTOMATION_GETVALUES_ID,
-        &transfer_id,
+        &a->get_transfer_ids[destination_node_id],
         CANARD_TRANSFER_PRIORITY_HIGH,
         buff,
         msg_len);
+
+    return (res < 0) ? res : transfer_id;
+}
+
+int16_t uavcan_automation_send_get_dis(uavcan_automation_t *a, uint8_t destination_node_id, uint8_t index, uint8_t len)
+{
+    return send_get_values(a, destination_node_id, AUTOMATION_PORTTYPE_INPUT, AUTOMATION_VALUETYPE_DIGITAL, index, len);
+}
+
+int16_t uavcan_automation_send_get_ais(uavcan_automation_t *a, uint8_t destination_node_id, uint8_t index, uint8_t len)
+{
+    return send_get_values(a, destination_node_id, AUTOMATION_PORTTYPE_INPUT, AUTOMATION_VALUETYPE_ANALOG, index, len);
+}
+
+// single instance API
+
+int16_t automation_send_tell_dis(uint8_t index, const bool *values, uint8_t len)
+{
+    return uavcan_automation_send_tell_dis(&uavcan_default_automation, index, values, len);
+}
+
+int16_t automation_send_tell_ais(uint8_t index, const uint16_t *values, uint8_t len)
+{
+    return uavcan_automation_send_tell_ais(&uavcan_default_automation, index, values, len);
+}
+
+int16_t automation_send_sync(void)
+{
+    return uavcan_automation_send_sync(&uavcan_default_automation);
+}
+
+int16_t automation_send_get_inventory(uint8_t destination_node_id)
+{
+    return uavcan_automation_send_get_inventory(&uavcan_default_automation, destination_node_id);
+}
+
+int16_t automation_send_set_dos(uint8_t destination_node_id, uint8_t index, const bool *values, uint8_t values_len, uint8_t priority)
+{
+    return uavcan_automation_send_set_dos(&uavcan_default_automation, destination_node_id, index, values, values_len, priority);
+}
+
+int16_t automation_send_set_aos(uint8_t destination_node_id, uint8_t index, const uint16_t *values, uint8_t values_len, uint8_t priority)
+{
+    return uavcan_automation_send_set_aos(&uavcan_default_automation, destination_node_id, index, values, values_len, priority);
 }
 
 int16_t automation_send_get_dis(uint8_t destination_node_id, uint8_t index, uint8_t len)
 {
-    return send_get_values(destination_node_id, AUTOMATION_PORTTYPE_INPUT, AUTOMATION_VALUETYPE_DIGITAL, index, len);
+    return uavcan_automation_send_get_dis(&uavcan_default_automation, destination_node_id, index, len);
 }
 
 int16_t automation_send_get_ais(uint8_t destination_node_id, uint8_t index, uint8_t len)
 {
-    return send_get_values(destination_node_id, AUTOMATION_PORTTYPE_INPUT, AUTOMATION_VALUETYPE_ANALOG, index, len);
+    return uavcan_automation_send_get_ais(&uavcan_default_automation, destination_node_id, index, len);
 }
 
 /*
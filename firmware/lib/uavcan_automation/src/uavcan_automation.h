@@ -1,13 +1,79 @@
+#ifndef UAVCAN_AUTOMATION_H
+#define UAVCAN_AUTOMATION_H
+
 #include <stdint.h>
 
 #include "canard.h"
+#include "uavcan_node.h"
+
+#include "automation/DigitalValues.h"
+#include "automation/AnalogValues.h"
+#include "automation/GetInventory.h"
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
+// Received values, decoded by the application straight to their destination
+// by automation_read_*() (valid until the callback returns).
+typedef struct
+{
+    CanardInstance *ins;
+    const CanardRxTransfer *transfer;
+    uint32_t offset; // bit offset of the first value
+    uint8_t len;
+} automation_values_t;
+
+typedef struct uavcan_automation uavcan_automation_t;
+
+// Application callbacks of an instance, same as the global callbacks below.
+typedef struct
+{
+    uint8_t (*set_dos)(uavcan_automation_t *a, uint8_t source_node_id, uint8_t output_id, const bool *values, uint8_t len);
+    uint8_t (*set_aos)(uavcan_automation_t *a, uint8_t source_node_id, uint8_t output_id, const uint16_t *values, uint8_t len);
+    uint8_t (*get_dis)(uavcan_automation_t *a, uint8_t source_node_id, uint8_t index, bool *values, uint8_t len);
+    uint8_t (*get_ais)(uavcan_automation_t *a, uint8_t source_node_id, uint8_t index, uint16_t *values, uint8_t len);
+    void (*on_get_dis_response)(uavcan_automation_t *a, uint8_t source_node_id, uint8_t transfer_id, uint8_t index, const automation_values_t *values);
+    void (*on_get_ais_response)(uavcan_automation_t *a, uint8_t source_node_id, uint8_t transfer_id, uint8_t index, const automation_values_t *values);
+    void (*on_get_values_error)(uavcan_automation_t *a, uint8_t source_node_id, uint8_t transfer_id, uint8_t index, uint8_t result);
+    void (*on_tell_dis)(uavcan_automation_t *a, uint8_t source_node_id, uint8_t index, const automation_values_t *values);
+    void (*on_tell_ais)(uavcan_automation_t *a, uint8_t source_node_id, uint8_t index, const automation_values_t *values);
+    void (*on_sync)(uavcan_automation_t *a, uint8_t source_node_id, uint8_t counter);
+    void (*get_inventory)(uavcan_automation_t *a, uint8_t source_node_id, automation_GetInventoryResponse *inventory);
+    void (*on_get_inventory_response)(uavcan_automation_t *a, uint8_t source_node_id, uint8_t transfer_id, const automation_GetInventoryResponse *inventory);
+} uavcan_automation_callbacks_t;
+
+// Automation protocol instance running on `node`. Fields are private except
+// `user_reference`.
+struct uavcan_automation
+{
+    uavcan_node_t *node;
+    const uavcan_automation_callbacks_t *callbacks;
+    // for the application callbacks
+    void *user_reference;
+
+    uint8_t tell_transfer_id;
+    uint8_t sync_transfer_id;
+    uint8_t sync_counter;
+    uint8_t set_dos_transfer_id;
+    uint8_t set_aos_transfer_id;
+    uint8_t get_inventory_transfer_id;
+    // transfer IDs must be tracked per destination, so responses can be matched
+    uint8_t get_transfer_ids[CANARD_MAX_NODE_ID + 1];
+
+    // Decoded dynamic arrays point here. It's reused by every decode, values
+    // are valid until the callback returns only. Union keeps uint16_t alignment.
+    union
+    {
+        bool digital[AUTOMATION_DIGITALVALUES_VALUES_MAX_LENGTH];
+        uint16_t analog[AUTOMATION_ANALOGVALUES_VALUES_MAX_LENGTH];
+    } dyn_buff;
+};
+
 // API
+// Single instance API, it runs on uavcan_default_node and calls the global
+// callbacks.
 
 bool uavcan_automation_should_accept_transfer(const CanardInstance *ins,
                                               uint64_t *out_data_type_signature,
@@ -17,10 +83,16 @@ bool uavcan_automation_should_accept_transfer(const CanardInstance *ins,
 
 bool uavcan_automation_on_transfer_received(CanardInstance *ins, CanardRxTransfer *transfer);
 
+// return transfer ID of the request (see on_get_*_response) or negative error
 int16_t automation_send_get_dis(uint8_t destination_node_id, uint8_t index, uint8_t len);
 int16_t automation_send_get_ais(uint8_t destination_node_id, uint8_t index, uint8_t len);
 int16_t automation_send_tell_dis(uint8_t index, const bool *values, uint8_t len);
 int16_t automation_send_tell_ais(uint8_t index, const uint16_t *values, uint8_t len);
+// latch inputs and apply staged outputs on all nodes
+int16_t automation_send_sync(void);
+// ask the node for its IO counts, return transfer ID of the request (see
+// on_get_inventory_response) or negative error
+int16_t automation_send_get_inventory(uint8_t destination_node_id);
 
 int16_t automation_send_set_dos(uint8_t destination_node_id,
                                uint8_t start_output_id,
@@ -34,17 +106,61 @@ int16_t automation_send_set_aos(uint8_t destination_node_id,
                                uint8_t values_len,
                                uint8_t priority);
 
+// Instance API, same as above. Transfers of the node must be passed to
+// uavcan_automation_handle_transfer() by uavcan_user_on_transfer_received()
+// (uavcan_node_of(ins)->user_reference can point to the instance).
+void uavcan_automation_init(uavcan_automation_t *a,
+                            uavcan_node_t *node,
+                            const uavcan_automation_callbacks_t *callbacks);
+bool uavcan_automation_handle_transfer(uavcan_automation_t *a, CanardInstance *ins, CanardRxTransfer *transfer);
+
+int16_t uavcan_automation_send_get_dis(uavcan_automation_t *a, uint8_t destination_node_id, uint8_t index, uint8_t len);
+int16_t uavcan_automation_send_get_ais(uavcan_automation_t *a, uint8_t destination_node_id, uint8_t index, uint8_t len);
+int16_t uavcan_automation_send_tell_dis(uavcan_automation_t *a, uint8_t index, const bool *values, uint8_t len);
+int16_t uavcan_automation_send_tell_ais(uavcan_automation_t *a, uint8_t index, const uint16_t *values, uint8_t len);
+int16_t uavcan_automation_send_sync(uavcan_automation_t *a);
+int16_t uavcan_automation_send_get_inventory(uavcan_automation_t *a, uint8_t destination_node_id);
+
+int16_t uavcan_automation_send_set_dos(uavcan_automation_t *a,
+                                       uint8_t destination_node_id,
+                                       uint8_t start_output_id,
+                                       const bool *values,
+                                       uint8_t values_len,
+                                       uint8_t priority);
+
+int16_t uavcan_automation_send_set_aos(uavcan_automation_t *a,
+                                       uint8_t destination_node_id,
+                                       uint8_t start_output_id,
+                                       const uint16_t *values,
+                                       uint8_t values_len,
+                                       uint8_t priority);
+
+// the instance used by the single instance API
+extern uavcan_automation_t uavcan_default_automation;
+
+// decode values [first, first + count) to `dest`, false on error
+bool automation_read_dis(const automation_values_t *values, uint8_t first, uint8_t count, bool *dest);
+bool automation_read_ais(const automation_values_t *values, uint8_t first, uint8_t count, uint16_t *dest);
+
 // callbacks
 
 uint8_t automation_set_dos(uint8_t source_node_id, uint8_t output_id, const bool *values, uint8_t len);
 uint8_t automation_set_aos(uint8_t source_node_id, uint8_t output_id, const uint16_t *values, uint8_t len);
 uint8_t automation_get_dis(uint8_t source_node_id, uint8_t index, bool *values, uint8_t len);
 uint8_t automation_get_ais(uint8_t source_node_id, uint8_t index, uint16_t *values, uint8_t len);
-void automation_on_get_dis_response(uint8_t source_node_id, uint8_t index, bool *values, uint8_t len);
-void automation_on_get_ais_response(uint8_t source_node_id, uint8_t index, uint16_t *values, uint8_t len);
-void automation_on_tell_dis(uint8_t source_node_id, uint8_t index, bool *values, uint8_t len);
-void automation_on_tell_ais(uint8_t source_node_id, uint8_t index, uint16_t *values, uint8_t len);
+void automation_on_get_dis_response(uint8_t source_node_id, uint8_t transfer_id, uint8_t index, const automation_values_t *values);
+void automation_on_get_ais_response(uint8_t source_node_id, uint8_t transfer_id, uint8_t index, const automation_values_t *values);
+// GetValues request failed, `result` is AUTOMATION_GETVALUES_RESPONSE_* (not
+// OK), match the request by the transfer ID (DI/AI requests share them)
+void automation_on_get_values_error(uint8_t source_node_id, uint8_t transfer_id, uint8_t index, uint8_t result);
+void automation_on_tell_dis(uint8_t source_node_id, uint8_t index, const automation_values_t *values);
+void automation_on_tell_ais(uint8_t source_node_id, uint8_t index, const automation_values_t *values);
+void automation_on_sync(uint8_t source_node_id, uint8_t counter);
+// fill in IO counts of this node (the response is zeroed)
+void automation_get_inventory(uint8_t source_node_id, automation_GetInventoryResponse *inventory);
+void automation_on_get_inventory_response(uint8_t source_node_id, uint8_t transfer_id, const automation_GetInventoryResponse *inventory);
 
 #ifdef __cplusplus
 }
 #endif
+#endif // UAVCAN_AUTOMATION_H
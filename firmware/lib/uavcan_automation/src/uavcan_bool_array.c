@@ -0,0 +1,126 @@
+#include "uavcan_bool_array.h"
+
+#define WORD_BITS 32
+
+/*
+A scalar of `bits` length is sent by libcanard as little endian bytes, each
+byte MSB first, and the last byte of an incomplete one (bits % 8) holds the
+value in its low bits. So an item `i` of a chunk is bit (7 - i % 8) of byte
+i / 8 of the word, or bit (bits % 8 - 1 - i % 8) of the last incomplete byte.
+*/
+
+// number of bits of byte `byte` of a `bits` long word
+static uint8_t byte_bits(uint8_t bits, uint8_t byte)
+{
+    return (bits - byte * 8 >= 8) ? 8 : bits % 8;
+}
+
+static uint32_t pack_word(const bool *values, uint8_t bits)
+{
+    uint32_t word = 0;
+
+    for (uint8_t byte = 0; byte * 8 < bits; byte++)
+    {
+        const uint8_t n = byte_bits(bits, byte);
+        uint8_t packed = 0;
+
+        for (uint8_t i = 0; i < n; i++)
+        {
+            packed = (uint8_t)(packed << 1) | (*values++ ? 1 : 0);
+        }
+        word |= (uint32_t)packed << (byte * 8);
+    }
+    return word;
+}
+
+static void unpack_word(uint32_t word, bool *values, uint8_t bits)
+{
+    for (uint8_t byte = 0; byte * 8 < bits; byte++, word >>= 8)
+    {
+        const uint8_t n = byte_bits(bits, byte);
+
+        for (uint8_t i = n; i > 0; i--)
+        {
+            *values++ = (word >> (i - 1)) & 1;
+        }
+    }
+}
+
+uint32_t uavcan_encode_bool_array(void *msg_buf, uint32_t offset, const bool *values, uint8_t len)
+{
+    while (len)
+    {
+        const uint8_t bits = (len > WORD_BITS) ? WORD_BITS : len;
+        const uint32_t word = pack_word(values, bits);
+
+        // canardEncodeScalar() reads a value of the type matching `bits`
+        if (bits == 1)
+        {
+            const bool value = word;
+            canardEncodeScalar(msg_buf, offset, bits, &value);
+        }
+        else if (bits <= 8)
+        {
+            const uint8_t value = word;
+            canardEncodeScalar(msg_buf, offset, bits, &value);
+        }
+        else if (bits <= 16)
+        {
+            const uint16_t value = word;
+            canardEncodeScalar(msg_buf, offset, bits, &value);
+        }
+        else
+        {
+            canardEncodeScalar(msg_buf, offset, bits, &word);
+        }
+
+        offset += bits;
+        values += bits;
+        len -= bits;
+    }
+    return offset;
+}
+
+int32_t uavcan_decode_bool_array(const CanardRxTransfer *transfer, uint32_t offset, bool *values, uint8_t len)
+{
+    while (len)
+    {
+        const uint8_t bits = (len > WORD_BITS) ? WORD_BITS : len;
+        uint32_t word;
+        int16_t ret;
+
+        // canardDecodeScalar() writes a value of the type matching `bits`
+        if (bits == 1)
+        {
+            bool value;
+            ret = canardDecodeScalar(transfer, offset, bits, false, &value);
+            word = value;
+        }
+        else if (bits <= 8)
+        {
+            uint8_t value;
+            ret = canardDecodeScalar(transfer, offset, bits, false, &value);
+            word = value;
+        }
+        else if (bits <= 16)
+        {
+            uint16_t value;
+            ret = canardDecodeScalar(transfer, offset, bits, false, &value);
+            word = value;
+        }
+        else
+        {
+            ret = canardDecodeScalar(transfer, offset, bits, false, &word);
+        }
+        if (ret != bits)
+        {
+            return (ret < 0) ? ret : -CANARD_ERROR_INTERNAL;
+        }
+
+        unpack_word(word, values, bits);
+        offset += bits;
+        values += bits;
+        len -= bits;
+    }
+    return (int32_t)offset;
+}
@@ -0,0 +1,28 @@
+#ifndef UAVCAN_BOOL_ARRAY_H
+#define UAVCAN_BOOL_ARRAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "canard.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Bool arrays codec, same wire format as a loop of 1 bit canardEncodeScalar()
+// / canardDecodeScalar() calls, but the items are packed into words and
+// passed to libcanard up to 32 at once.
+
+// Encode `len` items at bit `offset` of `msg_buf`, returns the new offset.
+uint32_t uavcan_encode_bool_array(void *msg_buf, uint32_t offset, const bool *values, uint8_t len);
+
+// Decode `len` items at bit `offset` of `transfer` payload. Returns the new
+// offset or a negative error (libcanard error, -CANARD_ERROR_INTERNAL when the
+// payload is too short).
+int32_t uavcan_decode_bool_array(const CanardRxTransfer *transfer, uint32_t offset, bool *values, uint8_t len);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // UAVCAN_BOOL_ARRAY_H
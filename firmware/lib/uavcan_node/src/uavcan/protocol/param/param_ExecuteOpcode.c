@@ -0,0 +1,250 @@
+/*
+ * UAVCAN data structure definition for libcanard.
+ *
+ * Autogenerated, do not edit.
+ *
+ * Source file: /home/mprymek/P/bastling/platformio/examples/mcu-plc-demo/lib/libcanard/libcanard/dsdl_compiler/pyuavcan/uavcan/dsdl_files/uavcan/protocol/param/10.ExecuteOpcode.uavcan
+ */
+#include "uavcan/protocol/param/ExecuteOpcode.h"
+#include "canard.h"
+
+#ifndef CANARD_INTERNAL_SATURATE
+#define CANARD_INTERNAL_SATURATE(x, max) ( ((x) > max) ? max : ( (-(x) > max) ? (-max) : (x) ) );
+#endif
+
+#ifndef CANARD_INTERNAL_SATURATE_UNSIGNED
+#define CANARD_INTERNAL_SATURATE_UNSIGNED(x, max) ( ((x) >= max) ? max : (x) );
+#endif
+
+#if defined(__GNUC__)
+# define CANARD_MAYBE_UNUSED(x) x __attribute__((unused))
+#else
+# define CANARD_MAYBE_UNUSED(x) x
+#endif
+
+/**
+  * @brief uavcan_protocol_param_ExecuteOpcodeRequest_encode_internal
+  * @param source : pointer to source data struct
+  * @param msg_buf: pointer to msg storage
+  * @param offset: bit offset to msg storage
+  * @param root_item: for detecting if TAO should be used
+  * @retval returns new offset
+  */
+uint32_t uavcan_protocol_param_ExecuteOpcodeRequest_encode_internal(uavcan_protocol_param_ExecuteOpcodeRequest* source,
+  void* msg_buf,
+  uint32_t offset,
+  uint8_t CANARD_MAYBE_UNUSED(root_item))
+{
+    canardEncodeScalar(msg_buf, offset, 8, (void*)&source->opcode); // 255
+    offset += 8;
+
+    source->argument = CANARD_INTERNAL_SATURATE(source->argument, 140737488355327)
+    canardEncodeScalar(msg_buf, offset, 48, (void*)&source->argument); // 140737488355327
+    offset += 48;
+
+    return offset;
+}
+
+/**
+  * @brief uavcan_protocol_param_ExecuteOpcodeRequest_encode
+  * @param source : Pointer to source data struct
+  * @param msg_buf: Pointer to msg storage
+  * @retval returns message length as bytes
+  */
+uint32_t uavcan_protocol_param_ExecuteOpcodeRequest_encode(uavcan_protocol_param_ExecuteOpcodeRequest* source, void* msg_buf)
+{
+    uint32_t offset = 0;
+
+    offset = uavcan_protocol_param_ExecuteOpcodeRequest_encode_internal(source, msg_buf, offset, 1);
+
+    return (offset + 7 ) / 8;
+}
+
+/**
+  * @brief uavcan_protocol_param_ExecuteOpcodeRequest_decode_internal
+  * @param transfer: Pointer to CanardRxTransfer transfer
+  * @param payload_len: Payload message length
+  * @param dest: Pointer to destination struct
+  * @param dyn_arr_buf: NULL or Pointer to memory storage to be used for dynamic arrays
+  *                     uavcan_protocol_param_ExecuteOpcodeRequest dyn memory will point to dyn_arr_buf memory.
+  *                     NULL will ignore dynamic arrays decoding.
+  * @param offset: Call with 0, bit offset to msg storage
+  * @retval new offset or ERROR value if < 0
+  */
+int32_t uavcan_protocol_param_ExecuteOpcodeRequest_decode_internal(
+  const CanardRxTransfer* transfer,
+  uint16_t CANARD_MAYBE_UNUSED(payload_len),
+  uavcan_protocol_param_ExecuteOpcodeRequest* dest,
+  uint8_t** CANARD_MAYBE_UNUSED(dyn_arr_buf),
+  int32_t offset)
+{
+    int32_t ret = 0;
+
+    ret = canardDecodeScalar(transfer, (uint32_t)offset, 8, false, (void*)&dest->opcode);
+    if (ret != 8)
+    {
+        goto uavcan_protocol_param_ExecuteOpcodeRequest_error_exit;
+    }
+    offset += 8;
+
+    ret = canardDecodeScalar(transfer, (uint32_t)offset, 48, true, (void*)&dest->argument);
+    if (ret != 48)
+    {
+        goto uavcan_protocol_param_ExecuteOpcodeRequest_error_exit;
+    }
+    offset += 48;
+    return offset;
+
+uavcan_protocol_param_ExecuteOpcodeRequest_error_exit:
+    if (ret < 0)
+    {
+        return ret;
+    }
+    else
+    {
+        return -CANARD_ERROR_INTERNAL;
+    }
+}
+
+/**
+  * @brief uavcan_protocol_param_ExecuteOpcodeRequest_decode
+  * @param transfer: Pointer to CanardRxTransfer transfer
+  * @param payload_len: Payload message length
+  * @param dest: Pointer to destination struct
+  * @param dyn_arr_buf: NULL or Pointer to memory storage to be used for dynamic arrays
+  *                     uavcan_protocol_param_ExecuteOpcodeRequest dyn memory will point to dyn_arr_buf memory.
+  *                     NULL will ignore dynamic arrays decoding.
+  * @retval offset or ERROR value if < 0
+  */
+int32_t uavcan_protocol_param_ExecuteOpcodeRequest_decode(const CanardRxTransfer* transfer,
+  uint16_t payload_len,
+  uavcan_protocol_param_ExecuteOpcodeRequest* dest,
+  uint8_t** dyn_arr_buf)
+{
+    const int32_t offset = 0;
+    int32_t ret = 0;
+
+    // Clear the destination struct
+    for (uint32_t c = 0; c < sizeof(uavcan_protocol_param_ExecuteOpcodeRequest); c++)
+    {
+        ((uint8_t*)dest)[c] = 0x00;
+    }
+
+    ret = uavcan_protocol_param_ExecuteOpcodeRequest_decode_internal(transfer, payload_len, dest, dyn_arr_buf, offset);
+
+    return ret;
+}
+
+/**
+  * @brief uavcan_protocol_param_ExecuteOpcodeResponse_encode_internal
+  * @param source : pointer to source data struct
+  * @param msg_buf: pointer to msg storage
+  * @param offset: bit offset to msg storage
+  * @param root_item: for detecting if TAO should be used
+  * @retval returns new offset
+  */
+uint32_t uavcan_protocol_param_ExecuteOpcodeResponse_encode_internal(uavcan_protocol_param_ExecuteOpcodeResponse* source,
+  void* msg_buf,
+  uint32_t offset,
+  uint8_t CANARD_MAYBE_UNUSED(root_item))
+{
+    source->argument = CANARD_INTERNAL_SATURATE(source->argument, 140737488355327)
+    canardEncodeScalar(msg_buf, offset, 48, (void*)&source->argument); // 140737488355327
+    offset += 48;
+
+    source->ok = CANARD_INTERNAL_SATURATE_UNSIGNED(source->ok, 1)
+    canardEncodeScalar(msg_buf, offset, 1, (void*)&source->ok); // 1
+    offset += 1;
+
+    return offset;
+}
+
+/**
+  * @brief uavcan_protocol_param_ExecuteOpcodeResponse_encode
+  * @param source : Pointer to source data struct
+  * @param msg_buf: Pointer to msg storage
+  * @retval returns message length as bytes
+  */
+uint32_t uavcan_protocol_param_ExecuteOpcodeResponse_encode(uavcan_protocol_param_ExecuteOpcodeResponse* source, void* msg_buf)
+{
+    uint32_t offset = 0;
+
+    offset = uavcan_protocol_param_ExecuteOpcodeResponse_encode_internal(source, msg_buf, offset, 1);
+
+    return (offset + 7 ) / 8;
+}
+
+/**
+  * @brief uavcan_protocol_param_ExecuteOpcodeResponse_decode_internal
+  * @param transfer: Pointer to CanardRxTransfer transfer
+  * @param payload_len: Payload message length
+  * @param dest: Pointer to destination struct
+  * @param dyn_arr_buf: NULL or Pointer to memory storage to be used for dynamic arrays
+  *                     uavcan_protocol_param_ExecuteOpcodeResponse dyn memory will point to dyn_arr_buf memory.
+  *                     NULL will ignore dynamic arrays decoding.
+  * @param offset: Call with 0, bit offset to msg storage
+  * @retval new offset or ERROR value if < 0
+  */
+int32_t uavcan_protocol_param_ExecuteOpcodeResponse_decode_internal(
+  const CanardRxTransfer* transfer,
+  uint16_t CANARD_MAYBE_UNUSED(payload_len),
+  uavcan_protocol_param_ExecuteOpcodeResponse* dest,
+  uint8_t** CANARD_MAYBE_UNUSED(dyn_arr_buf),
+  int32_t offset)
+{
+    int32_t ret = 0;
+
+    ret = canardDecodeScalar(transfer, (uint32_t)offset, 48, true, (void*)&dest->argument);
+    if (ret != 48)
+    {
+        goto uavcan_protocol_param_ExecuteOpcodeResponse_error_exit;
+    }
+    offset += 48;
+
+    ret = canardDecodeScalar(transfer, (uint32_t)offset, 1, false, (void*)&dest->ok);
+    if (ret != 1)
+    {
+        goto uavcan_protocol_param_ExecuteOpcodeResponse_error_exit;
+    }
+    offset += 1;
+    return offset;
+
+uavcan_protocol_param_ExecuteOpcodeResponse_error_exit:
+    if (ret < 0)
+    {
+        return ret;
+    }
+    else
+    {
+        return -CANARD_ERROR_INTERNAL;
+    }
+}
+
+/**
+  * @brief uavcan_protocol_param_ExecuteOpcodeResponse_decode
+  * @param transfer: Pointer to CanardRxTransfer transfer
+  * @param payload_len: Payload message length
+  * @param dest: Pointer to destination struct
+  * @param dyn_arr_buf: NULL or Pointer to memory storage to be used for dynamic arrays
+  *                     uavcan_protocol_param_ExecuteOpcodeResponse dyn memory will point to dyn_arr_buf memory.
+  *                     NULL will ignore dynamic arrays decoding.
+  * @retval offset or ERROR value if < 0
+  */
+int32_t uavcan_protocol_param_ExecuteOpcodeResponse_decode(const CanardRxTransfer* transfer,
+  uint16_t payload_len,
+  uavcan_protocol_param_ExecuteOpcodeResponse* dest,
+  uint8_t** dyn_arr_buf)
+{
+    const int32_t offset = 0;
+    int32_t ret = 0;
+
+    // Clear the destination struct
+    for (uint32_t c = 0; c < sizeof(uavcan_protocol_param_ExecuteOpcodeResponse); c++)
+    {
+        ((uint8_t*)dest)[c] = 0x00;
+    }
+
+    ret = uavcan_protocol_param_ExecuteOpcodeResponse_decode_internal(transfer, payload_len, dest, dyn_arr_buf, offset);
+
+    return ret;
+}
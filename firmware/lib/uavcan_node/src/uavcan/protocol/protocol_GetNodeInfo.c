@@ -149,8 +149,8 @@ int32_t uavcan_protocol_GetNodeInfoResponse_decode_internal(
         goto uavcan_protocol_GetNodeInfoResponse_error_exit;
     }
 
-    // Compound
-    offset = uavcan_protocol_HardwareVersion_decode_internal(transfer, payload_len, &dest->hardware_version, dyn_arr_buf, offset);
+    // Compound, not the last field => no tail array optimization (fixed by hand)
+    offset = uavcan_protocol_HardwareVersion_decode_internal(transfer, 0, &dest->hardware_version, dyn_arr_buf, offset);
     if (offset < 0)
     {
         ret = offset;
@@ -0,0 +1,129 @@
+#include "uavcan_node.h"
+#include "uavcan_filters.h"
+
+#ifndef UAVCAN_FILTERS_MAX_TYPES
+// filters planned before the merging starts (limits stack usage)
+#define UAVCAN_FILTERS_MAX_TYPES 16
+#endif
+
+bool uavcan_should_accept_transfer(const CanardInstance *ins,
+                                   uint64_t *out_data_type_signature,
+                                   uint16_t data_type_id,
+                                   CanardTransferType transfer_type,
+                                   uint8_t source_node_id);
+
+static bool accepts(const uavcan_node_t *node, uint16_t data_type_id, CanardTransferType transfer_type)
+{
+    uint64_t signature;
+
+    return uavcan_should_accept_transfer(&node->canard, &signature, data_type_id, transfer_type, 0);
+}
+
+static uint8_t bits_count(uint32_t value)
+{
+    uint8_t count = 0;
+
+    for (; value; value &= value - 1)
+    {
+        count++;
+    }
+    return count;
+}
+
+// the narrowest filter accepting frames of both `a` and `b`
+static uavcan_can_filter_t merged(const uavcan_can_filter_t *a, const uavcan_can_filter_t *b)
+{
+    uavcan_can_filter_t res;
+
+    res.mask = a->mask & b->mask & ~(a->id ^ b->id);
+    res.id = a->id & res.mask;
+    return res;
+}
+
+// merge the two filters losing the least mask bits
+static void merge_best(uavcan_can_filter_t *filters, uint8_t *len)
+{
+    uint8_t best_i = 0, best_j = 1;
+    int8_t best_bits = -1;
+
+    for (uint8_t i = 0; i < *len; i++)
+    {
+        for (uint8_t j = i + 1; j < *len; j++)
+        {
+            uint8_t bits = bits_count(merged(&filters[i], &filters[j]).mask);
+            if (bits > best_bits)
+            {
+                best_bits = bits;
+                best_i = i;
+                best_j = j;
+            }
+        }
+    }
+    filters[best_i] = merged(&filters[best_i], &filters[best_j]);
+    filters[best_j] = filters[--(*len)];
+}
+
+uint8_t uavcan_node_plan_filters(const uavcan_node_t *node, uavcan_can_filter_t *filters, uint8_t max_len)
+{
+    const uint8_t node_id = canardGetLocalNodeID(&node->canard);
+    // one more to be merged
+    uavcan_can_filter_t planned[UAVCAN_FILTERS_MAX_TYPES + 1];
+    uint8_t len = 0;
+
+    // Node not initialized yet (or anonymous), services to it can't be
+    // filtered - accept all frames rather than drop them in HW.
+    if (max_len == 0 || node_id == CANARD_BROADCAST_NODE_ID)
+    {
+        return 0;
+    }
+
+    // Services addressed to this node. Service type IDs are not filtered,
+    // libcanard does that cheaply and requests to a node are rare anyway.
+    for (uint16_t type = 0; type <= 0xFF; type++)
+    {
+        if (accepts(node, type, CanardTransferTypeRequest) || accepts(node, type, CanardTransferTypeResponse))
+        {
+            planned[len].id = ((uint32_t)node_id << 8) | UAVCAN_FILTER_SERVICE_BIT;
+            planned[len].mask = UAVCAN_FILTER_SERVICE_MASK;
+            len++;
+            break;
+        }
+    }
+
+    // messages, one filter per data type
+    uint16_t type = 0;
+    do
+    {
+        if (accepts(node, type, CanardTransferTypeBroadcast))
+        {
+            planned[len].id = (uint32_t)type << 8;
+            planned[len].mask = UAVCAN_FILTER_MESSAGE_MASK;
+            len++;
+            if (len > UAVCAN_FILTERS_MAX_TYPES)
+            {
+                merge_best(planned, &len);
+            }
+        }
+    } while (++type != 0);
+
+    while (len > max_len)
+    {
+        merge_best(planned, &len);
+    }
+
+    for (uint8_t i = 0; i < len; i++)
+    {
+        // accepts all frames
+        if (planned[i].mask == 0)
+        {
+            return 0;
+        }
+        filters[i] = planned[i];
+    }
+    return len;
+}
+
+uint8_t uavcan_plan_filters(uavcan_can_filter_t *filters, uint8_t max_len)
+{
+    return uavcan_node_plan_filters(&uavcan_default_node, filters, max_len);
+}
@@ -0,0 +1,49 @@
+#ifndef UAVCAN_FILTERS_H
+#define UAVCAN_FILTERS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Hardware CAN acceptance filters planning. Accepted transfers are found by
+// probing uavcan_should_accept_transfer(), so filters always match the
+// software acceptance tables.
+//
+// Filters apply to extended (29 bit) frames, a frame is accepted when
+//   (frame_id & mask) == (id & mask)
+// for any of the filters.
+
+// message frame: data type ID and "service not message" bit
+#define UAVCAN_FILTER_MESSAGE_MASK 0xFFFF80UL
+// service frame addressed to this node: destination and "service" bit
+#define UAVCAN_FILTER_SERVICE_MASK 0x007F80UL
+#define UAVCAN_FILTER_SERVICE_BIT 0x80UL
+
+typedef struct
+{
+    uint32_t id;
+    uint32_t mask;
+} uavcan_can_filter_t;
+
+/*
+Fill in at most `max_len` filters accepting all frames of the transfers this
+node accepts (and usually some more when there are not enough filters). Returns
+the number of filters, 0 means "accept all" (also for a node without node ID).
+Must not be called before uavcan_init() and before
+uavcan_user_should_accept_transfer() is ready to accept transfers. Filters must
+be planned again when the node ID changes.
+*/
+uint8_t uavcan_plan_filters(uavcan_can_filter_t *filters, uint8_t max_len);
+
+// same for `node` (see uavcan_node_init())
+struct uavcan_node;
+uint8_t uavcan_node_plan_filters(const struct uavcan_node *node, uavcan_can_filter_t *filters, uint8_t max_len);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // UAVCAN_FILTERS_H
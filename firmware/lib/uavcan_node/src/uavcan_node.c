@@ -5,6 +5,7 @@
 #include "uavcan/protocol/NodeStatus.h"
 #include "uavcan/protocol/GetNodeInfo.h"
 #include "uavcan/protocol/RestartNode.h"
+#include "uavcan/protocol/GetTransportStats.h"
 #include "uavcan/protocol/param/GetSet.h"
 #include "uavcan/protocol/debug/LogMessage.h"
 
@@ -14,13 +15,28 @@
 #define UAVCAN_MEM_POOL_SIZE 1024
 #endif
 
-// globals
-volatile uavcan_protocol_NodeStatus uavcan_node_status;
-uavcan_protocol_GetNodeInfoResponse uavcan_node_info;
+// TX is suspended for this long after CAN driver error, the delay doubles
+// with each failed attempt up to UAVCAN_TX_BACKOFF_MAX [us]
+#ifndef UAVCAN_TX_BACKOFF_MIN
+#define UAVCAN_TX_BACKOFF_MIN 1000
+#endif
+#ifndef UAVCAN_TX_BACKOFF_MAX
+#define UAVCAN_TX_BACKOFF_MAX 100000
+#endif
+// an interface with no free TX buffer for this long is handled as failed [us]
+#ifndef UAVCAN_TX_BUSY_TIMEOUT
+#define UAVCAN_TX_BUSY_TIMEOUT UAVCAN_TX_BACKOFF_MAX
+#endif
 
-CanardInstance g_canard;                                   //The library instance
+#ifndef UAVCAN_RX_DEDUP_WINDOW
+// Redundant interfaces: the same frame received from another interface within
+// this time is a duplicate [ms]
+#define UAVCAN_RX_DEDUP_WINDOW 20
+#endif
+
+// globals
+uavcan_node_t uavcan_default_node;
 static uint8_t g_canard_memory_pool[UAVCAN_MEM_POOL_SIZE]; //Arena for memory allocation, used by the library
-static bool restart_pending = false;
 
 void uavcan_on_transfer_received(CanardInstance *ins, CanardRxTransfer *transfer);
 bool uavcan_should_accept_transfer(const CanardInstance *ins,
@@ -32,89 +48,398 @@ bool uavcan_should_accept_transfer(const CanardInstance *ins,
 static void handle_NodeStatus(CanardInstance *ins, CanardRxTransfer *transfer);
 static void handle_GetNodeInfo(CanardInstance *ins, CanardRxTransfer *transfer);
 static void handle_RestartNode(CanardInstance *ins, CanardRxTransfer *transfer);
+#if UAVCAN_WITH_PARAM_GETSET
 static void handle_param_GetSet(CanardInstance *ins, CanardRxTransfer *transfer);
+static void handle_param_ExecuteOpcode(CanardInstance *ins, CanardRxTransfer *transfer);
+#endif
+#if UAVCAN_WITH_STATS
+static void handle_GetTransportStats(CanardInstance *ins, CanardRxTransfer *transfer);
+#endif
+#if UAVCAN_WITH_NODE_INFO_REQUESTS
+static void handle_GetNodeInfo_resp(CanardInstance *ins, CanardRxTransfer *transfer);
+#endif
 
-void uavcan_init()
+// all transfers are queued through this (see stats)
+static int16_t queued(uavcan_node_t *node, int16_t res)
+{
+    if (res > 0)
+    {
+        node->tx_backlog += res;
+    }
+    else if (res == -CANARD_ERROR_OUT_OF_MEMORY)
+    {
+        node->pool_alloc_failures++;
+    }
+#if UAVCAN_WITH_STATS
+    uavcan_stats_tx_queued(&node->stats, res);
+#endif
+    return res;
+}
+
+uavcan_node_t *uavcan_node_of(const CanardInstance *ins)
 {
-    memset(&uavcan_node_info, 0, sizeof(uavcan_node_info));
-    memset(&uavcan_node_status, 0, sizeof(uavcan_node_status));
-    uavcan_node_status.mode = UAVCAN_PROTOCOL_NODESTATUS_MODE_INITIALIZATION;
+    return (uavcan_node_t *)canardGetUserReference((CanardInstance *)ins);
+}
 
-    canardInit(&g_canard,                     // Uninitialized library instance
-               g_canard_memory_pool,          // Raw memory chunk used for dynamic allocation
-               sizeof(g_canard_memory_pool),  // Size of the above, in bytes
+void uavcan_node_init(uavcan_node_t *node,
+                      uint8_t node_id,
+                      void *mem_pool,
+                      size_t mem_pool_size,
+                      const uavcan_can_iface_t *ifaces,
+                      uint8_t ifaces_len)
+{
+    memset(node, 0, sizeof(*node));
+    if (ifaces_len > UAVCAN_CAN_IFACES)
+    {
+        ifaces_len = UAVCAN_CAN_IFACES;
+    }
+    memcpy(node->ifaces, ifaces, ifaces_len * sizeof(ifaces[0]));
+    node->ifaces_len = ifaces_len;
+    node->status.mode = UAVCAN_PROTOCOL_NODESTATUS_MODE_INITIALIZATION;
+
+    canardInit(&node->canard,                 // Uninitialized library instance
+               mem_pool,                      // Raw memory chunk used for dynamic allocation
+               mem_pool_size,                 // Size of the above, in bytes
                uavcan_on_transfer_received,   // Callback, see CanardOnTransferReception
                uavcan_should_accept_transfer, // Callback, see CanardShouldAcceptTransfer
-               NULL);
+               node);
+
+    canardSetLocalNodeID(&node->canard, node_id);
+}
 
-    canardSetLocalNodeID(&g_canard, UAVCAN_NODE_ID);
+static bool iface_down(const uavcan_iface_state_t *state, uint64_t now)
+{
+    return state->tx_backoff && now < state->tx_retry_at;
 }
 
-void uavcan_flush()
+// TX state of queued frame `txf`, a new one when it's seen for the first time
+static uavcan_tx_frame_t *tx_frame(uavcan_node_t *node, const CanardCANFrame *txf, uint8_t all_ifaces)
 {
-    const CanardCANFrame *txf = canardPeekTxQueue(&g_canard);
-    while (txf)
+    uavcan_tx_frame_t *entry = NULL;
+
+    for (uint8_t i = 0; i < UAVCAN_TX_TRACKED_FRAMES; i++)
     {
-        const int tx_res = uavcan_can_tx(txf);
-        if (tx_res == 0)
+        uavcan_tx_frame_t *f = &node->tx_frames[i];
+        if (f->frame == txf)
         {
-            canardPopTxQueue(&g_canard);
+            return f;
+        }
+        // prefer free entries, then frames not sent anywhere yet (nothing is
+        // lost by forgetting them)
+        if (entry == NULL || (entry->frame != NULL && (f->frame == NULL || f->pending == all_ifaces)))
+        {
+            entry = f;
         }
-        txf = canardPeekTxQueue(&g_canard);
     }
+    if (entry->frame != NULL && entry->pending != all_ifaces)
+    {
+        // all taken by preempted frames, one of them will be sent to all the
+        // interfaces again
+        entry = &node->tx_frames[node->tx_frames_evict];
+        node->tx_frames_evict = (node->tx_frames_evict + 1) % UAVCAN_TX_TRACKED_FRAMES;
+    }
+
+    entry->frame = txf;
+    entry->pending = all_ifaces;
+    entry->sent = false;
+    return entry;
 }
 
-void uavcan_update()
+static void tx_error(uavcan_iface_state_t *state, uint64_t now)
 {
-    CanardCANFrame frame;
+    state->errors++;
+    state->tx_busy = false;
+    state->tx_backoff = state->tx_backoff ? state->tx_backoff * 2 : UAVCAN_TX_BACKOFF_MIN;
+    if (state->tx_backoff > UAVCAN_TX_BACKOFF_MAX)
+    {
+        state->tx_backoff = UAVCAN_TX_BACKOFF_MAX;
+    }
+    state->tx_retry_at = now + state->tx_backoff;
+}
+
+// send the first frame of the queue to the interfaces it wasn't sent to yet,
+// returns the result of the last attempt
+static int tx_head(uavcan_node_t *node, const CanardCANFrame *txf, uavcan_tx_frame_t *f, bool *busy)
+{
+    const uint64_t now = uavcan_uptime_usec();
+    // nothing tried yet (all interfaces down)
+    int tx_res = UAVCAN_CAN_TX_BUSY;
+
+    *busy = false;
+    for (uint8_t i = 0; i < node->ifaces_len; i++)
+    {
+        uavcan_iface_state_t *state = &node->iface_state[i];
+
+        if (!(f->pending & (1U << i)) || iface_down(state, now))
+        {
+            continue;
+        }
+
+        tx_res = node->ifaces[i].tx(node->ifaces[i].ctx, txf);
+        if (tx_res == UAVCAN_CAN_TX_BUSY)
+        {
+            if (!state->tx_busy)
+            {
+                state->tx_busy = true;
+                state->tx_busy_since = now;
+            }
+            // No ACK on a cut bus, the controller retransmits forever and
+            // its buffers stay full. Don't let it hold the other interfaces,
+            // it's down as after an error (still busy after the back-off,
+            // it's down again right away).
+            if (state->tx_backoff || now - state->tx_busy_since >= UAVCAN_TX_BUSY_TIMEOUT)
+            {
+                tx_error(state, now);
+                continue;
+            }
+            // no free TX buffer, continue on the next call
+            *busy = true;
+            continue;
+        }
+        if (tx_res < 0 && tx_res != UAVCAN_CAN_TX_INVALID)
+        {
+            // bus off, driver stopped, ... => back off, the frame is retried
+            tx_error(state, now);
+            continue;
+        }
+
+        // sent or invalid (dropped)
+        if (tx_res == UAVCAN_CAN_TX_OK)
+        {
+            state->frames_tx++;
+            f->sent = true;
+        }
+        else
+        {
+            state->errors++;
+        }
+        state->tx_busy = false;
+        state->tx_backoff = 0;
+        f->pending &= ~(1U << i);
+    }
+    return tx_res;
+}
+
+uint16_t uavcan_node_flush(uavcan_node_t *node)
+{
+    const uint8_t all_ifaces = (1U << node->ifaces_len) - 1;
+    const CanardCANFrame *txf;
+
+    while ((txf = canardPeekTxQueue(&node->canard)))
+    {
+        // A higher priority frame may take over the head of the queue, the
+        // interfaces a preempted frame was sent to are kept with the frame.
+        uavcan_tx_frame_t *f = tx_frame(node, txf, all_ifaces);
+
+        bool busy;
+#if UAVCAN_WITH_STATS
+        const int tx_res = tx_head(node, txf, f, &busy);
+#else
+        tx_head(node, txf, f, &busy);
+#endif
+
+        // Interfaces which are down are skipped, so that the others don't
+        // wait for them. The frame stays in the queue only when it wasn't
+        // sent at all or an interface is busy. Every frame goes to all the
+        // buses, receivers take the first copy of each frame (see
+        // rx_deduplicate()).
+        bool done = f->pending == 0 || (f->pending != all_ifaces && !busy);
+        if (!done)
+        {
+#if UAVCAN_WITH_STATS
+            uavcan_stats_tx_frame(&node->stats, txf, busy ? UAVCAN_CAN_TX_BUSY : tx_res);
+#endif
+            break;
+        }
+
+#if UAVCAN_WITH_STATS
+        uavcan_stats_tx_frame(&node->stats, txf, f->sent ? UAVCAN_CAN_TX_OK : UAVCAN_CAN_TX_INVALID);
+#endif
+        canardPopTxQueue(&node->canard);
+        f->frame = NULL;
+        if (node->tx_backlog > 0)
+        {
+            node->tx_backlog--;
+        }
+    }
+
+    return node->tx_backlog;
+}
+
+uint16_t uavcan_node_tx_backlog(const uavcan_node_t *node)
+{
+    return node->tx_backlog;
+}
+
+bool uavcan_node_iface_up(const uavcan_node_t *node, uint8_t iface)
+{
+    return iface < node->ifaces_len && node->iface_state[iface].tx_backoff == 0;
+}
+
+#if UAVCAN_CAN_IFACES > 1
+static bool same_frame(const CanardCANFrame *a, const CanardCANFrame *b)
+{
+    return a->id == b->id && a->data_len == b->data_len && memcmp(a->data, b->data, a->data_len) == 0;
+}
+
+// False for a frame which came from another interface already. Frames are
+// compared whole, i.e. with the source, data type and the tail byte (transfer
+// ID, toggle, start and end of transfer), so the first copy of each frame is
+// taken from whichever bus delivers it first.
+static bool rx_deduplicate(uavcan_node_t *node, uint8_t iface, const CanardCANFrame *frame, uint64_t timestamp)
+{
+    if (node->ifaces_len < 2 || !(frame->id & CANARD_CAN_FRAME_EFF))
+    {
+        return true;
+    }
+
+    const uint32_t now_ms = timestamp / 1000U;
 
-    // RX
-    while (uavcan_can_rx(&frame))
+    for (uint8_t i = 0; i < UAVCAN_RX_DEDUP_FRAMES; i++)
     {
-        int16_t res = canardHandleRxFrame(&g_canard,
-                                          &frame,
-                                          uavcan_uptime_usec());
-        if (res != CANARD_OK && (res != -CANARD_ERROR_RX_NOT_WANTED) && (res != -CANARD_ERROR_RX_WRONG_ADDRESS))
+        uavcan_rx_frame_t *seen = &node->rx_frames[i];
+
+        // Frames of the same transfer may be equal (e.g. zeros), one seen
+        // from this interface already is another frame, not a copy.
+        if (seen->ifaces == 0 || (seen->ifaces & (1U << iface)) ||
+            now_ms - seen->time >= UAVCAN_RX_DEDUP_WINDOW || !same_frame(&seen->frame, frame))
         {
-            uavcan_error("Canard error: %d", -res);
+            continue;
         }
+        seen->ifaces |= 1U << iface;
+        node->rx_duplicates++;
+        return false;
+    }
+
+    uavcan_rx_frame_t *seen = &node->rx_frames[node->rx_frames_next];
+    node->rx_frames_next = (node->rx_frames_next + 1) % UAVCAN_RX_DEDUP_FRAMES;
+    seen->frame = *frame;
+    seen->time = now_ms;
+    seen->ifaces = 1U << iface;
+    return true;
+}
+#endif
+
+static void rx_frame(uavcan_node_t *node, const CanardCANFrame *frame, uint64_t timestamp)
+{
+    int16_t res = canardHandleRxFrame(&node->canard,
+                                      frame,
+                                      timestamp);
+#if UAVCAN_WITH_STATS
+    uavcan_stats_rx_frame(&node->stats, frame, res);
+#endif
+    if (res == -CANARD_ERROR_OUT_OF_MEMORY)
+    {
+        node->pool_alloc_failures++;
     }
+    if (res != CANARD_OK && (res != -CANARD_ERROR_RX_NOT_WANTED) && (res != -CANARD_ERROR_RX_WRONG_ADDRESS))
+    {
+        uavcan_error("Canard error: %d", -res);
+    }
+}
+
+void uavcan_node_update(uavcan_node_t *node)
+{
+    CanardCANFrame frame;
+    bool received;
+
+    // RX, interfaces take turns
+    do
+    {
+        received = false;
+        for (uint8_t i = 0; i < node->ifaces_len; i++)
+        {
+            uint64_t timestamp = uavcan_uptime_usec();
+            if (!node->ifaces[i].rx(node->ifaces[i].ctx, &frame, &timestamp))
+            {
+                continue;
+            }
+            received = true;
+            node->iface_state[i].frames_rx++;
+#if UAVCAN_CAN_IFACES > 1
+            if (!rx_deduplicate(node, i, &frame, timestamp))
+            {
+                continue;
+            }
+#endif
+            rx_frame(node, &frame, timestamp);
+        }
+    } while (received);
 
     uint64_t now_us = uavcan_uptime_usec();
 
     // should be called about once per second
-    static uint64_t last_cleanup = 0;
-    if (now_us - last_cleanup > CANARD_RECOMMENDED_STALE_TRANSFER_CLEANUP_INTERVAL_USEC)
+    if (now_us - node->last_cleanup > CANARD_RECOMMENDED_STALE_TRANSFER_CLEANUP_INTERVAL_USEC)
     {
-        canardCleanupStaleTransfers(&g_canard, uavcan_uptime_usec());
-        last_cleanup = now_us;
+        canardCleanupStaleTransfers(&node->canard, uavcan_uptime_usec());
+        node->last_cleanup = now_us;
     }
 
     // TX
-    uavcan_flush();
+    uavcan_node_flush(node);
+
+#if UAVCAN_WITH_STATS
+    uavcan_stats_update(&node->stats);
+#endif
+#if UAVCAN_WITH_NODE_TABLE
+    uavcan_node_table_update(&node->node_table);
+#endif
 
-    if (restart_pending)
+    if (node->restart_pending)
     {
         uavcan_restart();
     }
 }
 
-int16_t uavcan_broadcast_status()
+int16_t uavcan_node_broadcast_status(uavcan_node_t *node)
 {
-    static uint8_t transfer_id = 0;
     uint8_t buff[UAVCAN_PROTOCOL_NODESTATUS_MAX_SIZE];
 
-    uavcan_node_status.uptime_sec = uavcan_uptime_sec();
+    node->status.uptime_sec = uavcan_uptime_sec();
+
+    uavcan_protocol_NodeStatus status = node->status;
+    // dropped transfers since the last status => at least WARNING
+    if (node->pool_alloc_failures != node->pool_alloc_failures_reported &&
+        status.health < UAVCAN_PROTOCOL_NODESTATUS_HEALTH_WARNING)
+    {
+        status.health = UAVCAN_PROTOCOL_NODESTATUS_HEALTH_WARNING;
+    }
+
+    uint32_t len = uavcan_protocol_NodeStatus_encode(&status, buff);
+
+    int16_t res = queued(node, canardBroadcast(&node->canard,
+                                               UAVCAN_PROTOCOL_NODESTATUS_SIGNATURE,
+                                               UAVCAN_PROTOCOL_NODESTATUS_ID,
+                                               &node->status_transfer_id,
+                                               CANARD_TRANSFER_PRIORITY_LOW,
+                                               buff,
+                                               len));
+    if (res > 0)
+    {
+        node->pool_alloc_failures_reported = node->pool_alloc_failures;
+    }
+    return res;
+}
+
+void uavcan_node_get_pool_stats(uavcan_node_t *node, uavcan_pool_stats_t *out)
+{
+    CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&node->canard);
+
+    out->capacity = stats.capacity_blocks;
+    out->usage = stats.current_usage_blocks;
+    out->peak = stats.peak_usage_blocks;
+    out->alloc_failures = node->pool_alloc_failures;
+}
 
-    uint32_t len = uavcan_protocol_NodeStatus_encode(&uavcan_node_status, buff);
+uint8_t uavcan_node_pool_peak_pct(uavcan_node_t *node)
+{
+    CanardPoolAllocatorStatistics stats = canardGetPoolAllocatorStatistics(&node->canard);
 
-    return canardBroadcast(&g_canard,
-                           UAVCAN_PROTOCOL_NODESTATUS_SIGNATURE,
-                           UAVCAN_PROTOCOL_NODESTATUS_ID,
-                           &transfer_id,
-                           CANARD_TRANSFER_PRIORITY_LOW,
-                           buff,
-                           len);
+    if (stats.capacity_blocks == 0)
+    {
+        return 0;
+    }
+    return stats.peak_usage_blocks * 100UL / stats.capacity_blocks;
 }
 
 /**
@@ -153,12 +478,30 @@ bool uavcan_should_accept_transfer(const CanardInstance *ins,
         case UAVCAN_PROTOCOL_RESTARTNODE_ID:
             *out_data_type_signature = UAVCAN_PROTOCOL_RESTARTNODE_SIGNATURE;
             return true;
+#if UAVCAN_WITH_PARAM_GETSET
         case UAVCAN_PROTOCOL_PARAM_GETSET_ID:
             *out_data_type_signature = UAVCAN_PROTOCOL_PARAM_GETSET_SIGNATURE;
             return true;
+        case UAVCAN_PROTOCOL_PARAM_EXECUTEOPCODE_ID:
+            *out_data_type_signature = UAVCAN_PROTOCOL_PARAM_EXECUTEOPCODE_SIGNATURE;
+            return true;
+#endif
+#if UAVCAN_WITH_STATS
+        case UAVCAN_PROTOCOL_GETTRANSPORTSTATS_ID:
+            *out_data_type_signature = UAVCAN_PROTOCOL_GETTRANSPORTSTATS_SIGNATURE;
+            return true;
+#endif
         }
         break;
     case CanardTransferTypeResponse:
+        switch (data_type_id)
+        {
+#if UAVCAN_WITH_NODE_INFO_REQUESTS
+        case UAVCAN_PROTOCOL_GETNODEINFO_ID:
+            *out_data_type_signature = UAVCAN_PROTOCOL_GETNODEINFO_SIGNATURE;
+            return true;
+#endif
+        }
         break;
     }
     return uavcan_user_should_accept_transfer(ins,
@@ -168,7 +511,8 @@ bool uavcan_should_accept_transfer(const CanardInstance *ins,
                                               source_node_id);
 }
 
-int16_t uavcan_broadcast(
+int16_t uavcan_node_broadcast(
+    uavcan_node_t *node,
     uint64_t data_type_signature,
     uint16_t data_type_id,
     uint8_t *inout_transfer_id,
@@ -176,38 +520,40 @@ int16_t uavcan_broadcast(
     const void *payload,
     uint16_t payload_len)
 {
-    int16_t res = canardBroadcast(&g_canard,
-                                  data_type_signature,
-                                  data_type_id,
-                                  inout_transfer_id,
-                                  priority,
-                                  payload,
-                                  payload_len);
+    int16_t res = queued(node, canardBroadcast(&node->canard,
+                                               data_type_signature,
+                                               data_type_id,
+                                               inout_transfer_id,
+                                               priority,
+                                               payload,
+                                               payload_len));
     return (res < 0) ? res : 0;
 }
 
-int16_t uavcan_send_response(
+int16_t uavcan_node_send_response(
+    uavcan_node_t *node,
     CanardRxTransfer *transfer,
     uint64_t data_type_signature,
     uint16_t data_type_id,
     const void *payload,
     uint16_t payload_len)
 {
-    // TODO: we do not have transport available here :(
-    // canardReleaseRxTransferPayload(&g_canard, transfer);
-    int16_t res = canardRequestOrRespond(&g_canard,
-                                         transfer->source_node_id,
-                                         data_type_signature,
-                                         data_type_id,
-                                         &transfer->transfer_id,
-                                         transfer->priority,
-                                         CanardResponse,
-                                         payload,
-                                         payload_len);
+    // free RX blocks for the response
+    canardReleaseRxTransferPayload(&node->canard, transfer);
+    int16_t res = queued(node, canardRequestOrRespond(&node->canard,
+                                                      transfer->source_node_id,
+                                                      data_type_signature,
+                                                      data_type_id,
+                                                      &transfer->transfer_id,
+                                                      transfer->priority,
+                                                      CanardResponse,
+                                                      payload,
+                                                      payload_len));
     return (res < 0) ? res : 0;
 }
 
-int16_t uavcan_send_request(
+int16_t uavcan_node_send_request(
+    uavcan_node_t *node,
     uint8_t destination_node_id,
     uint64_t data_type_signature,
     uint16_t data_type_id,
@@ -216,15 +562,15 @@ int16_t uavcan_send_request(
     const void *payload,
     uint16_t payload_len)
 {
-    int16_t res = canardRequestOrRespond(&g_canard,
-                                         destination_node_id,
-                                         data_type_signature,
-                                         data_type_id,
-                                         inout_transfer_id,
-                                         priority,
-                                         CanardRequest,
-                                         payload,
-                                         payload_len);
+    int16_t res = queued(node, canardRequestOrRespond(&node->canard,
+                                                      destination_node_id,
+                                                      data_type_signature,
+                                                      data_type_id,
+                                                      inout_transfer_id,
+                                                      priority,
+                                                      CanardRequest,
+                                                      payload,
+                                                      payload_len));
     return (res < 0) ? res : 0;
 }
 
@@ -248,6 +594,10 @@ __attribute__((weak)) bool uavcan_user_should_accept_transfer(const CanardInstan
  */
 void uavcan_on_transfer_received(CanardInstance *ins, CanardRxTransfer *transfer)
 {
+#if UAVCAN_WITH_STATS
+    uavcan_stats_rx_transfer(&uavcan_node_of(ins)->stats);
+#endif
+
     switch (transfer->transfer_type)
     {
     case CanardTransferTypeBroadcast:
@@ -271,6 +621,24 @@ void uavcan_on_transfer_received(CanardInstance *ins, CanardRxTransfer *transfer
         case UAVCAN_PROTOCOL_PARAM_GETSET_ID:
             handle_param_GetSet(ins, transfer);
             return;
+        case UAVCAN_PROTOCOL_PARAM_EXECUTEOPCODE_ID:
+            handle_param_ExecuteOpcode(ins, transfer);
+            return;
+#endif
+#if UAVCAN_WITH_STATS
+        case UAVCAN_PROTOCOL_GETTRANSPORTSTATS_ID:
+            handle_GetTransportStats(ins, transfer);
+            return;
+#endif
+        }
+        break;
+    case CanardTransferTypeResponse:
+        switch (transfer->data_type_id)
+        {
+#if UAVCAN_WITH_NODE_INFO_REQUESTS
+        case UAVCAN_PROTOCOL_GETNODEINFO_ID:
+            handle_GetNodeInfo_resp(ins, transfer);
+            return;
 #endif
         }
         break;
@@ -295,32 +663,41 @@ static void handle_NodeStatus(CanardInstance *ins, CanardRxTransfer *transfer)
                                                     NULL);
     if (res < 0)
     {
+        uavcan_stats_decode_error(ins);
         uavcan_error("uavcan.protocol.NodeStatus decode failed");
         return;
     }
+#if UAVCAN_WITH_NODE_TABLE
+    uavcan_node_table_status(&uavcan_node_of(ins)->node_table,
+                             transfer->source_node_id,
+                             &msg,
+                             transfer->timestamp_usec);
+#endif
     uavcan_on_node_status(transfer->source_node_id, &msg);
 }
 
 static void handle_GetNodeInfo(CanardInstance *ins, CanardRxTransfer *transfer)
 {
+    uavcan_node_t *node = uavcan_node_of(ins);
     uint8_t buff[UAVCAN_PROTOCOL_GETNODEINFO_RESPONSE_MAX_SIZE];
 
-    uint32_t len = uavcan_protocol_GetNodeInfoResponse_encode(&uavcan_node_info, buff);
+    uint32_t len = uavcan_protocol_GetNodeInfoResponse_encode(&node->info, buff);
 
     canardReleaseRxTransferPayload(ins, transfer);
-    canardRequestOrRespond(ins,
-                           transfer->source_node_id,
-                           UAVCAN_PROTOCOL_GETNODEINFO_SIGNATURE,
-                           UAVCAN_PROTOCOL_GETNODEINFO_ID,
-                           &transfer->transfer_id,
-                           transfer->priority,
-                           CanardResponse,
-                           buff,
-                           len);
+    queued(node, canardRequestOrRespond(ins,
+                                        transfer->source_node_id,
+                                        UAVCAN_PROTOCOL_GETNODEINFO_SIGNATURE,
+                                        UAVCAN_PROTOCOL_GETNODEINFO_ID,
+                                        &transfer->transfer_id,
+                                        transfer->priority,
+                                        CanardResponse,
+                                        buff,
+                                        len));
 }
 
 static void handle_RestartNode(CanardInstance *ins, CanardRxTransfer *transfer)
 {
+    uavcan_node_t *node = uavcan_node_of(ins);
     uavcan_protocol_RestartNodeResponse resp;
     uint8_t buff[UAVCAN_PROTOCOL_RESTARTNODE_RESPONSE_MAX_SIZE];
 
@@ -329,21 +706,22 @@ static void handle_RestartNode(CanardInstance *ins, CanardRxTransfer *transfer)
     uint32_t len = uavcan_protocol_RestartNodeResponse_encode(&resp, buff);
 
     canardReleaseRxTransferPayload(ins, transfer);
-    canardRequestOrRespond(ins,
-                           transfer->source_node_id,
-                           UAVCAN_PROTOCOL_RESTARTNODE_SIGNATURE,
-                           UAVCAN_PROTOCOL_RESTARTNODE_ID,
-                           &transfer->transfer_id,
-                           transfer->priority,
-                           CanardResponse,
-                           buff,
-                           len);
-    restart_pending = true;
+    queued(node, canardRequestOrRespond(ins,
+                                        transfer->source_node_id,
+                                        UAVCAN_PROTOCOL_RESTARTNODE_SIGNATURE,
+                                        UAVCAN_PROTOCOL_RESTARTNODE_ID,
+                                        &transfer->transfer_id,
+                                        transfer->priority,
+                                        CanardResponse,
+                                        buff,
+                                        len));
+    node->restart_pending = true;
 }
 
 #if UAVCAN_WITH_PARAM_GETSET
 static void handle_param_GetSet(CanardInstance *ins, CanardRxTransfer *transfer)
 {
+    uavcan_node_t *node = uavcan_node_of(ins);
     uavcan_protocol_param_GetSetRequest req;
 #define GETSETREQ_NAME_MAX_SIZE 96 // max size needed for the dynamic arrays
     // Reserve some memory for the dynamic arrays from the stack
@@ -360,88 +738,158 @@ static void handle_param_GetSet(CanardInstance *ins, CanardRxTransfer *transfer)
 
     if (res < 0)
     {
+        uavcan_stats_decode_error(ins);
         uavcan_error("uavcan.protocol.param.GetSet decode failed");
         return;
     }
 
-    if (req.value.union_tag == UAVCAN_PROTOCOL_PARAM_VALUE_EMPTY)
+    // name takes precedence over index
+    int16_t index = req.index;
+    if (req.name.len > 0)
     {
-        if (req.index == 0)
-        {
-            resp.min_value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE;
-            resp.min_value.integer_value = 1;
-            resp.default_value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE;
-            resp.default_value.integer_value = 2;
-            resp.max_value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE;
-            resp.max_value.integer_value = 3;
-            resp.value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE;
-            resp.value.integer_value = 2;
-            resp.name.data = (uint8_t *)"first";
-            resp.name.len = 5;
-        }
-        else if (req.index == 1)
-        {
-            resp.min_value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE;
-            resp.min_value.integer_value = 4;
-            resp.default_value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE;
-            resp.default_value.integer_value = 5;
-            resp.max_value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE;
-            resp.max_value.integer_value = 6;
-            resp.value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE;
-            resp.value.integer_value = 5;
-            resp.name.data = (uint8_t *)"second";
-            resp.name.len = 6;
-        }
-        else
-        {
-            resp.min_value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_EMPTY;
-            resp.default_value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_EMPTY;
-            resp.max_value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_EMPTY;
-            resp.value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_EMPTY;
-            resp.name.data = NULL;
-            resp.name.len = 0;
-        }
+        index = uavcan_param_find(req.name.data, req.name.len);
     }
-    else
+
+    if (index >= 0 && req.value.union_tag != UAVCAN_PROTOCOL_PARAM_VALUE_EMPTY)
     {
-        if (req.value.union_tag != UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE)
+        if (!uavcan_param_set(index, &req.value))
         {
-            // TODO: error response?
-            return;
+            uavcan_error("param %d set failed", index);
         }
-        uavcan_error("%d := %d", req.index, req.value.integer_value);
-        resp.min_value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE;
-        resp.min_value.integer_value = 1;
-        resp.default_value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE;
-        resp.default_value.integer_value = 2;
-        resp.max_value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE;
-        resp.max_value.integer_value = 3;
-        resp.value.union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE;
-        resp.value.integer_value = req.value.integer_value;
-        resp.name.data = (uint8_t *)"first";
-        resp.name.len = 5;
+    }
+
+    // all values empty, i.e. "no such parameter"
+    memset(&resp, 0, sizeof(resp));
+    if (index >= 0)
+    {
+        uavcan_param_get(index, &resp);
     }
 
     uint32_t len = uavcan_protocol_param_GetSetResponse_encode(&resp, resp_buff);
 
     canardReleaseRxTransferPayload(ins, transfer);
-    canardRequestOrRespond(ins,
-                           transfer->source_node_id,
-                           UAVCAN_PROTOCOL_PARAM_GETSET_SIGNATURE,
-                           UAVCAN_PROTOCOL_PARAM_GETSET_ID,
-                           &transfer->transfer_id,
-                           transfer->priority,
-                           CanardResponse,
-                           resp_buff,
-                           len);
+    queued(node, canardRequestOrRespond(ins,
+                                        transfer->source_node_id,
+                                        UAVCAN_PROTOCOL_PARAM_GETSET_SIGNATURE,
+                                        UAVCAN_PROTOCOL_PARAM_GETSET_ID,
+                                        &transfer->transfer_id,
+                                        transfer->priority,
+                                        CanardResponse,
+                                        resp_buff,
+                                        len));
+}
+
+static void handle_param_ExecuteOpcode(CanardInstance *ins, CanardRxTransfer *transfer)
+{
+    uavcan_node_t *node = uavcan_node_of(ins);
+    uavcan_protocol_param_ExecuteOpcodeRequest req;
+    uavcan_protocol_param_ExecuteOpcodeResponse resp;
+    uint8_t resp_buff[UAVCAN_PROTOCOL_PARAM_EXECUTEOPCODE_RESPONSE_MAX_SIZE];
+
+    int32_t res = uavcan_protocol_param_ExecuteOpcodeRequest_decode(transfer,
+                                                                    transfer->payload_len,
+                                                                    &req,
+                                                                    NULL);
+    if (res < 0)
+    {
+        uavcan_stats_decode_error(ins);
+        uavcan_error("uavcan.protocol.param.ExecuteOpcode decode failed");
+        return;
+    }
+
+    memset(&resp, 0, sizeof(resp));
+    resp.ok = uavcan_param_execute(req.opcode);
+
+    uint32_t len = uavcan_protocol_param_ExecuteOpcodeResponse_encode(&resp, resp_buff);
+
+    canardReleaseRxTransferPayload(ins, transfer);
+    queued(node, canardRequestOrRespond(ins,
+                                        transfer->source_node_id,
+                                        UAVCAN_PROTOCOL_PARAM_EXECUTEOPCODE_SIGNATURE,
+                                        UAVCAN_PROTOCOL_PARAM_EXECUTEOPCODE_ID,
+                                        &transfer->transfer_id,
+                                        transfer->priority,
+                                        CanardResponse,
+                                        resp_buff,
+                                        len));
 }
 #endif
 
-int uavcan_log(uint8_t level, const char *text)
+#if UAVCAN_WITH_STATS
+static void handle_GetTransportStats(CanardInstance *ins, CanardRxTransfer *transfer)
+{
+    uavcan_node_t *node = uavcan_node_of(ins);
+    const uavcan_stats_t *stats = uavcan_node_get_stats(node);
+    uavcan_protocol_GetTransportStatsResponse resp;
+    uavcan_protocol_CANIfaceStats ifaces[UAVCAN_CAN_IFACES];
+    uint8_t buff[UAVCAN_PROTOCOL_GETTRANSPORTSTATS_RESPONSE_MAX_SIZE];
+
+    resp.transfers_tx = stats->transfers_tx;
+    resp.transfers_rx = stats->transfers_rx;
+    resp.transfer_errors = stats->rx_errors + stats->rx_crc_errors + stats->rx_dropped + stats->tx_dropped;
+    for (uint8_t i = 0; i < node->ifaces_len; i++)
+    {
+        ifaces[i].frames_tx = node->iface_state[i].frames_tx;
+        ifaces[i].frames_rx = node->iface_state[i].frames_rx;
+        ifaces[i].errors = node->iface_state[i].errors;
+    }
+    resp.can_iface_stats.len = node->ifaces_len;
+    resp.can_iface_stats.data = ifaces;
+
+    uint32_t len = uavcan_protocol_GetTransportStatsResponse_encode(&resp, buff);
+
+    canardReleaseRxTransferPayload(ins, transfer);
+    queued(node, canardRequestOrRespond(ins,
+                                        transfer->source_node_id,
+                                        UAVCAN_PROTOCOL_GETTRANSPORTSTATS_SIGNATURE,
+                                        UAVCAN_PROTOCOL_GETTRANSPORTSTATS_ID,
+                                        &transfer->transfer_id,
+                                        transfer->priority,
+                                        CanardResponse,
+                                        buff,
+                                        len));
+}
+#endif
+
+#if UAVCAN_WITH_NODE_INFO_REQUESTS
+static void handle_GetNodeInfo_resp(CanardInstance *ins, CanardRxTransfer *transfer)
+{
+    uavcan_protocol_GetNodeInfoResponse info;
+    uint8_t dyn_buf[UAVCAN_PROTOCOL_HARDWAREVERSION_CERTIFICATE_OF_AUTHENTICITY_MAX_LENGTH +
+                    UAVCAN_PROTOCOL_GETNODEINFO_RESPONSE_NAME_MAX_LENGTH];
+    uint8_t *dyn_ptr = dyn_buf;
+
+    int32_t res = uavcan_protocol_GetNodeInfoResponse_decode(transfer,
+                                                             transfer->payload_len,
+                                                             &info,
+                                                             &dyn_ptr);
+    if (res < 0)
+    {
+        uavcan_stats_decode_error(ins);
+        uavcan_error("uavcan.protocol.GetNodeInfo decode failed");
+        return;
+    }
+    uavcan_on_node_info(transfer->source_node_id, &info);
+}
+
+int16_t uavcan_node_send_get_node_info(uavcan_node_t *node, uint8_t destination_node_id)
+{
+    // empty request
+    return uavcan_node_send_request(node,
+                                    destination_node_id,
+                                    UAVCAN_PROTOCOL_GETNODEINFO_SIGNATURE,
+                                    UAVCAN_PROTOCOL_GETNODEINFO_ID,
+                                    &node->node_info_transfer_id,
+                                    CANARD_TRANSFER_PRIORITY_LOW,
+                                    NULL,
+                                    0);
+}
+#endif
+
+int uavcan_node_log(uavcan_node_t *node, uint8_t level, const char *text)
 {
     uint8_t buff[UAVCAN_PROTOCOL_DEBUG_LOGMESSAGE_MAX_SIZE];
     uavcan_protocol_debug_LogMessage msg;
-    static uint8_t transfer_id = 0;
 
     msg.level.value = level;
     msg.source.len = 0;
@@ -451,16 +899,158 @@ int uavcan_log(uint8_t level, const char *text)
 
     uint32_t len = uavcan_protocol_debug_LogMessage_encode(&msg, buff);
 
-    return canardBroadcast(&g_canard,
-                           UAVCAN_PROTOCOL_DEBUG_LOGMESSAGE_SIGNATURE,
-                           UAVCAN_PROTOCOL_DEBUG_LOGMESSAGE_ID,
-                           &transfer_id,
-                           CANARD_TRANSFER_PRIORITY_LOW,
-                           buff,
-                           len);
+    return queued(node, canardBroadcast(&node->canard,
+                                        UAVCAN_PROTOCOL_DEBUG_LOGMESSAGE_SIGNATURE,
+                                        UAVCAN_PROTOCOL_DEBUG_LOGMESSAGE_ID,
+                                        &node->log_transfer_id,
+                                        CANARD_TRANSFER_PRIORITY_LOW,
+                                        buff,
+                                        len));
+}
+
+void uavcan_node_release_rx_transfer_payload(uavcan_node_t *node, CanardRxTransfer *transfer)
+{
+    canardReleaseRxTransferPayload(&node->canard, transfer);
+}
+
+// single node API
+
+// interface number is passed as `ctx`
+static int default_can_tx(void *ctx, const CanardCANFrame *frame)
+{
+#if UAVCAN_CAN_IFACES > 1
+    if ((uintptr_t)ctx > 0)
+    {
+        return uavcan_can_iface_tx((uintptr_t)ctx, frame);
+    }
+#endif
+    return uavcan_can_tx(frame);
+}
+
+static int default_can_rx(void *ctx, CanardCANFrame *frame, uint64_t *timestamp_usec)
+{
+#if UAVCAN_CAN_IFACES > 1
+    if ((uintptr_t)ctx > 0)
+    {
+        return uavcan_can_iface_rx((uintptr_t)ctx, frame, timestamp_usec);
+    }
+#endif
+    return uavcan_can_rx(frame, timestamp_usec);
+}
+
+void uavcan_init()
+{
+    uavcan_can_iface_t ifaces[UAVCAN_CAN_IFACES];
+
+    for (uint8_t i = 0; i < UAVCAN_CAN_IFACES; i++)
+    {
+        ifaces[i].tx = default_can_tx;
+        ifaces[i].rx = default_can_rx;
+        ifaces[i].ctx = (void *)(uintptr_t)i;
+    }
+
+    uavcan_node_init(&uavcan_default_node,
+                     UAVCAN_NODE_ID,
+                     g_canard_memory_pool,
+                     sizeof(g_canard_memory_pool),
+                     ifaces,
+                     UAVCAN_CAN_IFACES);
+}
+
+void uavcan_update()
+{
+    uavcan_node_update(&uavcan_default_node);
+}
+
+uint16_t uavcan_flush()
+{
+    return uavcan_node_flush(&uavcan_default_node);
+}
+
+uint16_t uavcan_tx_backlog()
+{
+    return uavcan_node_tx_backlog(&uavcan_default_node);
+}
+
+int16_t uavcan_broadcast_status()
+{
+    return uavcan_node_broadcast_status(&uavcan_default_node);
+}
+
+int uavcan_log(uint8_t level, const char *text)
+{
+    return uavcan_node_log(&uavcan_default_node, level, text);
+}
+
+int16_t uavcan_broadcast(
+    uint64_t data_type_signature,
+    uint16_t data_type_id,
+    uint8_t *inout_transfer_id,
+    uint8_t priority,
+    const void *payload,
+    uint16_t payload_len)
+{
+    return uavcan_node_broadcast(&uavcan_default_node,
+                                 data_type_signature,
+                                 data_type_id,
+                                 inout_transfer_id,
+                                 priority,
+                                 payload,
+                                 payload_len);
+}
+
+int16_t uavcan_send_response(
+    CanardRxTransfer *transfer,
+    uint64_t data_type_signature,
+    uint16_t data_type_id,
+    const void *payload,
+    uint16_t payload_len)
+{
+    return uavcan_node_send_response(&uavcan_default_node,
+                                     transfer,
+                                     data_type_signature,
+                                     data_type_id,
+                                     payload,
+                                     payload_len);
+}
+
+int16_t uavcan_send_request(
+    uint8_t destination_node_id,
+    uint64_t data_type_signature,
+    uint16_t data_type_id,
+    uint8_t *inout_transfer_id,
+    uint8_t priority,
+    const void *payload,
+    uint16_t payload_len)
+{
+    return uavcan_node_send_request(&uavcan_default_node,
+                                    destination_node_id,
+                                    data_type_signature,
+                                    data_type_id,
+                                    inout_transfer_id,
+                                    priority,
+                                    payload,
+                                    payload_len);
+}
+
+#if UAVCAN_WITH_NODE_INFO_REQUESTS
+int16_t uavcan_send_get_node_info(uint8_t destination_node_id)
+{
+    return uavcan_node_send_get_node_info(&uavcan_default_node, destination_node_id);
 }
+#endif
 
 void uavcan_release_rx_transfer_payload(CanardRxTransfer *transfer)
 {
-    canardReleaseRxTransferPayload(&g_canard, transfer);
+    uavcan_node_release_rx_transfer_payload(&uavcan_default_node, transfer);
+}
+
+void uavcan_get_pool_stats(uavcan_pool_stats_t *out)
+{
+    uavcan_node_get_pool_stats(&uavcan_default_node, out);
+}
+
+uint8_t uavcan_pool_peak_pct()
+{
+    return uavcan_node_pool_peak_pct(&uavcan_default_node);
 }
@@ -1,6 +1,14 @@
+#ifndef UAVCAN_NODE_H
+#define UAVCAN_NODE_H
+
 #include "canard.h"
 #include "uavcan/protocol/NodeStatus.h"
 #include "uavcan/protocol/GetNodeInfo.h"
+#include "uavcan/protocol/param/GetSet.h"
+#include "uavcan/protocol/param/ExecuteOpcode.h"
+#include "uavcan_stats.h"
+#include "uavcan_node_table.h"
+#include "uavcan_filters.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -8,11 +16,145 @@ extern "C"
 #endif
 
 
+#ifndef UAVCAN_CAN_IFACES
+// Max. number of redundant CAN interfaces of a node. Must be the same for all
+// sources (it changes uavcan_node_t).
+#define UAVCAN_CAN_IFACES 1
+#endif
+
+#ifndef UAVCAN_TX_TRACKED_FRAMES
+// Queued frames whose TX state is kept, i.e. frames sent to some interfaces
+// only when a higher priority frame took over the head of the queue.
+#if UAVCAN_CAN_IFACES > 1
+#define UAVCAN_TX_TRACKED_FRAMES 4
+#else
+#define UAVCAN_TX_TRACKED_FRAMES 1
+#endif
+#endif
+
+#ifndef UAVCAN_RX_DEDUP_FRAMES
+// Redundant interfaces: frames received lately, kept to drop their copies
+// from the other interfaces
+#define UAVCAN_RX_DEDUP_FRAMES 16
+#endif
+
+// CAN interface of a node, tx() and rx() work as uavcan_can_tx() and
+// uavcan_can_rx() (see HAL callbacks), `ctx` is passed to them.
+typedef struct
+{
+    int (*tx)(void *ctx, const CanardCANFrame *frame);
+    int (*rx)(void *ctx, CanardCANFrame *frame, uint64_t *timestamp_usec);
+    void *ctx;
+} uavcan_can_iface_t;
+
+typedef struct
+{
+    uint32_t frames_tx;
+    uint32_t frames_rx;
+    // frames refused by CAN driver for an error (not for lack of TX buffers)
+    uint32_t errors;
+    // TX is suspended after an error (bus off, ...) until tx_retry_at, the
+    // interface is down until a frame is sent again
+    uint32_t tx_backoff;
+    uint64_t tx_retry_at;
+    // no free TX buffer since tx_busy_since, an error after
+    // UAVCAN_TX_BUSY_TIMEOUT
+    bool tx_busy;
+    uint64_t tx_busy_since;
+} uavcan_iface_state_t;
+
+#if UAVCAN_CAN_IFACES > 1
+// a frame received lately
+typedef struct
+{
+    CanardCANFrame frame;
+    uint32_t time; // [ms]
+    // interfaces it came from, 0 - free entry
+    uint8_t ifaces;
+} uavcan_rx_frame_t;
+#endif
+
+// TX state of a queued frame
+typedef struct
+{
+    const CanardCANFrame *frame; // NULL - free entry
+    // interfaces it wasn't sent to yet
+    uint8_t pending;
+    // any interface sent it already
+    bool sent;
+} uavcan_tx_frame_t;
+
+// libcanard memory pool usage, in blocks of CANARD_MEM_BLOCK_SIZE bytes
+typedef struct
+{
+    uint16_t capacity;
+    uint16_t usage;
+    uint16_t peak;
+    // RX frames and TX transfers dropped for lack of memory
+    uint32_t alloc_failures;
+} uavcan_pool_stats_t;
+
+// Node instance, all the library state lives here. Fields are private except
+// `status`, `info` and `user_reference`, `iface_state` may be read.
+typedef struct uavcan_node
+{
+    CanardInstance canard;
+    uavcan_can_iface_t ifaces[UAVCAN_CAN_IFACES];
+    uavcan_iface_state_t iface_state[UAVCAN_CAN_IFACES];
+    uint8_t ifaces_len;
+    // for the application, e.g. to find its data in transfer callbacks
+    void *user_reference;
+
+    volatile uavcan_protocol_NodeStatus status;
+    uavcan_protocol_GetNodeInfoResponse info;
+    bool restart_pending;
+
+    // RX frames and TX transfers dropped for lack of memory
+    uint32_t pool_alloc_failures;
+    // value of the above when NodeStatus was sent last time
+    uint32_t pool_alloc_failures_reported;
+
+    // frames in libcanard TX queue
+    uint16_t tx_backlog;
+    // the first frame of the queue and frames it preempted
+    uavcan_tx_frame_t tx_frames[UAVCAN_TX_TRACKED_FRAMES];
+    // entry reused when all of them are taken
+    uint8_t tx_frames_evict;
+
+#if UAVCAN_CAN_IFACES > 1
+    // Each frame is taken from the interface it comes from first, its copies
+    // from the other ones within UAVCAN_RX_DEDUP_WINDOW are dropped.
+    uavcan_rx_frame_t rx_frames[UAVCAN_RX_DEDUP_FRAMES];
+    // entry the next frame is stored to
+    uint8_t rx_frames_next;
+    uint32_t rx_duplicates;
+#endif
+
+    uint64_t last_cleanup;
+    uint8_t status_transfer_id;
+    uint8_t log_transfer_id;
+    uint8_t node_info_transfer_id;
+#if UAVCAN_WITH_STATS
+    uavcan_stats_ctx_t stats;
+#endif
+#if UAVCAN_WITH_NODE_TABLE
+    uavcan_node_table_t node_table;
+#endif
+} uavcan_node_t;
+
+
 // API
+// Single node API, the node uses UAVCAN_NODE_ID, UAVCAN_MEM_POOL_SIZE bytes
+// of static memory and the HAL callbacks below (UAVCAN_CAN_IFACES interfaces).
 void uavcan_init(void);
 void uavcan_update(void);
-void uavcan_flush(void);
+// Pass queued frames to CAN driver until it refuses one, never waits. Returns
+// the number of frames left in the queue (backlog).
+uint16_t uavcan_flush(void);
+uint16_t uavcan_tx_backlog(void);
 
+// NodeStatus health is raised to WARNING when transfers were dropped for lack
+// of memory since the last status
 int16_t uavcan_broadcast_status(void);
 int uavcan_log(uint8_t level, const char *text);
 
@@ -24,6 +166,7 @@ int16_t uavcan_broadcast(
     const void *payload,
     uint16_t payload_len);
 
+// RX payload of `transfer` is released (it must be decoded already)
 int16_t uavcan_send_response(
     CanardRxTransfer *transfer,
     uint64_t data_type_signature,
@@ -41,13 +184,109 @@ int16_t uavcan_send_request(
     uint16_t payload_len);
 
 
+// Release RX payload of `transfer` as soon as it's decoded, so that the memory
+// pool can be used for TX.
+void uavcan_release_rx_transfer_payload(CanardRxTransfer *transfer);
+
+#if UAVCAN_WITH_NODE_INFO_REQUESTS
+// GetNodeInfo request, the response is passed to uavcan_on_node_info()
+int16_t uavcan_send_get_node_info(uint8_t destination_node_id);
+#endif
+
+void uavcan_get_pool_stats(uavcan_pool_stats_t *out);
+uint8_t uavcan_pool_peak_pct(void);
+
+
+// Instance API, same as above for any number of nodes. Nodes are independent,
+// but each one must be used by a single task only. Application callbacks are
+// shared, they can find the node by uavcan_node_of(ins).
+//
+// A node with more interfaces (max. UAVCAN_CAN_IFACES) sends each frame to
+// all of them, an interface which is down (see uavcan_iface_state_t) is
+// skipped. Received transfers are deduplicated. Of the firmware HALs, the host
+// (POSIX) and ESP32 ones have more interfaces.
+void uavcan_node_init(uavcan_node_t *node,
+                      uint8_t node_id,
+                      void *mem_pool,
+                      size_t mem_pool_size,
+                      const uavcan_can_iface_t *ifaces,
+                      uint8_t ifaces_len);
+void uavcan_node_update(uavcan_node_t *node);
+uint16_t uavcan_node_flush(uavcan_node_t *node);
+uint16_t uavcan_node_tx_backlog(const uavcan_node_t *node);
+int16_t uavcan_node_broadcast_status(uavcan_node_t *node);
+int uavcan_node_log(uavcan_node_t *node, uint8_t level, const char *text);
+
+int16_t uavcan_node_broadcast(
+    uavcan_node_t *node,
+    uint64_t data_type_signature,
+    uint16_t data_type_id,
+    uint8_t *inout_transfer_id,
+    uint8_t priority,
+    const void *payload,
+    uint16_t payload_len);
+
+int16_t uavcan_node_send_response(
+    uavcan_node_t *node,
+    CanardRxTransfer *transfer,
+    uint64_t data_type_signature,
+    uint16_t data_type_id,
+    const void *payload,
+    uint16_t payload_len);
+
+int16_t uavcan_node_send_request(
+    uavcan_node_t *node,
+    uint8_t destination_node_id,
+    uint64_t data_type_signature,
+    uint16_t data_type_id,
+    uint8_t *inout_transfer_id,
+    uint8_t priority,
+    const void *payload,
+    uint16_t payload_len);
+
+void uavcan_node_release_rx_transfer_payload(uavcan_node_t *node, CanardRxTransfer *transfer);
+#if UAVCAN_WITH_NODE_INFO_REQUESTS
+int16_t uavcan_node_send_get_node_info(uavcan_node_t *node, uint8_t destination_node_id);
+#endif
+void uavcan_node_get_pool_stats(uavcan_node_t *node, uavcan_pool_stats_t *out);
+uint8_t uavcan_node_pool_peak_pct(uavcan_node_t *node);
+bool uavcan_node_iface_up(const uavcan_node_t *node, uint8_t iface);
+
+// node of the libcanard instance passed to callbacks
+uavcan_node_t *uavcan_node_of(const CanardInstance *ins);
+
+
 // globals
-extern volatile uavcan_protocol_NodeStatus uavcan_node_status;
-extern uavcan_protocol_GetNodeInfoResponse uavcan_node_info;
+// the node used by the single node API
+extern uavcan_node_t uavcan_default_node;
+// status and info of the default node
+#define uavcan_node_status (uavcan_default_node.status)
+#define uavcan_node_info (uavcan_default_node.info)
 
 
 // messages handlers callbacks
 void uavcan_on_node_status(uint8_t source_node_id, uavcan_protocol_NodeStatus *node_status);
+// GetNodeInfo response (used only when UAVCAN_WITH_NODE_INFO_REQUESTS is
+// enabled), arrays are valid until the callback returns
+void uavcan_on_node_info(uint8_t source_node_id, uavcan_protocol_GetNodeInfoResponse *info);
+// remote node went online, offline or restarted (used only when
+// UAVCAN_WITH_NODE_TABLE is enabled, see uavcan_node_table.h), called before
+// uavcan_on_node_status() of the same NodeStatus
+void uavcan_on_remote_node_event(uint8_t node_id,
+                                 uavcan_remote_node_event_t event,
+                                 const uavcan_remote_node_t *remote);
+
+// parameters callbacks (used only when UAVCAN_WITH_PARAM_GETSET is enabled)
+// Fill in name and values of parameter `index`, return false if there's no such parameter.
+bool uavcan_param_get(uint16_t index, uavcan_protocol_param_GetSetResponse *resp);
+// Return false if there's no such parameter or the value is invalid.
+bool uavcan_param_set(uint16_t index, const uavcan_protocol_param_Value *value);
+// Index of parameter `name` (not NUL terminated) for requests by name, -1 if
+// there's no such parameter.
+int16_t uavcan_param_find(const uint8_t *name, uint8_t len);
+// ExecuteOpcode request, save parameters to or erase them from non-volatile
+// storage. Return false on failure.
+bool uavcan_param_execute(uint8_t opcode);
 
 // logging callbacks
 void uavcan_error(const char * fmt, ...);
@@ -57,8 +296,21 @@ void uavcan_debug(const char * fmt, ...);
 
 
 // HAL callbacks
+// uavcan_can_tx() must not block, it returns:
+#define UAVCAN_CAN_TX_OK 0
+#define UAVCAN_CAN_TX_BUSY 1 // no free TX buffer, the frame is retried later
+#define UAVCAN_CAN_TX_INVALID -1 // frame can't be sent at all, it's dropped
+// or any other negative value on error (bus off, ...), the frame is retried
+// after UAVCAN_TX_BACKOFF_MIN..MAX delay
 int uavcan_can_tx(const CanardCANFrame *frame);
-int uavcan_can_rx(CanardCANFrame *frame);
+// Returns 1 if a frame was received. `timestamp_usec` is set to current uptime,
+// HAL may change it to the time the frame was actually received.
+int uavcan_can_rx(CanardCANFrame *frame, uint64_t *timestamp_usec);
+#if UAVCAN_CAN_IFACES > 1
+// same for interface 1..UAVCAN_CAN_IFACES-1 (uavcan_can_tx/rx() is interface 0)
+int uavcan_can_iface_tx(uint8_t iface, const CanardCANFrame *frame);
+int uavcan_can_iface_rx(uint8_t iface, CanardCANFrame *frame, uint64_t *timestamp_usec);
+#endif
 void uavcan_get_unique_id(uint8_t out_uid[UAVCAN_PROTOCOL_HARDWAREVERSION_UNIQUE_ID_LENGTH]);
 uint32_t uavcan_uptime_sec(void);
 uint64_t uavcan_uptime_usec(void);
@@ -78,4 +330,5 @@ void uavcan_user_on_transfer_received(CanardInstance *ins,
 
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
+#endif // UAVCAN_NODE_H
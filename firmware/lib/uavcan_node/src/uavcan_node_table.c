@@ -0,0 +1,177 @@
+#include <string.h>
+
+#include "uavcan_node.h"
+#include "uavcan_node_table.h"
+
+#if UAVCAN_WITH_NODE_TABLE
+
+// how often to look for nodes which went offline [ms]
+#define CHECK_PERIOD 100
+
+const uavcan_remote_node_t *uavcan_node_get_remote_node(const uavcan_node_t *node, uint8_t node_id)
+{
+    const uavcan_node_table_t *table = &node->node_table;
+
+    for (uint8_t i = 0; i < UAVCAN_NODE_TABLE_SIZE; i++)
+    {
+        if (node_id != 0 && table->nodes[i].node_id == node_id)
+        {
+            return &table->nodes[i];
+        }
+    }
+    return NULL;
+}
+
+const uavcan_node_table_t *uavcan_node_get_node_table(const uavcan_node_t *node)
+{
+    return &node->node_table;
+}
+
+const uavcan_remote_node_t *uavcan_get_remote_node(uint8_t node_id)
+{
+    return uavcan_node_get_remote_node(&uavcan_default_node, node_id);
+}
+
+const uavcan_node_table_t *uavcan_get_node_table(void)
+{
+    return uavcan_node_get_node_table(&uavcan_default_node);
+}
+
+void uavcan_node_table_update(uavcan_node_table_t *table)
+{
+    uint64_t now = uavcan_uptime_usec();
+
+    if (now - table->last_check < CHECK_PERIOD * 1000ULL)
+    {
+        return;
+    }
+    table->last_check = now;
+
+    uint32_t now_ms = (uint32_t)(now / 1000U);
+    for (uint8_t i = 0; i < UAVCAN_NODE_TABLE_SIZE; i++)
+    {
+        uavcan_remote_node_t *remote = &table->nodes[i];
+        if (remote->online && now_ms - remote->last_seen > UAVCAN_NODE_TIMEOUT)
+        {
+            remote->online = false;
+            uavcan_on_remote_node_event(remote->node_id, UAVCAN_REMOTE_NODE_OFFLINE, remote);
+        }
+    }
+}
+
+// free entries are the best to reuse, then offline ones
+static uint8_t reuse_rank(const uavcan_remote_node_t *remote)
+{
+    return (remote->node_id == 0) ? 2 : !remote->online;
+}
+
+// returns NULL if the table is full of online (or pinned) nodes, online ones
+// are replaced too with `evict_online`
+static uavcan_remote_node_t *find_or_add(uavcan_node_table_t *table, uint8_t node_id, bool evict_online)
+{
+    uavcan_remote_node_t *reuse = NULL;
+
+    for (uint8_t i = 0; i < UAVCAN_NODE_TABLE_SIZE; i++)
+    {
+        uavcan_remote_node_t *remote = &table->nodes[i];
+        if (remote->node_id == node_id)
+        {
+            return remote;
+        }
+        if (!remote->pinned && (reuse == NULL || reuse_rank(remote) > reuse_rank(reuse)))
+        {
+            reuse = remote;
+        }
+    }
+    if (reuse == NULL || (reuse->online && !evict_online))
+    {
+        return NULL;
+    }
+    memset(reuse, 0, sizeof(*reuse));
+    reuse->node_id = node_id;
+    return reuse;
+}
+
+bool uavcan_node_table_pin(uavcan_node_table_t *table, uint8_t node_id, bool pinned, uint64_t now_usec)
+{
+    if (node_id == CANARD_BROADCAST_NODE_ID)
+    {
+        return false;
+    }
+    if (!pinned)
+    {
+        for (uint8_t i = 0; i < UAVCAN_NODE_TABLE_SIZE; i++)
+        {
+            if (table->nodes[i].node_id == node_id)
+            {
+                table->nodes[i].pinned = false;
+            }
+        }
+        return true;
+    }
+
+    uavcan_remote_node_t *remote = find_or_add(table, node_id, true);
+    if (remote == NULL)
+    {
+        return false;
+    }
+    // just added, the caller has heard from the node
+    if (remote->last_seen == 0 && !remote->online)
+    {
+        remote->online = true;
+        remote->last_seen = (uint32_t)(now_usec / 1000U);
+    }
+    remote->pinned = true;
+    return true;
+}
+
+bool uavcan_pin_remote_node(uint8_t node_id, bool pinned)
+{
+    return uavcan_node_table_pin(&uavcan_default_node.node_table, node_id, pinned, uavcan_uptime_usec());
+}
+
+void uavcan_node_table_status(uavcan_node_table_t *table,
+                              uint8_t node_id,
+                              const uavcan_protocol_NodeStatus *status,
+                              uint64_t timestamp_usec)
+{
+    if (node_id == CANARD_BROADCAST_NODE_ID)
+    {
+        return;
+    }
+
+    uavcan_remote_node_t *remote = find_or_add(table, node_id, false);
+    uint32_t now_ms = (uint32_t)(timestamp_usec / 1000U);
+
+    if (remote == NULL)
+    {
+        table->overflows++;
+        return;
+    }
+
+    bool was_online = remote->online;
+    bool restarted = remote->last_seen != 0 && status->uptime_sec < remote->uptime_sec;
+
+    remote->interval = (was_online) ? now_ms - remote->last_seen : 0;
+    remote->last_seen = now_ms;
+    remote->online = true;
+    remote->health = status->health;
+    remote->mode = status->mode;
+    remote->vendor_specific_status_code = status->vendor_specific_status_code;
+    remote->uptime_sec = status->uptime_sec;
+    if (restarted)
+    {
+        remote->restarts++;
+    }
+
+    if (!was_online)
+    {
+        uavcan_on_remote_node_event(node_id, UAVCAN_REMOTE_NODE_ONLINE, remote);
+    }
+    else if (restarted)
+    {
+        uavcan_on_remote_node_event(node_id, UAVCAN_REMOTE_NODE_RESTARTED, remote);
+    }
+}
+
+#endif // UAVCAN_WITH_NODE_TABLE
@@ -0,0 +1,99 @@
+#ifndef UAVCAN_NODE_TABLE_H
+#define UAVCAN_NODE_TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "canard.h"
+#include "uavcan/protocol/NodeStatus.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Liveness of other nodes, tracked from their NodeStatus broadcasts only when
+// UAVCAN_WITH_NODE_TABLE is enabled. The table is updated by the task calling
+// uavcan_update(), changes are reported by uavcan_on_remote_node_event().
+
+#ifndef UAVCAN_NODE_TABLE_SIZE
+// Max. number of tracked nodes. When the table is full, an offline node is
+// replaced by a new one. Pinned nodes are never replaced.
+#define UAVCAN_NODE_TABLE_SIZE 16
+#endif
+
+#ifndef UAVCAN_NODE_TIMEOUT
+// a node is offline when there's no NodeStatus from it for this time, UAVCAN
+// v0 recommends 3 s (NodeStatus OFFLINE_TIMEOUT_MS) [ms]
+#define UAVCAN_NODE_TIMEOUT 3000
+#endif
+
+typedef struct
+{
+    uint8_t node_id; // 0 - free entry
+    bool online;
+    // from the last NodeStatus
+    uint8_t health;
+    uint8_t mode;
+    uint16_t vendor_specific_status_code;
+    uint32_t uptime_sec;
+    uint32_t last_seen; // [ms]
+    // observed NodeStatus broadcast interval, 0 until two are received [ms]
+    uint32_t interval;
+    // uptime went backwards
+    uint16_t restarts;
+    // kept in the table, see uavcan_pin_remote_node()
+    bool pinned;
+} uavcan_remote_node_t;
+
+typedef enum
+{
+    // the first NodeStatus or the first one after the node was offline
+    UAVCAN_REMOTE_NODE_ONLINE,
+    // no NodeStatus for UAVCAN_NODE_TIMEOUT
+    UAVCAN_REMOTE_NODE_OFFLINE,
+    // uptime of an online node went backwards
+    UAVCAN_REMOTE_NODE_RESTARTED,
+} uavcan_remote_node_event_t;
+
+// per node state
+typedef struct
+{
+    uavcan_remote_node_t nodes[UAVCAN_NODE_TABLE_SIZE];
+    // NodeStatus messages of nodes which did not fit into the table
+    uint32_t overflows;
+    uint64_t last_check;
+} uavcan_node_table_t;
+
+#if UAVCAN_WITH_NODE_TABLE
+
+struct uavcan_node;
+
+// default node (see uavcan_init()), NULL if the node is not in the table
+const uavcan_remote_node_t *uavcan_get_remote_node(uint8_t node_id);
+const uavcan_node_table_t *uavcan_get_node_table(void);
+
+const uavcan_remote_node_t *uavcan_node_get_remote_node(const struct uavcan_node *node, uint8_t node_id);
+const uavcan_node_table_t *uavcan_node_get_node_table(const struct uavcan_node *node);
+
+// Keep `node_id` in the table whatever the other nodes do (e.g. the master of a
+// node with a small table), an online node is dropped for it if there's no
+// room. A node added this way is online from now, so it goes offline if no
+// NodeStatus follows (no ONLINE event is reported). `pinned` false releases the
+// node. Returns false if all the entries are pinned.
+bool uavcan_pin_remote_node(uint8_t node_id, bool pinned);
+
+// library internal hooks
+void uavcan_node_table_update(uavcan_node_table_t *table);
+void uavcan_node_table_status(uavcan_node_table_t *table,
+                              uint8_t node_id,
+                              const uavcan_protocol_NodeStatus *status,
+                              uint64_t timestamp_usec);
+bool uavcan_node_table_pin(uavcan_node_table_t *table, uint8_t node_id, bool pinned, uint64_t now_usec);
+
+#endif // UAVCAN_WITH_NODE_TABLE
+
+#ifdef __cplusplus
+}
+#endif
+#endif // UAVCAN_NODE_TABLE_H
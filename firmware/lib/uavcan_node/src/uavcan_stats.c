@@ -0,0 +1,194 @@
+#include <string.h>
+
+#include "uavcan_node.h"
+#include "uavcan_stats.h"
+
+#if UAVCAN_WITH_STATS
+
+const uavcan_stats_t *uavcan_node_get_stats(const uavcan_node_t *node)
+{
+    return &node->stats.stats;
+}
+
+void uavcan_node_stats_reset(uavcan_node_t *node)
+{
+    uavcan_stats_t *stats = &node->stats.stats;
+    uint16_t tx_queue_len = stats->tx_queue_len;
+
+    memset(stats, 0, sizeof(*stats));
+    // frames still in the queue will be popped
+    stats->tx_queue_len = tx_queue_len;
+    stats->tx_queue_peak = tx_queue_len;
+}
+
+const uavcan_stats_t *uavcan_get_stats(void)
+{
+    return uavcan_node_get_stats(&uavcan_default_node);
+}
+
+void uavcan_stats_reset(void)
+{
+    uavcan_node_stats_reset(&uavcan_default_node);
+}
+
+/*
+Extended frame length including worst case bit stuffing: 67 bits of overhead
+(incl. interframe space) + data, stuff bit can be inserted after each 4 bits of
+54 stuffed overhead bits + data. Load is overestimated a bit, which is fine for
+capacity planning.
+*/
+static uint32_t frame_bits(const CanardCANFrame *frame)
+{
+    uint32_t data_bits = frame->data_len * 8U;
+
+    return 67U + data_bits + (54U + data_bits - 1U) / 4U;
+}
+
+void uavcan_stats_update(uavcan_stats_ctx_t *ctx)
+{
+    uavcan_stats_t *stats = &ctx->stats;
+    uint64_t now = uavcan_uptime_usec();
+
+    if (now - ctx->load_period_start < UAVCAN_STATS_LOAD_PERIOD * 1000ULL)
+    {
+        return;
+    }
+
+    uint64_t capacity = (uint64_t)UAVCAN_BITRATE * UAVCAN_STATS_LOAD_PERIOD / 1000U;
+    uint64_t load = ctx->load_bits * 100ULL / capacity;
+
+    stats->bus_load = (load > 100) ? 100 : (uint8_t)load;
+    if (stats->bus_load > stats->bus_load_peak)
+    {
+        stats->bus_load_peak = stats->bus_load;
+    }
+    ctx->load_bits = 0;
+    ctx->load_period_start = now;
+}
+
+static void count(uavcan_traffic_t *traffic, const CanardCANFrame *frame)
+{
+    traffic->frames++;
+    traffic->bytes += frame->data_len;
+}
+
+// returns NULL if the table is full
+static uavcan_type_stats_t *find_type(uavcan_stats_t *stats, const CanardCANFrame *frame)
+{
+    bool service = (frame->id >> 7) & 1;
+    uint16_t data_type_id = service ? (frame->id >> 16) & 0xFF : (frame->id >> 8) & 0xFFFF;
+
+    for (uint8_t i = 0; i < stats->types_len; i++)
+    {
+        if (stats->types[i].data_type_id == data_type_id && stats->types[i].service == service)
+        {
+            return &stats->types[i];
+        }
+    }
+    if (stats->types_len >= UAVCAN_STATS_DATA_TYPES)
+    {
+        return NULL;
+    }
+
+    uavcan_type_stats_t *type = &stats->types[stats->types_len++];
+    type->data_type_id = data_type_id;
+    type->service = service;
+    return type;
+}
+
+void uavcan_stats_rx_frame(uavcan_stats_ctx_t *ctx, const CanardCANFrame *frame, int16_t res)
+{
+    uavcan_stats_t *stats = &ctx->stats;
+
+    ctx->load_bits += frame_bits(frame);
+    count(&stats->rx, frame);
+
+    switch (res)
+    {
+    case CANARD_OK:
+    // frames for other nodes or of types we are not interested in
+    case -CANARD_ERROR_RX_NOT_WANTED:
+    case -CANARD_ERROR_RX_WRONG_ADDRESS:
+        break;
+    case -CANARD_ERROR_RX_BAD_CRC:
+        stats->rx_crc_errors++;
+        break;
+    case -CANARD_ERROR_OUT_OF_MEMORY:
+        stats->rx_dropped++;
+        break;
+    default:
+        stats->rx_errors++;
+        break;
+    }
+
+    // not a UAVCAN frame
+    if (!(frame->id & CANARD_CAN_FRAME_EFF))
+    {
+        return;
+    }
+
+    uavcan_type_stats_t *type = find_type(stats, frame);
+    count(type ? &type->rx : &stats->other_types_rx, frame);
+    count(&stats->nodes_rx[frame->id & CANARD_MAX_NODE_ID], frame);
+}
+
+void uavcan_stats_rx_transfer(uavcan_stats_ctx_t *ctx)
+{
+    ctx->stats.transfers_rx++;
+}
+
+void uavcan_stats_tx_queued(uavcan_stats_ctx_t *ctx, int16_t res)
+{
+    uavcan_stats_t *stats = &ctx->stats;
+
+    if (res < 0)
+    {
+        stats->tx_dropped++;
+        return;
+    }
+    stats->transfers_tx++;
+    stats->tx_queue_len += res;
+    if (stats->tx_queue_len > stats->tx_queue_peak)
+    {
+        stats->tx_queue_peak = stats->tx_queue_len;
+    }
+}
+
+void uavcan_stats_tx_frame(uavcan_stats_ctx_t *ctx, const CanardCANFrame *frame, int res)
+{
+    uavcan_stats_t *stats = &ctx->stats;
+
+    if (res == UAVCAN_CAN_TX_BUSY)
+    {
+        return;
+    }
+    if (res != UAVCAN_CAN_TX_OK)
+    {
+        stats->tx_errors++;
+        if (res != UAVCAN_CAN_TX_INVALID)
+        {
+            return;
+        }
+    }
+    if (stats->tx_queue_len > 0)
+    {
+        stats->tx_queue_len--;
+    }
+    if (res != UAVCAN_CAN_TX_OK)
+    {
+        return;
+    }
+
+    ctx->load_bits += frame_bits(frame);
+    count(&stats->tx, frame);
+
+    uavcan_type_stats_t *type = find_type(stats, frame);
+    count(type ? &type->tx : &stats->other_types_tx, frame);
+}
+
+void uavcan_stats_decode_error(CanardInstance *ins)
+{
+    uavcan_node_of(ins)->stats.stats.decode_errors++;
+}
+
+#endif // UAVCAN_WITH_STATS
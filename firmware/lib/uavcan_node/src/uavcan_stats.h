@@ -0,0 +1,124 @@
+#ifndef UAVCAN_STATS_H
+#define UAVCAN_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "canard.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Bus traffic statistics, collected only when UAVCAN_WITH_STATS is enabled.
+// They are updated by the task calling uavcan_update() and uavcan_flush(),
+// other tasks may read them but can see a partially updated state.
+
+#ifndef UAVCAN_BITRATE
+// CAN bitrate used for bus load estimation [bit/s]
+#define UAVCAN_BITRATE 250000
+#endif
+
+#ifndef UAVCAN_STATS_DATA_TYPES
+// number of data types counted separately, the rest is counted in `other_types`
+#define UAVCAN_STATS_DATA_TYPES 16
+#endif
+
+#ifndef UAVCAN_STATS_LOAD_PERIOD
+// bus load is computed over this period [ms]
+#define UAVCAN_STATS_LOAD_PERIOD 1000
+#endif
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t bytes; // payload bytes including tail bytes
+} uavcan_traffic_t;
+
+typedef struct
+{
+    uint16_t data_type_id;
+    bool service;
+    uavcan_traffic_t rx;
+    uavcan_traffic_t tx;
+} uavcan_type_stats_t;
+
+typedef struct
+{
+    uavcan_traffic_t rx;
+    uavcan_traffic_t tx;
+    uint32_t transfers_rx;
+    uint32_t transfers_tx;
+
+    // frames refused by CAN driver for an error (not for lack of TX buffers),
+    // by all interfaces of a redundant node (see uavcan_iface_state_t)
+    uint32_t tx_errors;
+    // transfers not queued for lack of memory
+    uint32_t tx_dropped;
+    // frames refused by libcanard (missed start, wrong toggle, ...)
+    uint32_t rx_errors;
+    // transfers with bad CRC (wrong data type signature, usually)
+    uint32_t rx_crc_errors;
+    // frames dropped for lack of memory
+    uint32_t rx_dropped;
+    // received transfers which could not be decoded
+    uint32_t decode_errors;
+
+    // frames waiting in TX queue
+    uint16_t tx_queue_len;
+    uint16_t tx_queue_peak;
+
+    // Estimated bus load [%] in the last UAVCAN_STATS_LOAD_PERIOD. Only
+    // frames seen by this node are counted.
+    uint8_t bus_load;
+    uint8_t bus_load_peak;
+
+    uint8_t types_len;
+    uavcan_type_stats_t types[UAVCAN_STATS_DATA_TYPES];
+    uavcan_traffic_t other_types_rx;
+    uavcan_traffic_t other_types_tx;
+
+    // received frames by source node, anonymous frames are counted for node 0
+    uavcan_traffic_t nodes_rx[CANARD_MAX_NODE_ID + 1];
+} uavcan_stats_t;
+
+// per node state
+typedef struct
+{
+    uavcan_stats_t stats;
+    // bits transmitted on the bus in the current load period
+    uint32_t load_bits;
+    uint64_t load_period_start;
+} uavcan_stats_ctx_t;
+
+#if UAVCAN_WITH_STATS
+
+struct uavcan_node;
+
+// default node (see uavcan_init())
+const uavcan_stats_t *uavcan_get_stats(void);
+void uavcan_stats_reset(void);
+
+const uavcan_stats_t *uavcan_node_get_stats(const struct uavcan_node *node);
+void uavcan_node_stats_reset(struct uavcan_node *node);
+
+// library internal hooks
+void uavcan_stats_update(uavcan_stats_ctx_t *ctx);
+void uavcan_stats_rx_frame(uavcan_stats_ctx_t *ctx, const CanardCANFrame *frame, int16_t res);
+void uavcan_stats_rx_transfer(uavcan_stats_ctx_t *ctx);
+void uavcan_stats_tx_queued(uavcan_stats_ctx_t *ctx, int16_t res);
+void uavcan_stats_tx_frame(uavcan_stats_ctx_t *ctx, const CanardCANFrame *frame, int res);
+// to be called by transfer handlers
+void uavcan_stats_decode_error(CanardInstance *ins);
+
+#else
+
+#define uavcan_stats_decode_error(ins)
+
+#endif // UAVCAN_WITH_STATS
+
+#ifdef __cplusplus
+}
+#endif
+#endif // UAVCAN_STATS_H
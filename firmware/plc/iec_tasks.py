@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+"""
+Generate IEC_TASKS.h - tasks of a matiec-compiled PLC program, so that plc.c
+can run each of them in its own FreeRTOS task (see plc.c).
+
+matiec runs all the tasks of a resource from RESn_run__(tick), a task is due
+when `tick % interval == 0`. The tasks, their intervals and program instances
+are read from Res*.c, priorities from the ST source (matiec drops them) and
+located variables used by programs from POUS.c.
+
+When the program can't be split (e.g. a task triggered by SINGLE), the header
+is generated empty and plc.c runs the whole configuration by config_run__().
+
+Usage: iec_tasks.py PROG_SRC_DIR ST_FILE > IEC_TASKS.h
+"""
+
+import glob
+import os
+import re
+import sys
+
+HEADER = """\
+// Generated by iec_tasks.py from matiec output, do not edit.
+"""
+
+
+class Unsupported(Exception):
+    pass
+
+
+def read(path):
+    with open(path) as f:
+        return f.read()
+
+
+def st_priorities(st):
+    """TASK name -> PRIORITY from ST source."""
+    st = re.sub(r'\(\*.*?\*\)', '', st, flags=re.S)
+    prios = {}
+    for name, args in re.findall(r'\bTASK\s+(\w+)\s*\(([^)]*)\)', st, re.I):
+        m = re.search(r'\bPRIORITY\s*:=\s*(\d+)', args, re.I)
+        prios[name.upper()] = int(m.group(1)) if m else 0
+    return prios
+
+
+def resource_tasks(res):
+    """[(task, interval)], [(task, type, instance)] of a resource source."""
+    defines = dict(re.findall(r'^#define\s+(\w+)\s+(\w+)\s*$', res, re.M))
+    m = re.search(r'void\s+(\w+)_run__\s*\(\s*unsigned long tick\s*\)\s*\{'
+                  r'(.*?)\n\}', res, re.S)
+    if not m:
+        raise Unsupported('no resource run function')
+    resource, body = m.group(1), m.group(2)
+
+    tasks = []
+    intervals = {}
+    programs = []
+    current = None
+    for line in body.splitlines():
+        line = line.strip()
+        if not line:
+            continue
+        m = re.match(r'(\w+)\s*=\s*!\(\s*tick\s*%\s*(\d+)\s*\);$', line)
+        if m:
+            tasks.append((m.group(1), int(m.group(2))))
+            intervals[m.group(1)] = int(m.group(2))
+            continue
+        m = re.match(r'if\s*\(\s*(\w+)\s*\)\s*\{$', line)
+        if m:
+            if m.group(1) not in intervals:
+                raise Unsupported('task %s is not periodic' % m.group(1))
+            current = m.group(1)
+            continue
+        if line == '}':
+            current = None
+            continue
+        m = re.match(r'(\w+)_body__\s*\(\s*&\s*(\w+)\s*\);$', line)
+        if m:
+            task = current
+            if task is None:
+                # programs without a task run every tick
+                task = resource + '__CYCLIC'
+                if task not in intervals:
+                    tasks.append((task, 1))
+                    intervals[task] = 1
+            instance = defines.get(m.group(2), m.group(2))
+            programs.append((task, m.group(1), instance))
+            continue
+        raise Unsupported('unexpected statement: %s' % line)
+    return tasks, programs
+
+
+def init_functions(src):
+    """POU type -> body of its init function."""
+    return dict(re.findall(r'void\s+(\w+)_init__\s*\(\s*\w+\s*\*\s*data__\s*,'
+                           r'\s*BOOL\s+retain\s*\)\s*\{(.*?)\n\}', src, re.S))
+
+
+def global_locations(src):
+    """global variable -> location (VAR_GLOBAL ... AT %...)."""
+    return {name: loc for _, name, loc in re.findall(
+        r'__INIT_GLOBAL_LOCATED\(\s*(\w+)\s*,\s*(\w+)\s*,\s*(\w+)', src)}
+
+
+def pou_locations(pou, inits, globals_, seen=None):
+    """I/O locations (e.g. __IX0_0) used by POU type and its instances."""
+    seen = seen if seen is not None else set()
+    if pou in seen or pou not in inits:
+        return set()
+    seen.add(pou)
+    body = inits[pou]
+    locs = set(re.findall(r'__INIT_LOCATED\(\s*\w+\s*,\s*(\w+)', body))
+    for name in re.findall(r'__INIT_EXTERNAL\(\s*\w+\s*,\s*(\w+)', body):
+        if name in globals_:
+            locs.add(globals_[name])
+    for sub in re.findall(r'(\w+)_init__\s*\(\s*&\s*data__\s*->', body):
+        locs |= pou_locations(sub, inits, globals_, seen)
+    return {loc for loc in locs if re.match(r'__[IQ][XBWDL]\d', loc)}
+
+
+def generate(src_dir, st_path):
+    resources = sorted(glob.glob(os.path.join(src_dir, 'Res*.c')))
+    if not resources:
+        raise Unsupported('no resource')
+    pous = read(os.path.join(src_dir, 'POUS.c'))
+    config = read(os.path.join(src_dir, 'Config0.c'))
+    prios = st_priorities(read(st_path))
+
+    tasks, programs = [], []
+    sources = config
+    for path in resources:
+        res = read(path)
+        sources += res
+        t, p = resource_tasks(res)
+        tasks += t
+        programs += p
+    if not tasks:
+        raise Unsupported('no task')
+
+    inits = init_functions(pous)
+    globals_ = global_locations(sources)
+    index = {name: i for i, (name, _) in enumerate(tasks)}
+
+    out = [HEADER, '#define IEC_TASKS_NUM %d\n' % len(tasks)]
+    out.append('#ifdef __IEC_TASK')
+    out.append('// name, interval [ticks of common_ticktime__], priority')
+    for name, interval in tasks:
+        out.append('__IEC_TASK(%s, %d, %d)' % (name, interval,
+                                              prios.get(name, 0)))
+    out.append('#endif\n')
+
+    out.append('#ifdef __IEC_PROGRAM')
+    out.append('// task index, POU type, instance')
+    for task, pou, instance in programs:
+        out.append('__IEC_PROGRAM(%d, %s, %s)' % (index[task], pou, instance))
+    out.append('#endif\n')
+
+    out.append('#ifdef __IEC_LOCATED')
+    out.append('// task index, located variable')
+    used = set()
+    for task, pou, _ in programs:
+        for loc in sorted(pou_locations(pou, inits, globals_)):
+            if (task, loc) not in used:
+                used.add((task, loc))
+                out.append('__IEC_LOCATED(%d, %s)' % (index[task], loc))
+    out.append('#endif')
+    return '\n'.join(out) + '\n'
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    try:
+        sys.stdout.write(generate(sys.argv[1], sys.argv[2]))
+    except Unsupported as e:
+        sys.stderr.write('iec_tasks.py: %s, PLC program runs as one task\n'
+                         % e)
+        sys.stdout.write(HEADER)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1 @@
+../plc-prog-src/IEC_TASKS.h
\ No newline at end of file
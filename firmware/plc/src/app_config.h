@@ -36,6 +36,12 @@
 // CAN
 #define CAN_RX_PIN 23
 #define CAN_TX_PIN 22
+// the second CAN interface (MCP2515 on SPI) when UAVCAN_CAN_IFACES is 2
+#define MCP2515_SPI_HOST HSPI_HOST
+#define MCP2515_MOSI_PIN 25
+#define MCP2515_MISO_PIN 19
+#define MCP2515_SCK_PIN 26
+#define MCP2515_CS_PIN 4
 
 // ---------------------------------------------- ui ---------------------------
 
@@ -43,9 +49,14 @@
 
 // ---------------------------------------------- remote blocks ----------------
 
+// find nodes on the bus at the first start and map all their IO instead of
+// UAVCAN_*_BLOCKS (needs UAVCAN_WITH_NODE_INFO_REQUESTS, see discovery.c)
+//#define WITH_DISCOVERY
+
+// `.tell = true` - the node reports inputs by itself (slave WITH_TELL_INPUTS)
 #define UAVCAN_DIS_BLOCKS                                                      \
 	{                                                                      \
-		{ .node_id = 51, .index = 0, .len = 1 },                       \
+		{ .node_id = 51, .index = 0, .len = 1, .tell = true },         \
 	}
 #define UAVCAN_DOS_BLOCKS                                                      \
 	{                                                                      \
@@ -66,6 +77,10 @@
 
 //#define WITH_CAN
 
+// broadcast Sync before each IO round, so all nodes sample inputs and apply
+// outputs at once
+//#define WITH_SYNC
+
 // ---------------------------------------------- WiFi -------------------------
 
 #define WIFI_SSID "MY_WIFI"
@@ -4,6 +4,39 @@
 #define STM32
 #endif
 
+// host build (see hal_posix.c)
+#if defined(__unix__) && !defined(ARDUINO) && !defined(ESP32)
+#define POSIX
+#endif
+
+// ---------------------------------------------- PLC --------------------------
+
+// __CURRENT_TIME advanced by scan period on every cycle (OpenPLC behavior)
+#define PLC_CLOCK_TICKS 0
+// __CURRENT_TIME derived from uptime, drift-free
+#define PLC_CLOCK_UPTIME 1
+
+#ifndef PLC_CLOCK
+#define PLC_CLOCK PLC_CLOCK_TICKS
+#endif
+
+// run missed cycles back-to-back (FreeRTOS vTaskDelayUntil behavior)
+#define PLC_OVERRUN_CATCH_UP 0
+// drop missed cycles, continue at the next period boundary
+#define PLC_OVERRUN_SKIP 1
+// run the next cycle immediately and restart the schedule from it
+#define PLC_OVERRUN_STRETCH 2
+
+#ifndef PLC_OVERRUN_POLICY
+#define PLC_OVERRUN_POLICY PLC_OVERRUN_CATCH_UP
+#endif
+
+// FreeRTOS priorities of IEC tasks, PRIORITY 0 runs at TASK_PRIORITY_PLC, each
+// higher one a level lower, down to TASK_PRIORITY_PLC - LEVELS + 1
+#ifndef PLC_TASK_PRIORITY_LEVELS
+#define PLC_TASK_PRIORITY_LEVELS 4
+#endif
+
 // ---------------------------------------------- communication ----------------
 
 // how often to transmit node status message [ms]
@@ -12,6 +45,153 @@
 // how often to run uavcan RX/TX [ms]
 #define UAVCAN_RXTX_PERIOD 10
 
+#ifndef UAVCAN_REQUEST_TIMEOUT
+// GetValues response timeout, block values are considered stale then [ms]
+#define UAVCAN_REQUEST_TIMEOUT 100
+#endif
+
+#ifndef UAVCAN_MAX_PENDING_REQUESTS
+#define UAVCAN_MAX_PENDING_REQUESTS 16
+#endif
+
+#ifndef CAN_TX_QUEUE_LEN
+// ESP32 CAN driver TX queue length, frames that don't fit wait in UAVCAN queue
+#define CAN_TX_QUEUE_LEN 16
+#endif
+
+#ifndef MCP2515_OSC_HZ
+// crystal of MCP2515, the second CAN interface of ESP32 [Hz]
+#define MCP2515_OSC_HZ 8000000
+#endif
+
+#ifndef MCP2515_SPI_CLOCK
+// MCP2515 SPI clock, max. 10 MHz [Hz]
+#define MCP2515_SPI_CLOCK 8000000
+#endif
+
+#ifndef CAN_RX_BUFF_SIZE
+// STM32 RX ring buffer size (power of 2), filled by RX interrupt [frames]
+#define CAN_RX_BUFF_SIZE 32
+#endif
+
+#ifndef UAVCAN_OUTPUTS_REFRESH_PERIOD
+// Output blocks are sent when they change and at least once per this period,
+// 0 sends them in every RX/TX round [ms]
+#define UAVCAN_OUTPUTS_REFRESH_PERIOD 1000
+#endif
+
+// Define UAVCAN_BLOCKS_STATUS to get one more remote DI for every remote input
+// block (DI blocks first, then AI blocks) right after DI blocks values. It's
+// true when the block values are up to date, PLC program can check it.
+
+// Define UAVCAN_NODES_STATUS to get one more remote DI and AI for every node
+// with remote blocks (ascending node IDs), after DIs of UAVCAN_BLOCKS_STATUS
+// and after AI blocks values. DI is true while the node is online (broadcasts
+// NodeStatus), AI is its last reported health (0 OK, 1 WARNING, 2 ERROR,
+// 3 CRITICAL). Blocks of an offline node are stale.
+#if defined(UAVCAN_NODES_STATUS) && !UAVCAN_WITH_NODE_TABLE
+#error "UAVCAN_NODES_STATUS needs UAVCAN_WITH_NODE_TABLE=1 (platformio.ini)"
+#endif
+
+// Inputs reporting by exception (WITH_TELL_INPUTS) - inputs are sampled
+// periodically and broadcast (TellValues) when they change.
+#ifndef TELL_SAMPLE_PERIOD
+// inputs sampling period [ms]
+#define TELL_SAMPLE_PERIOD 5
+#endif
+
+#ifndef TELL_REFRESH_PERIOD
+// broadcast all inputs at least once per this period [ms]
+#define TELL_REFRESH_PERIOD 1000
+#endif
+
+#ifndef TELL_AI_DEADBAND
+// analog input change smaller or equal to this is not reported
+#define TELL_AI_DEADBAND 0
+#endif
+
+#ifndef UAVCAN_TELL_TIMEOUT
+// told values are considered stale if not refreshed within this period [ms]
+#define UAVCAN_TELL_TIMEOUT (3 * TELL_REFRESH_PERIOD)
+#endif
+
+#ifndef SYNC_TIMEOUT
+// Node leaves sync mode (see WITH_SYNC) when there's no Sync for this time [ms]
+#define SYNC_TIMEOUT 2000
+#endif
+
+// Outputs failsafe (WITH_FAILSAFE) - when the node which sets outputs (master)
+// goes offline (no NodeStatus for UAVCAN_NODE_TIMEOUT) or restarts, outputs are
+// set to FAILSAFE_DOS and FAILSAFE_AOS until the master sets them again.
+#if defined(WITH_FAILSAFE) && !UAVCAN_WITH_NODE_TABLE
+#error "WITH_FAILSAFE needs UAVCAN_WITH_NODE_TABLE=1 (platformio.ini)"
+#endif
+
+#ifndef FAILSAFE_DOS
+// safe DO values, all off by default
+#define FAILSAFE_DOS                                                           \
+	{                                                                      \
+	}
+#endif
+
+#ifndef FAILSAFE_AOS
+// safe AO values, all 0 by default
+#define FAILSAFE_AOS                                                           \
+	{                                                                      \
+	}
+#endif
+
+#ifndef POSIX_CAN_IFACE
+// SocketCAN interface used by the host build, CAN_IFACE env var overrides it
+#define POSIX_CAN_IFACE "vcan0"
+#endif
+
+#ifndef POSIX_CAN_IFACE2
+// the second one when UAVCAN_CAN_IFACES is 2, CAN_IFACE2 env var overrides it
+#define POSIX_CAN_IFACE2 "vcan1"
+#endif
+
+#ifndef POSIX_CAN_FILTERS
+// max. number of SocketCAN filters planned from accepted transfers
+#define POSIX_CAN_FILTERS 16
+#endif
+
+#ifndef POSIX_STORAGE_DIR
+// host build storage (see hal_storage_load()), STORAGE_DIR env var overrides it
+#define POSIX_STORAGE_DIR "."
+#endif
+
+// Remote blocks discovery (WITH_DISCOVERY) - UAVCAN_*_BLOCKS are not used, PLC
+// finds nodes on the bus at startup and maps all their IO (see discovery.c).
+// Found nodes are stored and used at the next start, no discovery is needed.
+#if defined(WITH_DISCOVERY) && !UAVCAN_WITH_NODE_INFO_REQUESTS
+#error "WITH_DISCOVERY needs UAVCAN_WITH_NODE_INFO_REQUESTS=1 (platformio.ini)"
+#endif
+
+#ifndef UAVCAN_DISCOVERY_TIME
+// wait for nodes this long, it must be longer than their status period [ms]
+#define UAVCAN_DISCOVERY_TIME 3000
+#endif
+
+#ifndef UAVCAN_DISCOVERY_TIMEOUT
+// GetNodeInfo and GetInventory response timeout [ms]
+#define UAVCAN_DISCOVERY_TIMEOUT 500
+#endif
+
+#ifndef UAVCAN_DISCOVERY_RETRIES
+// a node which doesn't respond after this many requests is not mapped
+#define UAVCAN_DISCOVERY_RETRIES 3
+#endif
+
+#ifndef UAVCAN_DISCOVERY_MAX_NODES
+#define UAVCAN_DISCOVERY_MAX_NODES 16
+#endif
+
+#ifndef UAVCAN_MAX_BLOCKS
+// room for discovered blocks of each type (DI, DO, AI, AO)
+#define UAVCAN_MAX_BLOCKS 16
+#endif
+
 #ifndef UAVCAN_DIS_BLOCKS
 #define UAVCAN_DIS_BLOCKS                                                      \
 	{                                                                      \
@@ -36,6 +216,20 @@
 	}
 #endif
 
+// ---------------------------------------------- parameters -------------------
+
+#ifndef PARAMS_MAX
+// max. number of registered parameters (see params.h)
+#define PARAMS_MAX 32
+#endif
+
+#ifndef PARAMS_SAVE_DELAY
+// Persistent parameters are saved this long after the last change, so that a
+// tool setting many of them writes storage just once. 0 saves them only on
+// ExecuteOpcode SAVE request [ms]
+#define PARAMS_SAVE_DELAY 5000
+#endif
+
 // ---------------------------------------------- MQTT -------------------------
 
 #ifdef WITH_MQTT
@@ -90,6 +284,18 @@
 #define MQTT_RESET_TOPIC MQTT_SUBTOPIC("reset")
 #endif
 
+#ifndef MQTT_STATS_TOPIC
+#define MQTT_STATS_TOPIC MQTT_SUBTOPIC("stats")
+#endif
+
+#ifndef MQTT_STATS_PERIOD
+// how often to publish scan cycle statistics, 0 disables it [ms]
+#define MQTT_STATS_PERIOD 10000
+#endif
+
+// enough for all stats histograms
+#define MQTT_STATS_MAX_LEN 2048
+
 // ---------------------------------------------- ui ---------------------------
 
 #ifdef STATUS_LEDS_INVERTED
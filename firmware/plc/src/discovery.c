@@ -0,0 +1,322 @@
+#include "app_config.h"
+#if defined(WITH_CAN) && defined(WITH_DISCOVERY)
+
+#include <stddef.h>
+#include <string.h>
+
+#include "discovery.h"
+#include "hal.h"
+#include "plc.h"
+#include "tools.h"
+
+/*
+Remote blocks discovery. Every node which broadcasts NodeStatus is asked for
+GetNodeInfo (just to be sure it responds and to log its name), then for its IO
+inventory (automation.GetInventory). All the IO of responding nodes is mapped,
+nodes ordered by node ID, each one DIs, DOs, AIs, AOs from index 0 (split into
+blocks of max. transfer length). E.g. nodes 51 (4 DIs, 2 AIs) and 52 (2 DIs)
+give remote DIs 0-3 = 51 DI0-3, 4-5 = 52 DI0-1, remote AIs 0-1 = 51 AI0-1.
+
+The nodes are stored, following starts just map them. Nodes which appear later
+are not mapped, stored nodes must be forgotten (uavcan.discovered_nodes
+parameter) and PLC restarted.
+*/
+
+typedef enum {
+	NODE_UNKNOWN = 0,
+	NODE_SEEN, // NodeStatus received
+	NODE_INFO, // GetNodeInfo sent
+	NODE_IDENTIFIED, // GetNodeInfo response received
+	NODE_INVENTORY, // GetInventory sent
+	NODE_MAPPED,
+	NODE_FAILED, // not responding, not mapped
+	NODE_IGNORED, // appeared after discovery, not mapped
+} node_state_t;
+
+typedef struct {
+	uint8_t state;
+	uint8_t tries; // requests sent in the current state
+	uint8_t transfer_id; // GetInventory
+	uint32_t sent; // [ms]
+} node_t;
+
+static node_t nodes[UAVCAN_NODES_NUM];
+static bool discovery_done = false;
+
+// ---------------------------------------------- storage ----------------------
+
+#define STORAGE_KEY "uavcan_nodes"
+// bump when stored_nodes_t changes
+#define STORAGE_VERSION 1
+
+typedef struct {
+	uint8_t node_id;
+	uint8_t dis_num;
+	uint8_t dos_num;
+	uint8_t ais_num;
+	uint8_t aos_num;
+	bool tell_inputs;
+} stored_node_t;
+
+// only nodes_len of nodes are stored
+typedef struct {
+	uint8_t version;
+	uint8_t nodes_len;
+	stored_node_t nodes[UAVCAN_DISCOVERY_MAX_NODES];
+} stored_nodes_t;
+
+static stored_nodes_t stored;
+
+#define STORED_SIZE(nodes_len)                                                 \
+	(offsetof(stored_nodes_t, nodes) + (nodes_len) * sizeof(stored_node_t))
+
+static bool load_nodes(void)
+{
+	int len = hal_storage_load(STORAGE_KEY, &stored, sizeof(stored));
+
+	if (len < (int)STORED_SIZE(0) || stored.version != STORAGE_VERSION ||
+	    stored.nodes_len > UAVCAN_DISCOVERY_MAX_NODES ||
+	    len != (int)STORED_SIZE(stored.nodes_len)) {
+		stored.nodes_len = 0;
+		return false;
+	}
+	return true;
+}
+
+static void save_nodes(void)
+{
+	stored.version = STORAGE_VERSION;
+	if (hal_storage_save(STORAGE_KEY, &stored,
+			     STORED_SIZE(stored.nodes_len))) {
+		log_error("Failed to store discovered nodes");
+	}
+}
+
+int discovery_forget()
+{
+	return hal_storage_erase(STORAGE_KEY);
+}
+
+uint8_t discovery_nodes_num()
+{
+	return stored.nodes_len;
+}
+
+// ---------------------------------------------- blocks -----------------------
+
+static void add_blocks(const char *type, uavcan_vals_block_t *blocks,
+		       uint8_t *blocks_len, uint8_t node_id, uint8_t num,
+		       uint8_t block_max, bool tell)
+{
+	for (uint16_t index = 0; index < num; index += block_max) {
+		if (*blocks_len >= UAVCAN_MAX_BLOCKS) {
+			log_error("No room for node %d %s blocks", node_id,
+				  type);
+			return;
+		}
+		uavcan_vals_block_t *block = &blocks[(*blocks_len)++];
+		memset(block, 0, sizeof(*block));
+		block->node_id = node_id;
+		block->index = index;
+		block->len = min(num - index, (int)block_max);
+		block->tell = tell;
+	}
+}
+
+static void build_blocks(void)
+{
+	uavcan_dis_blocks_len = 0;
+	uavcan_dos_blocks_len = 0;
+	uavcan_ais_blocks_len = 0;
+	uavcan_aos_blocks_len = 0;
+
+	for (uint8_t i = 0; i < stored.nodes_len; i++) {
+		const stored_node_t *node = &stored.nodes[i];
+
+		log_info("Node %d: DI %d, DO %d, AI %d, AO %d%s", node->node_id,
+			 node->dis_num, node->dos_num, node->ais_num,
+			 node->aos_num, node->tell_inputs ? ", told" : "");
+		add_blocks("DI", uavcan_dis_blocks, &uavcan_dis_blocks_len,
+			   node->node_id, node->dis_num,
+			   AUTOMATION_DIGITALVALUES_VALUES_MAX_LENGTH,
+			   node->tell_inputs);
+		add_blocks("DO", uavcan_dos_blocks, &uavcan_dos_blocks_len,
+			   node->node_id, node->dos_num,
+			   AUTOMATION_DIGITALVALUES_VALUES_MAX_LENGTH, false);
+		add_blocks("AI", uavcan_ais_blocks, &uavcan_ais_blocks_len,
+			   node->node_id, node->ais_num,
+			   AUTOMATION_ANALOGVALUES_VALUES_MAX_LENGTH,
+			   node->tell_inputs);
+		add_blocks("AO", uavcan_aos_blocks, &uavcan_aos_blocks_len,
+			   node->node_id, node->aos_num,
+			   AUTOMATION_ANALOGVALUES_VALUES_MAX_LENGTH, false);
+		nodes[node->node_id].state = NODE_MAPPED;
+	}
+}
+
+// ---------------------------------------------- discovery --------------------
+
+static void send_request(uint8_t node_id, node_t *node, node_state_t state)
+{
+	int16_t res;
+
+	if (node->state != state) {
+		node->state = state;
+		node->tries = 0;
+	}
+	node->tries++;
+	node->sent = hal_uptime_msec();
+
+	if (state == NODE_INFO) {
+		res = uavcan_send_get_node_info(node_id);
+	} else {
+		res = automation_send_get_inventory(node_id);
+		node->transfer_id = res;
+	}
+	if (res < 0) {
+		// retried after timeout
+		log_error("Node %d discovery TX failed", node_id);
+	}
+}
+
+// Send requests to the nodes which need them, returns false when there's
+// nothing to wait for.
+static bool discovery_step(void)
+{
+	uint32_t now = hal_uptime_msec();
+	bool busy = false;
+
+	for (uint8_t id = 0; id < UAVCAN_NODES_NUM; id++) {
+		node_t *node = &nodes[id];
+
+		switch (node->state) {
+		case NODE_SEEN:
+			send_request(id, node, NODE_INFO);
+			break;
+		case NODE_IDENTIFIED:
+			send_request(id, node, NODE_INVENTORY);
+			break;
+		case NODE_INFO:
+		case NODE_INVENTORY:
+			if (now - node->sent < UAVCAN_DISCOVERY_TIMEOUT) {
+				break;
+			}
+			if (node->tries >= UAVCAN_DISCOVERY_RETRIES) {
+				log_warning("Node %d does not respond", id);
+				node->state = NODE_FAILED;
+				continue;
+			}
+			send_request(id, node, node->state);
+			break;
+		default:
+			continue;
+		}
+		busy = true;
+	}
+	return busy;
+}
+
+int discovery_run()
+{
+	if (load_nodes()) {
+		log_info("%d stored nodes", stored.nodes_len);
+		build_blocks();
+		discovery_done = true;
+		return 0;
+	}
+
+	log_info("Discovering nodes...");
+	uint32_t start = hal_uptime_msec();
+	uint32_t last_status = start;
+	TickType_t last_wake = xTaskGetTickCount();
+
+	for (;;) {
+		uavcan_update();
+		bool busy = discovery_step();
+		uavcan_update();
+
+		uint32_t now = hal_uptime_msec();
+		if (now - start >= UAVCAN_DISCOVERY_TIME && !busy) {
+			break;
+		}
+		// UAVCAN task is not running yet
+		if (now - last_status >= UAVCAN_STATUS_PERIOD) {
+			last_status = now;
+			uavcan_broadcast_status();
+		}
+		vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(UAVCAN_RXTX_PERIOD));
+	}
+
+	discovery_done = true;
+	build_blocks();
+	if (stored.nodes_len > 0) {
+		save_nodes();
+	} else {
+		log_warning("No nodes found");
+	}
+	return 0;
+}
+
+// ---------------------------------------------- UAVCAN callbacks -------------
+
+void discovery_on_node_status(uint8_t node_id)
+{
+	node_t *node = &nodes[node_id];
+
+	if (node->state != NODE_UNKNOWN) {
+		return;
+	}
+	if (discovery_done) {
+		log_warning("Node %d is not mapped, forget stored nodes and "
+			    "restart to map it",
+			    node_id);
+		node->state = NODE_IGNORED;
+		return;
+	}
+	node->state = NODE_SEEN;
+}
+
+void discovery_on_node_info(uint8_t node_id,
+			    const uavcan_protocol_GetNodeInfoResponse *info)
+{
+	node_t *node = &nodes[node_id];
+
+	if (node->state != NODE_INFO) {
+		return;
+	}
+	log_info("Node %d is %.*s v. %d.%d", node_id, info->name.len,
+		 (const char *)info->name.data, info->software_version.major,
+		 info->software_version.minor);
+	node->state = NODE_IDENTIFIED;
+}
+
+void discovery_on_inventory(uint8_t node_id, uint8_t transfer_id,
+			    const automation_GetInventoryResponse *inventory)
+{
+	node_t *node = &nodes[node_id];
+
+	if (node->state != NODE_INVENTORY || node->transfer_id != transfer_id) {
+		return;
+	}
+	if (stored.nodes_len >= UAVCAN_DISCOVERY_MAX_NODES) {
+		log_error("Too many nodes, node %d is not mapped", node_id);
+		node->state = NODE_FAILED;
+		return;
+	}
+	// responses come in random order, keep nodes sorted by ID
+	uint8_t i = stored.nodes_len++;
+	while (i > 0 && stored.nodes[i - 1].node_id > node_id) {
+		stored.nodes[i] = stored.nodes[i - 1];
+		i--;
+	}
+	stored_node_t *stored_node = &stored.nodes[i];
+	stored_node->node_id = node_id;
+	stored_node->dis_num = inventory->dis_num;
+	stored_node->dos_num = inventory->dos_num;
+	stored_node->ais_num = inventory->ais_num;
+	stored_node->aos_num = inventory->aos_num;
+	stored_node->tell_inputs = inventory->tell_inputs;
+	node->state = NODE_MAPPED;
+}
+
+#endif // if defined(WITH_CAN) && defined(WITH_DISCOVERY)
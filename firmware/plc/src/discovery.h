@@ -0,0 +1,31 @@
+#include "app_config.h"
+#if defined(WITH_CAN) && defined(WITH_DISCOVERY)
+
+#include <uavcan_node.h>
+#include <uavcan_automation.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fill in uavcan_*_blocks with IO of the stored nodes or, if there are none,
+// find nodes on the bus and store them. UAVCAN must be initialized and not
+// used by any task yet, discovery runs it for up to UAVCAN_DISCOVERY_TIME.
+int discovery_run(void);
+// forget the stored nodes, discovery runs again at the next start
+int discovery_forget(void);
+// number of mapped nodes
+uint8_t discovery_nodes_num(void);
+
+// UAVCAN callbacks
+void discovery_on_node_status(uint8_t node_id);
+void discovery_on_node_info(uint8_t node_id,
+			    const uavcan_protocol_GetNodeInfoResponse *info);
+void discovery_on_inventory(uint8_t node_id, uint8_t transfer_id,
+			    const automation_GetInventoryResponse *inventory);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,3 +1,4 @@
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -12,6 +13,12 @@ extern "C" {
 #include <freertos/task.h>
 #endif
 
+#ifdef POSIX
+#include <stdio.h>
+
+#include "rtos_posix.h"
+#endif
+
 // ---------------------------------------------- logging ----------------------
 int log_init(void);
 
@@ -20,7 +27,7 @@ void log_warning2(const char *format, ...);
 void log_info2(const char *format, ...);
 void log_debug2(const char *format, ...);
 
-#ifdef ESP32
+#if defined(ESP32) || defined(POSIX)
 #define PRINTF(format, ...) printf(format, ##__VA_ARGS__)
 #endif
 
@@ -32,7 +39,7 @@ void log_debug2(const char *format, ...);
 #define DBG_SERIAL Serial3
 #endif
 
-#if defined(STM32F1) || defined(__AVR__)
+#if defined(STM32F1) || defined(__AVR__) || defined(POSIX)
 #define PRINTS(x) prints(x)
 #define PRINTU(x) printu(x)
 #define PRINTX(x) printx(x)
@@ -119,6 +126,16 @@ int mqtt_publish(const char *topic, const char *data, int data_len);
 int mqtt_publish5(const char *topic, const char *data, int data_len, int qos,
 		  int retain);
 
+// ---------------------------------------------- storage ----------------------
+
+// Persistent key-value storage (NVS on ESP32, files on host, EEPROM on Arduino
+// boards where just one key can be stored). Load returns length of the stored
+// value or -1 if there's none (or it's longer than `len`), save and erase
+// return 0 on success.
+int hal_storage_load(const char *key, void *buff, size_t len);
+int hal_storage_save(const char *key, const void *data, size_t len);
+int hal_storage_erase(const char *key);
+
 // ---------------------------------------------- misc -------------------------
 
 typedef enum {
@@ -20,6 +20,7 @@
 #include "uavcan_impl.h"
 #include "hal.h"
 #include "locks.h"
+#include "mcp2515.h"
 #include "plc.h"
 #include "ui.h"
 #include "tools.h"
@@ -135,6 +136,11 @@ int get_ai_pin_value(int pin, uint16_t *value)
 // ---------------------------------------------- CAN --------------------------
 
 #ifdef WITH_CAN
+// the internal controller and MCP2515 on SPI (see mcp2515.h)
+#if UAVCAN_CAN_IFACES > 2
+#error "ESP32 HAL supports max. 2 CAN interfaces"
+#endif
+
 static void can_watch_task(void *pvParameters);
 TaskHandle_t can_watch_task_h = NULL;
 volatile can_bus_state_t can_bus_state = CANBS_ERR_PASSIVE;
@@ -145,8 +151,17 @@ int can2_init()
 	// tx, rx pins
 	can_general_config_t g_config = CAN_GENERAL_CONFIG_DEFAULT(
 		CAN_TX_PIN, CAN_RX_PIN, CAN_MODE_NORMAL);
+	g_config.tx_queue_len = CAN_TX_QUEUE_LEN;
 	can_timing_config_t t_config = CAN_TIMING_CONFIG_250KBITS();
 	can_filter_config_t f_config = CAN_FILTER_CONFIG_ACCEPT_ALL();
+	uavcan_can_filter_t filter;
+	if (uavcan_plan_filters(&filter, 1)) {
+		// single filter mode, extended frame: ID << 3 | RTR | 2 unused
+		// bits, mask bits set to 1 are "don't care"
+		f_config.acceptance_code = filter.id << 3;
+		f_config.acceptance_mask = ~(filter.mask << 3);
+		f_config.single_filter = true;
+	}
 
 	//Install CAN driver
 	if (!can_driver_install(&g_config, &t_config, &f_config) == ESP_OK) {
@@ -176,6 +191,13 @@ int can2_init()
 		return -4;
 	}
 
+#if UAVCAN_CAN_IFACES > 1
+	if (mcp2515_init() != 0) {
+		log_error("Failed to init the second CAN interface");
+		return -5;
+	}
+#endif
+
 	return 0;
 }
 
@@ -261,7 +283,7 @@ void uavcan_get_unique_id(
 	}
 }
 
-int uavcan_can_rx(CanardCANFrame *frame)
+int uavcan_can_rx(CanardCANFrame *frame, uint64_t *timestamp_usec)
 {
 	can_message_t esp_msg;
 
@@ -316,25 +338,64 @@ int uavcan_can_tx(const CanardCANFrame *frame)
 	if (frame->data_len > sizeof(esp_msg.data)) {
 		log_error("Canard frame too big (%u > %lu)!", frame->data_len,
 			  sizeof(esp_msg.data));
-		return -1;
+		return UAVCAN_CAN_TX_INVALID;
 	}
 
 	memcpy(esp_msg.data, frame->data, frame->data_len);
 	esp_msg.data_length_code = frame->data_len;
 
+	// never wait for space in driver TX queue, uavcan_flush() retries later
+	esp_err_t res = can_transmit(&esp_msg, 0);
+	if (res == ESP_ERR_TIMEOUT) {
+		return UAVCAN_CAN_TX_BUSY;
+	}
+	if (res != ESP_OK) {
+		// bus off or recovering (see can_watch_task), logged there
+		return -2;
+	}
+
 #if !defined(WITHOUT_COM_DEBUG) && (LOGLEVEL >= LOGLEVEL_DEBUG)
 	print_frame("<-", frame);
 #endif
 
-	if (!can_transmit(&esp_msg, pdMS_TO_TICKS(10)) == ESP_OK) {
-		log_error("CAN TX error");
-		return -2;
+	ui_can_tx();
+
+	return 0;
+}
+
+#if UAVCAN_CAN_IFACES > 1
+int uavcan_can_iface_rx(uint8_t iface, CanardCANFrame *frame,
+			uint64_t *timestamp_usec)
+{
+	if (!mcp2515_rx(frame)) {
+		return 0;
+	}
+
+	ui_can_rx();
+
+#if !defined(WITHOUT_COM_DEBUG) && (LOGLEVEL >= LOGLEVEL_DEBUG)
+	print_frame("2->", frame);
+#endif
+
+	return 1;
+}
+
+int uavcan_can_iface_tx(uint8_t iface, const CanardCANFrame *frame)
+{
+	int res = mcp2515_tx(frame);
+	if (res != UAVCAN_CAN_TX_OK) {
+		return res;
 	}
 
+#if !defined(WITHOUT_COM_DEBUG) && (LOGLEVEL >= LOGLEVEL_DEBUG)
+	print_frame("<-2", frame);
+#endif
+
 	ui_can_tx();
 
 	return 0;
 }
+#endif
 #endif // ifdef WITH_CAN
 
 // ---------------------------------------------- wifi -------------------------
@@ -342,10 +403,11 @@ int uavcan_can_tx(const CanardCANFrame *frame)
 #ifdef WITH_WIFI
 
 static esp_err_t wifi_event_handler(void *ctx, system_event_t *event);
+static esp_err_t nvs_init(void);
 
 int wifi_init()
 {
-	RET_CHECK(nvs_flash_init(), "NVS init");
+	RET_CHECK(nvs_init(), "NVS init");
 	tcpip_adapter_init();
 	RET_CHECK(esp_event_loop_init(wifi_event_handler, NULL),
 		  "Wifi event loop creation");
@@ -609,6 +671,73 @@ int mqtt_publish(const char *topic, const char *data, int data_len)
 
 #endif // ifdef WITH_MQTT
 
+// ---------------------------------------------- storage ----------------------
+
+#define STORAGE_NAMESPACE "plc"
+
+// NVS is used by wifi driver too, it must be initialized just once
+static esp_err_t nvs_init(void)
+{
+	static bool initialized = false;
+
+	if (!initialized) {
+		esp_err_t err = nvs_flash_init();
+		if (err != ESP_OK) {
+			return err;
+		}
+		initialized = true;
+	}
+	return ESP_OK;
+}
+
+int hal_storage_load(const char *key, void *buff, size_t len)
+{
+	nvs_handle handle;
+
+	if (nvs_init() != ESP_OK ||
+	    nvs_open(STORAGE_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+		return -1;
+	}
+	esp_err_t err = nvs_get_blob(handle, key, buff, &len);
+	nvs_close(handle);
+
+	return (err == ESP_OK) ? (int)len : -1;
+}
+
+int hal_storage_save(const char *key, const void *data, size_t len)
+{
+	nvs_handle handle;
+
+	if (nvs_init() != ESP_OK ||
+	    nvs_open(STORAGE_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+		return -1;
+	}
+	esp_err_t err = nvs_set_blob(handle, key, data, len);
+	if (err == ESP_OK) {
+		err = nvs_commit(handle);
+	}
+	nvs_close(handle);
+
+	return (err == ESP_OK) ? 0 : -1;
+}
+
+int hal_storage_erase(const char *key)
+{
+	nvs_handle handle;
+
+	if (nvs_init() != ESP_OK ||
+	    nvs_open(STORAGE_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+		return -1;
+	}
+	esp_err_t err = nvs_erase_key(handle, key);
+	if (err == ESP_OK) {
+		err = nvs_commit(handle);
+	}
+	nvs_close(handle);
+
+	return (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND) ? 0 : -1;
+}
+
 // ---------------------------------------------- misc -------------------------
 
 void hal_restart(void)
@@ -0,0 +1,490 @@
+// Host (Linux) HAL. Allows to run PLC and slave firmware as regular processes,
+// CAN bus is emulated with SocketCAN - typically a virtual `vcan` interface
+// shared by all nodes running on the host:
+//
+//  $ sudo modprobe vcan
+//  $ sudo ip link add dev vcan0 type vcan
+//  $ sudo ip link set up vcan0
+
+#include "app_config.h"
+
+#ifdef POSIX
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef WITH_CAN
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+#include <uavcan_node.h>
+
+#include "uavcan_impl.h"
+#endif
+
+#include "hal.h"
+#include "ui.h"
+
+// ---------------------------------------------- logging ----------------------
+
+int log_init(void)
+{
+	// Disable buffering on stdout
+	// We need this to immediatelly get logs even when there's no NL
+	// (like in init "x ... y ... z OK" messages).
+	setvbuf(stdout, NULL, _IONBF, 0);
+	return 0;
+}
+
+#define TO_PRINTF                                                              \
+	va_list args;                                                          \
+	va_start(args, fmt);                                                   \
+	vprintf(fmt, args);                                                    \
+	va_end(args);                                                          \
+	printf("\n");
+
+void log_error2(const char *fmt, ...)
+{
+	TO_PRINTF
+}
+void log_warning2(const char *fmt, ...)
+{
+	TO_PRINTF
+}
+void log_info2(const char *fmt, ...)
+{
+	TO_PRINTF
+}
+void log_debug2(const char *fmt, ...)
+{
+	TO_PRINTF
+}
+
+void prints(const char *s)
+{
+	printf("%s", s);
+}
+
+void printu(uint16_t u)
+{
+	printf("%u", u);
+}
+
+void printx(uint16_t x)
+{
+	printf("%X", x);
+}
+
+// ---------------------------------------------- IO ---------------------------
+
+// There are no real pins on host. Pin values are just kept in memory, so
+// outputs can be read back and inputs stay at their initial value.
+#define SIM_PINS_NUM 64
+
+static uint16_t sim_pins[SIM_PINS_NUM];
+
+#define CHECK_PIN(pin)                                                         \
+	if ((pin) < 0 || (pin) >= SIM_PINS_NUM) {                              \
+		log_error("invalid pin %d", pin);                              \
+		return -1;                                                     \
+	}
+
+int set_pin_mode_di(int pin)
+{
+	CHECK_PIN(pin);
+	return 0;
+}
+
+int set_pin_mode_do(int pin)
+{
+	CHECK_PIN(pin);
+	return 0;
+}
+
+int set_pin_mode_ai(int pin)
+{
+	CHECK_PIN(pin);
+	return 0;
+}
+
+int set_pin_mode_ao(int pin)
+{
+	CHECK_PIN(pin);
+	return 0;
+}
+
+int set_do_pin_value(int pin, bool value)
+{
+	CHECK_PIN(pin);
+	sim_pins[pin] = value;
+	return 0;
+}
+
+int get_di_pin_value(int pin, bool *value)
+{
+	CHECK_PIN(pin);
+	*value = sim_pins[pin];
+	return 0;
+}
+
+int set_ao_pin_value(int pin, uint16_t value)
+{
+	CHECK_PIN(pin);
+	sim_pins[pin] = value;
+	return 0;
+}
+
+int get_ai_pin_value(int pin, uint16_t *value)
+{
+	CHECK_PIN(pin);
+	*value = sim_pins[pin];
+	return 0;
+}
+
+// ---------------------------------------------- CAN --------------------------
+
+#ifdef WITH_CAN
+#if UAVCAN_CAN_IFACES > 2
+#error "Host HAL supports max. 2 CAN interfaces"
+#endif
+
+static int can_socks[UAVCAN_CAN_IFACES];
+volatile can_bus_state_t can_bus_state = CANBS_ERR_ACTIVE;
+
+static int can_open(int *sock, const char *iface)
+{
+	struct sockaddr_can addr;
+	struct ifreq ifr;
+
+	if ((*sock = socket(PF_CAN, SOCK_RAW, CAN_RAW)) < 0) {
+		log_error("Failed to open CAN socket: %s", strerror(errno));
+		return -1;
+	}
+
+	memset(&ifr, 0, sizeof(ifr));
+	strncpy(ifr.ifr_name, iface, IFNAMSIZ - 1);
+	if (ioctl(*sock, SIOCGIFINDEX, &ifr) < 0) {
+		log_error("CAN interface %s not found", iface);
+		return -2;
+	}
+
+	uavcan_can_filter_t filters[POSIX_CAN_FILTERS];
+	struct can_filter raw_filters[POSIX_CAN_FILTERS];
+	uint8_t len = uavcan_plan_filters(filters, POSIX_CAN_FILTERS);
+	for (uint8_t i = 0; i < len; i++) {
+		raw_filters[i].can_id = filters[i].id | CAN_EFF_FLAG;
+		raw_filters[i].can_mask = filters[i].mask | CAN_EFF_FLAG;
+	}
+	if (len > 0 && setsockopt(*sock, SOL_CAN_RAW, CAN_RAW_FILTER,
+				  raw_filters,
+				  len * sizeof(raw_filters[0])) < 0) {
+		log_error("Failed to set CAN filters: %s", strerror(errno));
+		return -5;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.can_family = AF_CAN;
+	addr.can_ifindex = ifr.ifr_ifindex;
+	if (bind(*sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		log_error("Failed to bind CAN socket: %s", strerror(errno));
+		return -3;
+	}
+
+	// uavcan_can_rx/tx must never block
+	if (fcntl(*sock, F_SETFL, O_NONBLOCK) < 0) {
+		return -4;
+	}
+
+	return 0;
+}
+
+int can2_init()
+{
+	const char *iface = getenv("CAN_IFACE");
+
+	if (iface == NULL) {
+		iface = POSIX_CAN_IFACE;
+	}
+	int res = can_open(&can_socks[0], iface);
+
+#if UAVCAN_CAN_IFACES > 1
+	iface = getenv("CAN_IFACE2");
+	if (iface == NULL) {
+		iface = POSIX_CAN_IFACE2;
+	}
+	if (res == 0) {
+		res = can_open(&can_socks[1], iface);
+	}
+#endif
+
+	return res;
+}
+
+// ---------------------------------------------- UAVCAN -----------------------
+
+void uavcan_get_unique_id(
+	uint8_t out_uid[UAVCAN_PROTOCOL_HARDWAREVERSION_UNIQUE_ID_LENGTH])
+{
+	// more nodes can run on the same host => add node id
+	uint32_t host_id = gethostid();
+
+	for (int i = 0; i < UAVCAN_PROTOCOL_HARDWAREVERSION_UNIQUE_ID_LENGTH;
+	     i++) {
+		out_uid[i] = 0xFF;
+	}
+	memcpy(out_uid, &host_id, sizeof(host_id));
+	out_uid[sizeof(host_id)] = UAVCAN_NODE_ID;
+}
+
+static int can_rx(int sock, CanardCANFrame *frame)
+{
+	struct can_frame msg;
+
+	if (read(sock, &msg, sizeof(msg)) != sizeof(msg)) {
+		return 0;
+	}
+
+	if (msg.can_id & CAN_ERR_FLAG) {
+		return 0;
+	}
+
+	ui_can_rx();
+
+	if (msg.can_id & CAN_EFF_FLAG) {
+		frame->id = (msg.can_id & CAN_EFF_MASK) | CANARD_CAN_FRAME_EFF;
+	} else {
+		frame->id = msg.can_id & CAN_SFF_MASK;
+	}
+	if (msg.can_id & CAN_RTR_FLAG) {
+		frame->id |= CANARD_CAN_FRAME_RTR;
+	}
+
+	if (msg.can_dlc > CANARD_CAN_FRAME_MAX_DATA_LEN) {
+		log_error("CAN frame too big (%u > %u)!", msg.can_dlc,
+			  CANARD_CAN_FRAME_MAX_DATA_LEN);
+		return 0;
+	}
+
+	memcpy(frame->data, msg.data, msg.can_dlc);
+	frame->data_len = msg.can_dlc;
+
+#if !defined(WITHOUT_COM_DEBUG) && (LOGLEVEL >= LOGLEVEL_DEBUG)
+	print_frame("->", frame);
+#endif
+
+	return 1;
+}
+
+static int can_tx(int sock, const CanardCANFrame *frame)
+{
+	struct can_frame msg;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.can_id = frame->id & (~(CANARD_CAN_FRAME_EFF | CANARD_CAN_FRAME_ERR |
+				    CANARD_CAN_FRAME_RTR));
+	if (frame->id & CANARD_CAN_FRAME_EFF) {
+		msg.can_id |= CAN_EFF_FLAG;
+	}
+	if (frame->id & CANARD_CAN_FRAME_RTR) {
+		msg.can_id |= CAN_RTR_FLAG;
+	}
+
+	if (frame->data_len > sizeof(msg.data)) {
+		log_error("Canard frame too big (%u > %lu)!", frame->data_len,
+			  sizeof(msg.data));
+		return UAVCAN_CAN_TX_INVALID;
+	}
+
+	memcpy(msg.data, frame->data, frame->data_len);
+	msg.can_dlc = frame->data_len;
+
+	if (write(sock, &msg, sizeof(msg)) != sizeof(msg)) {
+		// socket TX queue full => try again later
+		if (errno == EAGAIN || errno == ENOBUFS) {
+			return UAVCAN_CAN_TX_BUSY;
+		}
+		log_error("CAN TX error: %s", strerror(errno));
+		return -2;
+	}
+
+#if !defined(WITHOUT_COM_DEBUG) && (LOGLEVEL >= LOGLEVEL_DEBUG)
+	print_frame("<-", frame);
+#endif
+
+	ui_can_tx();
+
+	return 0;
+}
+
+int uavcan_can_rx(CanardCANFrame *frame, uint64_t *timestamp_usec)
+{
+	return can_rx(can_socks[0], frame);
+}
+
+int uavcan_can_tx(const CanardCANFrame *frame)
+{
+	return can_tx(can_socks[0], frame);
+}
+
+#if UAVCAN_CAN_IFACES > 1
+int uavcan_can_iface_rx(uint8_t iface, CanardCANFrame *frame,
+			uint64_t *timestamp_usec)
+{
+	return can_rx(can_socks[iface], frame);
+}
+
+int uavcan_can_iface_tx(uint8_t iface, const CanardCANFrame *frame)
+{
+	return can_tx(can_socks[iface], frame);
+}
+#endif
+#endif // ifdef WITH_CAN
+
+// ---------------------------------------------- wifi -------------------------
+
+#ifdef WITH_WIFI
+
+// host is expected to be connected already
+int wifi_init()
+{
+	ui_wifi_ok(true);
+	return 0;
+}
+
+#endif // ifdef WITH_WIFI
+
+// ---------------------------------------------- MQTT -------------------------
+
+#ifdef WITH_MQTT
+
+// There's no MQTT client on host, published messages are just printed.
+int mqtt_init()
+{
+	ui_mqtt_ok(true);
+	return 0;
+}
+
+int mqtt_publish5(const char *topic, const char *data, int data_len, int qos,
+		  int retain)
+{
+	if (data_len == 0) {
+		data_len = strlen(data);
+	}
+	PRINTF("MQTT<- %s: %.*s\n", topic, data_len, data);
+	return 0;
+}
+
+int mqtt_publish(const char *topic, const char *data, int data_len)
+{
+	return mqtt_publish5(topic, data, data_len, 0, 0);
+}
+
+#endif // ifdef WITH_MQTT
+
+// ---------------------------------------------- storage ----------------------
+
+// Every key is a file in POSIX_STORAGE_DIR (STORAGE_DIR env var overrides it).
+static void storage_path(char *path, size_t size, const char *key)
+{
+	const char *dir = getenv("STORAGE_DIR");
+
+	if (dir == NULL) {
+		dir = POSIX_STORAGE_DIR;
+	}
+	snprintf(path, size, "%s/%s", dir, key);
+}
+
+int hal_storage_load(const char *key, void *buff, size_t len)
+{
+	char path[256];
+
+	storage_path(path, sizeof(path), key);
+	FILE *f = fopen(path, "rb");
+	if (f == NULL) {
+		return -1;
+	}
+	// one more byte to find out the value is too long
+	char extra;
+	size_t read = fread(buff, 1, len, f);
+	bool longer = fread(&extra, 1, 1, f) == 1;
+	fclose(f);
+
+	return longer ? -1 : (int)read;
+}
+
+int hal_storage_save(const char *key, const void *data, size_t len)
+{
+	char path[256];
+
+	storage_path(path, sizeof(path), key);
+	FILE *f = fopen(path, "wb");
+	if (f == NULL) {
+		log_error("Can't write %s: %s", path, strerror(errno));
+		return -1;
+	}
+	size_t written = fwrite(data, 1, len, f);
+	if (fclose(f) != 0 || written != len) {
+		return -1;
+	}
+	return 0;
+}
+
+int hal_storage_erase(const char *key)
+{
+	char path[256];
+
+	storage_path(path, sizeof(path), key);
+	return (unlink(path) == 0 || errno == ENOENT) ? 0 : -1;
+}
+
+// ---------------------------------------------- misc -------------------------
+
+static uint64_t boot_usec;
+
+static uint64_t monotonic_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+// uptime must be counted from process start, not from host boot
+__attribute__((constructor)) static void init_boot_time(void)
+{
+	boot_usec = monotonic_usec();
+}
+
+void hal_restart(void)
+{
+	execl("/proc/self/exe", "/proc/self/exe", (char *)NULL);
+	// exec failed, let the supervisor do the job
+	exit(EXIT_FAILURE);
+}
+
+void die(uint8_t reason)
+{
+	PRINTF("\n\nDYING BECAUSE %d\n\n", reason);
+	exit(EXIT_FAILURE);
+}
+
+uint64_t hal_uptime_usec()
+{
+	return monotonic_usec() - boot_usec;
+}
+
+uint32_t hal_uptime_msec()
+{
+	return hal_uptime_usec() / 1000;
+}
+
+#endif // ifdef POSIX
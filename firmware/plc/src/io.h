@@ -5,6 +5,12 @@
 #define IO_HW_ERROR 1
 #define IO_DOES_NOT_EXIST 2
 
+// number of points usable in constant expressions (app_config.h needed)
+#define IO_DIS_NUM (sizeof((const uint8_t[])DIS_PINS))
+#define IO_AIS_NUM (sizeof((const uint8_t[])AIS_PINS) + VIRT_AIS_NUM)
+#define IO_DOS_NUM (sizeof((const uint8_t[])DOS_PINS))
+#define IO_AOS_NUM (sizeof((const uint8_t[])AOS_PINS))
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -1,3 +1,4 @@
+#include "app_config.h"
 #include "locks.h"
 
 EventGroupHandle_t global_event_group;
@@ -10,3 +11,35 @@ int locks_init()
 
 	return 0;
 }
+
+// ---------------------------------------------- triple buffer ----------------
+
+// middle buffer was published and not acquired yet
+#define TBUF_FRESH 0x80
+
+void tbuf_init(tbuf_t *tb)
+{
+	tb->back = 0;
+	tb->middle = 1;
+	tb->front = 2;
+}
+
+uint8_t tbuf_publish(tbuf_t *tb)
+{
+	uint8_t old = __atomic_exchange_n(&tb->middle, tb->back | TBUF_FRESH,
+					  __ATOMIC_ACQ_REL);
+
+	tb->back = old & ~TBUF_FRESH;
+	return tb->back;
+}
+
+uint8_t tbuf_acquire(tbuf_t *tb)
+{
+	if (__atomic_load_n(&tb->middle, __ATOMIC_ACQUIRE) & TBUF_FRESH) {
+		tb->front = __atomic_exchange_n(&tb->middle, tb->front,
+						__ATOMIC_ACQ_REL) &
+			    ~TBUF_FRESH;
+	}
+
+	return tb->front;
+}
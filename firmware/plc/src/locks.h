@@ -1,6 +1,13 @@
+#include <stdint.h>
+
 #ifdef ESP32
 #include <freertos/FreeRTOS.h>
 #include <freertos/event_groups.h>
+#include <freertos/semphr.h>
+#endif
+
+#ifdef POSIX
+#include "rtos_posix.h"
 #endif
 
 #ifdef __cplusplus
@@ -24,6 +31,35 @@ int locks_init(void);
 	  (bits)) == (bits))
 #define IS_BIT_SET(bit) (xEventGroupGetBits(global_event_group) & (bit))
 
+// ---------------------------------------------- triple buffer ----------------
+
+/*
+Lock-free exchange of data from one writer task to one reader task, neither of
+them ever blocks or retries. The data itself is kept by the user in an array of
+3 buffers, tbuf_t just tells which of them belongs to whom:
+
+    my_data_t data[3];
+    tbuf_t tb;
+
+    // writer
+    fill(&data[tb.back]); // whole buffer, it's not the last published one
+    tbuf_publish(&tb);
+
+    // reader
+    use(&data[tbuf_acquire(&tb)]);
+*/
+typedef struct {
+	uint8_t back; // writer's buffer
+	uint8_t front; // reader's buffer
+	uint8_t middle; // last published buffer (+ TBUF_FRESH flag)
+} tbuf_t;
+
+void tbuf_init(tbuf_t *tb);
+// writer: make `back` buffer available to reader, returns new `back`
+uint8_t tbuf_publish(tbuf_t *tb);
+// reader: get the most recently published buffer
+uint8_t tbuf_acquire(tbuf_t *tb);
+
 #ifdef __cplusplus
 }
 #endif
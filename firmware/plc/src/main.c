@@ -2,7 +2,9 @@
 #include "hal.h"
 #include "io.h"
 #include "locks.h"
+#include "params.h"
 #include "plc.h"
+#include "stats.h"
 #include "tools.h"
 #include "ui.h"
 #include "uavcan_impl.h"
@@ -10,6 +12,9 @@
 static void main_init();
 static void main_task(void *pvParameters);
 
+// main task wakes up this often to do background work [ms]
+#define MAIN_TASK_PERIOD 100
+
 #define START(lbl, init_fun)                                                   \
 	{                                                                      \
 		ui_set_status(lbl);                                            \
@@ -58,10 +63,29 @@ static void main_init()
 
 static void main_task(void *pvParameters)
 {
-	TickType_t delay = portMAX_DELAY;
+#if defined(WITH_MQTT) && MQTT_STATS_PERIOD > 0
+	static char stats_json[MQTT_STATS_MAX_LEN];
+#endif
 
 	for (;;) {
-		vTaskDelay(pdMS_TO_TICKS(delay));
+		vTaskDelay(pdMS_TO_TICKS(MAIN_TASK_PERIOD));
+
+		// storage writes may take tens of ms, keep them out of PLC and
+		// UAVCAN tasks
+		params_update();
+
+#if defined(WITH_MQTT) && MQTT_STATS_PERIOD > 0
+		MAX_ONCE_PER(MQTT_STATS_PERIOD, {
+			int len = plc_stats_to_json(stats_json,
+						    sizeof(stats_json));
+			if (len >= (int)sizeof(stats_json)) {
+				log_error("stats JSON too long (%d)", len);
+			} else {
+				mqtt_publish(MQTT_STATS_TOPIC, stats_json,
+					     len);
+			}
+		});
+#endif
 	}
 }
 
@@ -73,3 +97,13 @@ void app_main()
 	die(DEATH_UNREACHABLE_REACHED);
 }
 #endif // ifdef ESP32
+
+#ifdef POSIX
+int main()
+{
+	main_init();
+	main_task(NULL);
+	die(DEATH_UNREACHABLE_REACHED);
+	return 0;
+}
+#endif // ifdef POSIX
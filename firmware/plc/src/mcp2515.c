@@ -0,0 +1,396 @@
+#include "app_config.h"
+#if defined(ESP32) && defined(WITH_CAN)
+
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <driver/spi_master.h>
+
+#include <uavcan_node.h>
+
+#include "hal.h"
+#include "mcp2515.h"
+
+// ---------------------------------------------- registers --------------------
+
+// SPI instructions
+#define INSTR_RESET 0xC0
+#define INSTR_READ 0x03
+#define INSTR_WRITE 0x02
+#define INSTR_BIT_MODIFY 0x05
+#define INSTR_READ_STATUS 0xA0
+#define INSTR_LOAD_TXB0 0x40 // from TXB0SIDH
+#define INSTR_RTS_TXB0 0x81
+#define INSTR_READ_RXB0 0x90 // from RXB0SIDH, clears RX0IF
+#define INSTR_READ_RXB1 0x94 // from RXB1SIDH, clears RX1IF
+
+// READ STATUS bits
+#define STATUS_TXB0_TXREQ 0x04
+
+#define REG_RXF0SIDH 0x00 // RXF0-2 at 0x00, 0x04, 0x08
+#define REG_RXF3SIDH 0x10 // RXF3-5 at 0x10, 0x14, 0x18
+#define REG_CANSTAT 0x0E
+#define REG_CANCTRL 0x0F
+#define REG_RXM0SIDH 0x20
+#define REG_RXM1SIDH 0x24
+#define REG_CNF3 0x28 // CNF3, CNF2, CNF1 follow
+#define REG_CANINTE 0x2B
+#define REG_CANINTF 0x2C
+#define REG_EFLG 0x2D
+#define REG_TXB0CTRL 0x30
+#define REG_RXB0CTRL 0x60
+#define REG_RXB1CTRL 0x70
+
+#define MODE_MASK 0xE0 // CANCTRL.REQOP, CANSTAT.OPMOD
+#define MODE_NORMAL 0x00
+#define MODE_CONFIG 0x80
+
+#define TXREQ 0x08 // TXBnCTRL
+
+#define CANINTF_RX0IF 0x01
+#define CANINTF_RX1IF 0x02
+
+#define RXM_ANY 0x60 // RXBnCTRL: filters off, receive any frame
+#define BUKT 0x04 // RXB0CTRL: roll over to RXB1 when RXB0 is full
+
+#define EFLG_RX0OVR 0x40
+#define EFLG_RX1OVR 0x80
+#define EFLG_TXBO 0x20
+#define EFLG_TXEP 0x10
+#define EFLG_RXEP 0x08
+
+// SIDL
+#define EXIDE 0x08
+#define SRR 0x10
+// DLC
+#define RTR 0x40
+
+/*
+Bit timing: 16 time quanta per bit, sync 1 + propagation 5 + phase 1 7 =
+sample point at 81 % as with the internal controller, phase 2 3, SJW 1.
+*/
+#define BITRATE 250000
+#define TQ_PER_BIT 16
+#if MCP2515_OSC_HZ % (2 * TQ_PER_BIT * BITRATE)
+#error "MCP2515_OSC_HZ gives no exact 250 kbit/s"
+#endif
+#define BRP (MCP2515_OSC_HZ / (2 * TQ_PER_BIT * BITRATE) - 1)
+#define CNF1 BRP // SJW 1
+#define CNF2 (0x80 | (7 - 1) << 3 | (5 - 1)) // BTLMODE, PHSEG1, PRSEG
+#define CNF3 (3 - 1) // PHSEG2
+
+volatile can_bus_state_t mcp2515_bus_state = CANBS_ERR_ACTIVE;
+volatile uint32_t mcp2515_rx_overflows;
+
+static spi_device_handle_t spi;
+// the last EFLG read
+static uint8_t eflg;
+
+// ---------------------------------------------- SPI --------------------------
+
+static int transfer(const uint8_t *tx, uint8_t *rx, size_t len)
+{
+	spi_transaction_t t;
+
+	memset(&t, 0, sizeof(t));
+	t.length = len * 8;
+	t.tx_buffer = tx;
+	t.rx_buffer = rx;
+	return spi_device_transmit(spi, &t) == ESP_OK ? 0 : -1;
+}
+
+static int write_regs(uint8_t addr, const uint8_t *values, uint8_t len)
+{
+	uint8_t buf[2 + 4];
+
+	buf[0] = INSTR_WRITE;
+	buf[1] = addr;
+	memcpy(&buf[2], values, len);
+	return transfer(buf, NULL, 2 + len);
+}
+
+static int write_reg(uint8_t addr, uint8_t value)
+{
+	return write_regs(addr, &value, 1);
+}
+
+static int read_regs(uint8_t addr, uint8_t *values, uint8_t len)
+{
+	uint8_t tx[2 + 2] = { INSTR_READ, addr };
+	uint8_t rx[2 + 2];
+
+	if (transfer(tx, rx, 2 + len)) {
+		return -1;
+	}
+	memcpy(values, &rx[2], len);
+	return 0;
+}
+
+static int bit_modify(uint8_t addr, uint8_t mask, uint8_t value)
+{
+	uint8_t buf[] = { INSTR_BIT_MODIFY, addr, mask, value };
+
+	return transfer(buf, NULL, sizeof(buf));
+}
+
+// ---------------------------------------------- frames -----------------------
+
+// SIDH, SIDL, EID8, EID0 of TX buffers, filters and masks
+static void id_to_regs(uint32_t id, bool extended, uint8_t *regs)
+{
+	if (extended) {
+		regs[0] = id >> 21;
+		regs[1] = ((id >> 13) & 0xE0) | EXIDE | ((id >> 16) & 0x03);
+		regs[2] = id >> 8;
+		regs[3] = id;
+	} else {
+		regs[0] = id >> 3;
+		regs[1] = (id & 0x07) << 5;
+		regs[2] = 0;
+		regs[3] = 0;
+	}
+}
+
+static uint32_t regs_to_id(const uint8_t *regs)
+{
+	uint32_t id = ((uint32_t)regs[0] << 3) | (regs[1] >> 5);
+
+	if (regs[1] & EXIDE) {
+		id = (id << 18) | ((uint32_t)(regs[1] & 0x03) << 16) |
+		     ((uint32_t)regs[2] << 8) | regs[3];
+		id |= CANARD_CAN_FRAME_EFF;
+		if (regs[4] & RTR) {
+			id |= CANARD_CAN_FRAME_RTR;
+		}
+	} else if (regs[1] & SRR) {
+		id |= CANARD_CAN_FRAME_RTR;
+	}
+	return id;
+}
+
+static void update_bus_state(uint8_t eflg)
+{
+	can_bus_state_t state = CANBS_ERR_ACTIVE;
+
+	if (eflg & EFLG_TXBO) {
+		state = CANBS_BUS_OFF;
+	} else if (eflg & (EFLG_TXEP | EFLG_RXEP)) {
+		state = CANBS_ERR_PASSIVE;
+	}
+	if (state == mcp2515_bus_state) {
+		return;
+	}
+	// the controller recovers from bus off by itself (128 x 11 recessive
+	// bits), unlike the internal one
+	switch (state) {
+	case CANBS_ERR_ACTIVE:
+		log_info("CAN2: entered error active state");
+		break;
+	case CANBS_ERR_PASSIVE:
+		log_error("CAN2: entered error passive state");
+		break;
+	case CANBS_BUS_OFF:
+		log_error("CAN2: entered bus off state");
+		break;
+	}
+	mcp2515_bus_state = state;
+}
+
+// ---------------------------------------------- API --------------------------
+
+// RXB0 has mask 0 and filters 0-1, RXB1 mask 1 and filters 2-5 => one planned
+// filter per RX buffer
+static int set_filters(void)
+{
+	uavcan_can_filter_t filters[2];
+	uint8_t regs[4];
+	uint8_t len = uavcan_plan_filters(filters, 2);
+
+	if (len == 0) {
+		if (write_reg(REG_RXB0CTRL, RXM_ANY | BUKT) ||
+		    write_reg(REG_RXB1CTRL, RXM_ANY)) {
+			return -1;
+		}
+		return 0;
+	}
+	if (len == 1) {
+		filters[1] = filters[0];
+	}
+
+	id_to_regs(filters[0].mask, true, regs);
+	if (write_regs(REG_RXM0SIDH, regs, 4)) {
+		return -1;
+	}
+	id_to_regs(filters[1].mask, true, regs);
+	if (write_regs(REG_RXM1SIDH, regs, 4)) {
+		return -1;
+	}
+	for (uint8_t i = 0; i < 6; i++) {
+		uint8_t addr = i < 3 ? REG_RXF0SIDH + 4 * i :
+				       REG_RXF3SIDH + 4 * (i - 3);
+		id_to_regs(filters[i < 2 ? 0 : 1].id, true, regs);
+		if (write_regs(addr, regs, 4)) {
+			return -1;
+		}
+	}
+	if (write_reg(REG_RXB0CTRL, BUKT) || write_reg(REG_RXB1CTRL, 0)) {
+		return -1;
+	}
+	return 0;
+}
+
+static int set_mode(uint8_t mode)
+{
+	uint8_t canstat;
+
+	if (write_reg(REG_CANCTRL, mode)) {
+		return -1;
+	}
+	for (uint8_t i = 0; i < 10; i++) {
+		if (read_regs(REG_CANSTAT, &canstat, 1)) {
+			return -1;
+		}
+		if ((canstat & MODE_MASK) == mode) {
+			return 0;
+		}
+		vTaskDelay(pdMS_TO_TICKS(1));
+	}
+	return -2;
+}
+
+int mcp2515_init(void)
+{
+	spi_bus_config_t bus_config = {
+		.mosi_io_num = MCP2515_MOSI_PIN,
+		.miso_io_num = MCP2515_MISO_PIN,
+		.sclk_io_num = MCP2515_SCK_PIN,
+		.quadwp_io_num = -1,
+		.quadhd_io_num = -1,
+	};
+	spi_device_interface_config_t dev_config = {
+		.clock_speed_hz = MCP2515_SPI_CLOCK,
+		.mode = 0,
+		.spics_io_num = MCP2515_CS_PIN,
+		.queue_size = 1,
+	};
+	const uint8_t reset = INSTR_RESET;
+	const uint8_t cnf[] = { CNF3, CNF2, CNF1 };
+	uint8_t canstat;
+
+	// no DMA, transfers are 14 bytes max.
+	if (spi_bus_initialize(MCP2515_SPI_HOST, &bus_config, 0) != ESP_OK ||
+	    spi_bus_add_device(MCP2515_SPI_HOST, &dev_config, &spi) != ESP_OK) {
+		log_error("MCP2515: SPI init failed");
+		return -1;
+	}
+
+	// the controller is in configuration mode after reset
+	if (transfer(&reset, NULL, 1)) {
+		return -2;
+	}
+	vTaskDelay(pdMS_TO_TICKS(10));
+	if (read_regs(REG_CANSTAT, &canstat, 1) ||
+	    (canstat & MODE_MASK) != MODE_CONFIG) {
+		log_error("MCP2515: not found");
+		return -3;
+	}
+
+	// polled, no interrupts
+	if (write_regs(REG_CNF3, cnf, sizeof(cnf)) ||
+	    write_reg(REG_CANINTE, 0) || set_filters()) {
+		return -4;
+	}
+
+	if (set_mode(MODE_NORMAL)) {
+		log_error("MCP2515: failed to enter normal mode");
+		return -5;
+	}
+	return 0;
+}
+
+/*
+Only TXB0 is used. The controller sends pending buffers of equal priority from
+the highest number, so frames of a multi-frame transfer would be reordered.
+*/
+int mcp2515_tx(const CanardCANFrame *frame)
+{
+	uint8_t cmd[] = { INSTR_READ_STATUS, 0 };
+	uint8_t status[2];
+	uint8_t buf[1 + 5 + CANARD_CAN_FRAME_MAX_DATA_LEN];
+
+	if (frame->data_len > CANARD_CAN_FRAME_MAX_DATA_LEN) {
+		return UAVCAN_CAN_TX_INVALID;
+	}
+	if (transfer(cmd, status, sizeof(cmd))) {
+		return -2;
+	}
+	if (status[1] & STATUS_TXB0_TXREQ) {
+		// No ACK (cut bus, no other node) makes the controller TX error
+		// passive and retransmit forever, give up the frame then.
+		if (eflg & (EFLG_TXEP | EFLG_TXBO)) {
+			bit_modify(REG_TXB0CTRL, TXREQ, 0);
+			return -2;
+		}
+		return UAVCAN_CAN_TX_BUSY;
+	}
+	if (eflg & EFLG_TXBO) {
+		return -2;
+	}
+
+	buf[0] = INSTR_LOAD_TXB0;
+	id_to_regs(frame->id & CANARD_CAN_EXT_ID_MASK,
+		   frame->id & CANARD_CAN_FRAME_EFF, &buf[1]);
+	buf[5] = frame->data_len;
+	if (frame->id & CANARD_CAN_FRAME_RTR) {
+		buf[5] |= RTR;
+	}
+	memcpy(&buf[6], frame->data, frame->data_len);
+	if (transfer(buf, NULL, 6 + frame->data_len)) {
+		return -2;
+	}
+
+	const uint8_t rts = INSTR_RTS_TXB0;
+	if (transfer(&rts, NULL, 1)) {
+		return -2;
+	}
+	return UAVCAN_CAN_TX_OK;
+}
+
+int mcp2515_rx(CanardCANFrame *frame)
+{
+	uint8_t flags[2]; // CANINTF, EFLG
+	uint8_t tx[1 + 5 + CANARD_CAN_FRAME_MAX_DATA_LEN] = { 0 };
+	uint8_t rx[sizeof(tx)];
+
+	if (read_regs(REG_CANINTF, flags, 2)) {
+		return 0;
+	}
+	eflg = flags[1];
+	update_bus_state(eflg);
+	if (flags[1] & (EFLG_RX0OVR | EFLG_RX1OVR)) {
+		mcp2515_rx_overflows++;
+		bit_modify(REG_EFLG, EFLG_RX0OVR | EFLG_RX1OVR, 0);
+	}
+
+	if (flags[0] & CANINTF_RX0IF) {
+		tx[0] = INSTR_READ_RXB0;
+	} else if (flags[0] & CANINTF_RX1IF) {
+		tx[0] = INSTR_READ_RXB1;
+	} else {
+		return 0;
+	}
+	if (transfer(tx, rx, sizeof(tx))) {
+		return 0;
+	}
+
+	frame->id = regs_to_id(&rx[1]);
+	frame->data_len = rx[5] & 0x0F;
+	if (frame->data_len > CANARD_CAN_FRAME_MAX_DATA_LEN) {
+		frame->data_len = CANARD_CAN_FRAME_MAX_DATA_LEN;
+	}
+	memcpy(frame->data, &rx[6], frame->data_len);
+	return 1;
+}
+
+#endif // if defined(ESP32) && defined(WITH_CAN)
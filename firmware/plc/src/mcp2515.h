@@ -0,0 +1,31 @@
+#include "app_config.h"
+#if defined(ESP32) && defined(WITH_CAN)
+
+#include <canard.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// MCP2515 CAN controller on SPI, the second (redundant) CAN interface of ESP32
+// PLC. It runs at the same bit rate as the internal controller (250 kbit/s)
+// and is polled, INT pin is not used. Not thread safe, used by UAVCAN task
+// only.
+
+// Set the controller up with filters planned by uavcan_plan_filters(), so
+// it must not be called before uavcan_init().
+int mcp2515_init(void);
+// same as uavcan_can_tx()/uavcan_can_rx()
+int mcp2515_tx(const CanardCANFrame *frame);
+int mcp2515_rx(CanardCANFrame *frame);
+
+// updated by mcp2515_rx()
+extern volatile can_bus_state_t mcp2515_bus_state;
+// frames lost for full RX buffers
+extern volatile uint32_t mcp2515_rx_overflows;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
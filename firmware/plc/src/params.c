@@ -0,0 +1,325 @@
+#include <string.h>
+
+#include "app_config.h"
+#include "hal.h"
+#include "params.h"
+#include "tools.h"
+
+#if UAVCAN_WITH_PARAM_GETSET
+#include <uavcan_node.h>
+#endif
+
+// registered parameters sorted by name
+static const param_t *params[PARAMS_MAX];
+static uint8_t params_len = 0;
+
+// persistent parameters changed since the last save
+static bool dirty = false;
+static uint32_t last_change = 0;
+
+// ---------------------------------------------- storage ----------------------
+
+#define STORAGE_KEY "params"
+
+// Values are stored with hashes of their names, so parameters can be added,
+// removed or reordered by a firmware update. Unknown values are ignored.
+typedef struct {
+	uint32_t name_hash;
+	uint32_t value;
+} stored_param_t;
+
+// FNV-1a
+static uint32_t name_hash(const char *name)
+{
+	uint32_t hash = 2166136261UL;
+
+	while (*name) {
+		hash ^= (uint8_t)*name++;
+		hash *= 16777619UL;
+	}
+	return hash;
+}
+
+static uint8_t load_stored(stored_param_t *stored)
+{
+	int len = hal_storage_load(STORAGE_KEY, stored,
+				   PARAMS_MAX * sizeof(stored_param_t));
+
+	if (len < 0 || len % sizeof(stored_param_t) != 0) {
+		return 0;
+	}
+	return len / sizeof(stored_param_t);
+}
+
+int params_save(void)
+{
+	stored_param_t stored[PARAMS_MAX];
+	uint8_t len = 0;
+
+	// set again by a change made while saving
+	dirty = false;
+	for (uint8_t i = 0; i < params_len; i++) {
+		if (params[i]->flags & PARAM_PERSISTENT) {
+			stored[len].name_hash = name_hash(params[i]->name);
+			stored[len].value = params_value(params[i]);
+			len++;
+		}
+	}
+	if (hal_storage_save(STORAGE_KEY, stored,
+			     len * sizeof(stored_param_t))) {
+		log_error("Failed to store parameters");
+		return -1;
+	}
+	return 0;
+}
+
+int params_erase(void)
+{
+	dirty = false;
+	return hal_storage_erase(STORAGE_KEY);
+}
+
+void params_update(void)
+{
+#if PARAMS_SAVE_DELAY > 0
+	if (dirty && hal_uptime_msec() - last_change >= PARAMS_SAVE_DELAY) {
+		params_save();
+	}
+#endif
+}
+
+// ---------------------------------------------- registry ---------------------
+
+static void value_write(const param_t *param, uint32_t value)
+{
+	switch (param->type) {
+	case PARAM_BOOL:
+		*(bool *)param->value = value;
+		break;
+	case PARAM_U8:
+		*(uint8_t *)param->value = value;
+		break;
+	case PARAM_U16:
+		*(uint16_t *)param->value = value;
+		break;
+	case PARAM_U32:
+		*(uint32_t *)param->value = value;
+		break;
+	}
+}
+
+uint32_t params_value(const param_t *param)
+{
+	if (param->value == NULL) {
+		return param->get(param);
+	}
+	switch (param->type) {
+	case PARAM_BOOL:
+		return *(bool *)param->value;
+	case PARAM_U8:
+		return *(uint8_t *)param->value;
+	case PARAM_U16:
+		return *(uint16_t *)param->value;
+	default:
+		return *(uint32_t *)param->value;
+	}
+}
+
+// stored value if there's a valid one, default otherwise
+static uint32_t stored_value(const param_t *param,
+			     const stored_param_t *stored, uint8_t stored_len)
+{
+	uint32_t hash = name_hash(param->name);
+
+	if (!(param->flags & PARAM_PERSISTENT)) {
+		return param->def;
+	}
+	for (uint8_t i = 0; i < stored_len; i++) {
+		if (stored[i].name_hash == hash &&
+		    stored[i].value >= param->min &&
+		    stored[i].value <= param->max) {
+			return stored[i].value;
+		}
+	}
+	return param->def;
+}
+
+int params_register(const param_t *table, uint8_t len)
+{
+	stored_param_t stored[PARAMS_MAX];
+	uint8_t stored_len = load_stored(stored);
+
+	if (params_len + len > PARAMS_MAX) {
+		log_error("Too many parameters, increase PARAMS_MAX");
+		return -1;
+	}
+
+	for (uint8_t i = 0; i < len; i++) {
+		const param_t *param = &table[i];
+
+		if (param->value != NULL) {
+			value_write(param, stored_value(param, stored,
+							stored_len));
+		}
+
+		// insertion keeps them sorted by name
+		uint8_t j = params_len++;
+		while (j > 0 && strcmp(params[j - 1]->name, param->name) > 0) {
+			params[j] = params[j - 1];
+			j--;
+		}
+		params[j] = param;
+	}
+	return 0;
+}
+
+uint8_t params_count(void)
+{
+	return params_len;
+}
+
+const param_t *params_get(uint8_t index)
+{
+	return (index < params_len) ? params[index] : NULL;
+}
+
+int16_t params_find(const char *name, uint8_t len)
+{
+	int16_t low = 0;
+	int16_t high = params_len - 1;
+
+	while (low <= high) {
+		int16_t mid = (low + high) / 2;
+		const char *mid_name = params[mid]->name;
+		int cmp = strncmp(mid_name, name, len);
+
+		if (cmp == 0 && mid_name[len] != '\0') {
+			cmp = 1; // longer name, `name` is its prefix
+		}
+		if (cmp == 0) {
+			return mid;
+		}
+		if (cmp < 0) {
+			low = mid + 1;
+		} else {
+			high = mid - 1;
+		}
+	}
+	return -1;
+}
+
+bool params_set(const param_t *param, uint32_t value)
+{
+	if (param->value == NULL || (param->flags & PARAM_READ_ONLY)) {
+		// computed parameters just act
+		if (param->on_set == NULL) {
+			return false;
+		}
+		param->on_set(param);
+		return true;
+	}
+	if (value < param->min || value > param->max) {
+		return false;
+	}
+
+	if (value != params_value(param)) {
+		value_write(param, value);
+		if (param->flags & PARAM_PERSISTENT) {
+			dirty = true;
+			last_change = hal_uptime_msec();
+		}
+	}
+	if (param->on_set != NULL) {
+		param->on_set(param);
+	}
+	return true;
+}
+
+// ---------------------------------------------- UAVCAN callbacks -------------
+
+#if UAVCAN_WITH_PARAM_GETSET
+
+static void value_to_uavcan(const param_t *param, uint32_t value,
+			    uavcan_protocol_param_Value *out)
+{
+	if (param->type == PARAM_BOOL) {
+		out->union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_BOOLEAN_VALUE;
+		out->boolean_value = value;
+	} else {
+		out->union_tag = UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE;
+		out->integer_value = value;
+	}
+}
+
+static void limit_to_uavcan(uint32_t value,
+			    uavcan_protocol_param_NumericValue *out)
+{
+	out->union_tag = UAVCAN_PROTOCOL_PARAM_NUMERICVALUE_INTEGER_VALUE;
+	out->integer_value = value;
+}
+
+bool uavcan_param_get(uint16_t index,
+		      uavcan_protocol_param_GetSetResponse *resp)
+{
+	const param_t *param = params_get(index);
+
+	if (param == NULL) {
+		return false;
+	}
+
+	value_to_uavcan(param, params_value(param), &resp->value);
+	if (param->value != NULL) {
+		value_to_uavcan(param, param->def, &resp->default_value);
+	}
+	if (param->value != NULL && param->type != PARAM_BOOL) {
+		limit_to_uavcan(param->min, &resp->min_value);
+		limit_to_uavcan(param->max, &resp->max_value);
+	}
+	resp->name.data = (uint8_t *)param->name;
+	resp->name.len = strlen(param->name);
+
+	return true;
+}
+
+bool uavcan_param_set(uint16_t index, const uavcan_protocol_param_Value *value)
+{
+	const param_t *param = params_get(index);
+	int64_t v;
+
+	if (param == NULL) {
+		return false;
+	}
+
+	switch (value->union_tag) {
+	case UAVCAN_PROTOCOL_PARAM_VALUE_BOOLEAN_VALUE:
+		v = value->boolean_value;
+		break;
+	case UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE:
+		v = value->integer_value;
+		break;
+	default:
+		return false;
+	}
+	if (v < 0 || v > UINT32_MAX) {
+		return false;
+	}
+	return params_set(param, v);
+}
+
+int16_t uavcan_param_find(const uint8_t *name, uint8_t len)
+{
+	return params_find((const char *)name, len);
+}
+
+bool uavcan_param_execute(uint8_t opcode)
+{
+	switch (opcode) {
+	case UAVCAN_PROTOCOL_PARAM_EXECUTEOPCODE_REQUEST_OPCODE_SAVE:
+		return params_save() == 0;
+	case UAVCAN_PROTOCOL_PARAM_EXECUTEOPCODE_REQUEST_OPCODE_ERASE:
+		return params_erase() == 0;
+	}
+	return false;
+}
+
+#endif // UAVCAN_WITH_PARAM_GETSET
@@ -0,0 +1,62 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+Parameters registry. Modules register tables of their parameters at init, the
+registry serves them over UAVCAN (uavcan.protocol.param.GetSet, ExecuteOpcode)
+and keeps persistent ones in storage (key "params"). Parameters are indexed in
+name order.
+*/
+
+typedef enum {
+	PARAM_BOOL, // bool
+	PARAM_U8, // uint8_t
+	PARAM_U16, // uint16_t
+	PARAM_U32, // uint32_t
+} param_type_t;
+
+// value is saved to storage and loaded when registered
+#define PARAM_PERSISTENT 0x01
+// value can't be set, setting a computed parameter just calls on_set()
+#define PARAM_READ_ONLY 0x02
+
+typedef struct param {
+	const char *name;
+	uint8_t type;
+	uint8_t flags;
+	// variable of `type`, NULL for a computed parameter (see get)
+	void *value;
+	uint32_t def;
+	uint32_t min;
+	uint32_t max;
+	// value of a computed parameter
+	uint32_t (*get)(const struct param *param);
+	// called after a set request, NULL if nothing is to be done
+	void (*on_set)(const struct param *param);
+} param_t;
+
+// Register `len` parameters (the table must stay valid), variables are set to
+// their stored or default values.
+int params_register(const param_t *params, uint8_t len);
+// Save persistent parameters now, returns 0 on success.
+int params_save(void);
+// Erase stored values, defaults are used after restart.
+int params_erase(void);
+// Save changed parameters PARAMS_SAVE_DELAY after the last change, call it
+// periodically.
+void params_update(void);
+
+uint8_t params_count(void);
+const param_t *params_get(uint8_t index);
+int16_t params_find(const char *name, uint8_t len);
+uint32_t params_value(const param_t *param);
+// returns false if the parameter is read-only or `value` is out of range
+bool params_set(const param_t *param, uint32_t value);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,3 +1,5 @@
+#include <string.h>
+
 #include <iec_std_lib.h>
 
 #include <uavcan_node.h> // node status constants
@@ -7,20 +9,111 @@
 #include "io.h"
 #include "locks.h"
 #include "plc.h"
+#include "stats.h"
 #include "ui.h"
+#include "IEC_TASKS.h" // generated by iec_tasks.py, see "IEC tasks"
+
+#ifdef IEC_TASKS_NUM
+#include <POUS.h>
+#endif
+
+// ---------------------------------------------- IEC tasks --------------------
+
+/*
+Every TASK of the PLC program runs in its own FreeRTOS task, so a fast control
+loop isn't delayed by a slow program. A task runs at its INTERVAL with
+TASK_PRIORITY_PLC lowered by its PRIORITY (0 is the highest IEC priority,
+PLC_TASK_PRIORITY_LEVELS levels are used). Each cycle it reads inputs used by
+its programs, runs them and writes their outputs, see update_inputs().
+
+The tasks are listed in IEC_TASKS.h generated from matiec output by
+iec_tasks.py (matiec itself runs all of them from one config_run__() call).
+With no list, e.g. when a task isn't periodic, the whole configuration runs in
+one task at common_ticktime__ as matiec schedules it.
+
+The task with the shortest interval (primary) keeps the PLC clock, UI and scan
+statistics. Every task copies the clock at the start of its cycle and its
+programs see that copy as __CURRENT_TIME (see plc_current_time()), so the time
+is consistent within the cycle and never read while being updated.
+
+NOTE: variables shared by programs of different tasks (globals) are not
+locked, exchange multi-word values by a handshake.
+*/
 
-// "exported" to Matiec-compiled PLC program
-IEC_TIME __CURRENT_TIME;
+// bits of io_binding_t.tasks
+#define PLC_MAX_TASKS 8
+#define ALL_TASKS 0xff
+
+typedef struct {
+	const char *name;
+	uint32_t interval; // [ticks of common_ticktime__]
+	uint8_t priority; // IEC priority, 0 is the highest
+	TaskHandle_t handle;
+	uint64_t tick; // cycles run
+	IEC_TIME time; // PLC clock at the start of the current cycle
+} plc_task_t;
+
+#ifdef IEC_TASKS_NUM
+#if IEC_TASKS_NUM > PLC_MAX_TASKS
+#error "Too many IEC tasks"
+#endif
+
+// generates something like:
+//  { .name = "TASK0", .interval = 1, .priority = 0 },
+#define __IEC_TASK(name_, interval_, priority_)                                \
+	{ .name = #name_, .interval = interval_, .priority = priority_ },
+static plc_task_t tasks[] = {
+#include "IEC_TASKS.h"
+};
+#undef __IEC_TASK
+
+// generates something like:
+//  extern BLINK RES0__INSTANCE0;
+//  static void run_RES0__INSTANCE0(void) { BLINK_body__(&RES0__INSTANCE0); }
+#define __IEC_PROGRAM(task, type, instance)                                    \
+	extern type instance;                                                  \
+	static void run_##instance(void)                                       \
+	{                                                                      \
+		type##_body__(&instance);                                      \
+	}
+#include "IEC_TASKS.h"
+#undef __IEC_PROGRAM
+
+typedef struct {
+	uint8_t task;
+	void (*run)(void);
+} iec_program_t;
+
+#define __IEC_PROGRAM(task, type, instance) { task, run_##instance },
+static const iec_program_t programs[] = {
+#include "IEC_TASKS.h"
+};
+#undef __IEC_PROGRAM
+#else
+static plc_task_t tasks[] = { { .name = "plc", .interval = 1 } };
+#endif // ifdef IEC_TASKS_NUM
+
+#define TASKS_NUM (sizeof(tasks) / sizeof(tasks[0]))
 
 static void connect_buffers(void);
 static void plc_task(void *pvParameters);
-static void update_time(void);
-static void plc_run(void);
-static void update_outputs(void);
-static void update_inputs(void);
+static void task_run(plc_task_t *task);
+static void update_time(uint32_t ticks);
+static uint32_t handle_overrun(bool primary, TickType_t *last_wake,
+			       TickType_t period);
+static void update_outputs(uint8_t mask);
+static void update_inputs(uint8_t mask);
+
+// see handle_overrun()
+#define SCHEDULE_RESTARTED UINT32_MAX
 
-static TaskHandle_t plc_task_h = NULL;
-static uint64_t tick = 0;
+// the one with the shortest interval, see "IEC tasks"
+static plc_task_t *primary_task;
+// IO of all PLC tasks and the PLC clock
+static SemaphoreHandle_t io_mutex;
+
+// PLC clock kept by the primary task
+static IEC_TIME plc_clock;
 
 int plc_init()
 {
@@ -28,10 +121,37 @@ int plc_init()
 	config_init__();
 	connect_buffers();
 
-	if (xTaskCreate(plc_task, "plc", STACK_SIZE_PLC, NULL,
-			TASK_PRIORITY_PLC, &plc_task_h) != pdPASS) {
-		log_error("Failed to create plc task.");
-		die(DEATH_TASK_CREATION);
+	primary_task = &tasks[0];
+	for (uint8_t i = 1; i < TASKS_NUM; i++) {
+		if (tasks[i].interval < primary_task->interval) {
+			primary_task = &tasks[i];
+		}
+	}
+	plc_stats_init(primary_task->interval * common_ticktime__ / 1000);
+
+	if ((io_mutex = xSemaphoreCreateMutex()) == NULL) {
+		log_error("Failed to create PLC IO mutex.");
+		die(DEATH_INIT_FAILED);
+	}
+
+	for (uint8_t i = 0; i < TASKS_NUM; i++) {
+		plc_task_t *task = &tasks[i];
+		UBaseType_t priority =
+			TASK_PRIORITY_PLC -
+			(task->priority < PLC_TASK_PRIORITY_LEVELS ?
+				 task->priority :
+				 PLC_TASK_PRIORITY_LEVELS - 1);
+
+		log_info("PLC task %s: interval %lu us, priority %u",
+			 task->name,
+			 (unsigned long)(task->interval * common_ticktime__ /
+					 1000),
+			 (unsigned)priority);
+		if (xTaskCreate(plc_task, task->name, STACK_SIZE_PLC, task,
+				priority, &task->handle) != pdPASS) {
+			log_error("Failed to create plc task.");
+			die(DEATH_TASK_CREATION);
+		}
 	}
 
 	xEventGroupSetBits(global_event_group, PLC_INITIALIZED_BIT);
@@ -45,40 +165,116 @@ static void plc_task(void *pvParameters)
 		die(DEATH_INITIALIZATION_TIMEOUT);
 	}
 
+	plc_task_t *task = pvParameters;
+	// may run before xTaskCreate() returns the handle
+	task->handle = xTaskGetCurrentTaskHandle();
+	const bool primary = task == primary_task;
+	const uint8_t mask = 1 << (task - tasks);
+	const uint64_t period_nsec = task->interval * common_ticktime__;
+	const TickType_t period = pdMS_TO_TICKS(period_nsec / MILLION);
+	const uint32_t period_usec = period_nsec / 1000;
 	TickType_t last_wake = xTaskGetTickCount();
+	// ideal wake-up time of the current cycle, used to measure lateness
+	uint64_t nominal_wake = hal_uptime_usec();
+	uint32_t skipped = 0;
 
 	for (;;) {
-		update_time();
+		xSemaphoreTake(io_mutex, portMAX_DELAY);
+		if (primary) {
+			update_time(task->interval * (skipped + 1));
+		}
+		task->time = plc_clock;
+		xSemaphoreGive(io_mutex);
+		task->tick++;
 
 		if (IS_BIT_SET(PLC_RUNNING_BIT)) {
-			ui_plc_tick();
+			if (primary) {
+				ui_plc_tick();
+			}
 
 #if LOGLEVEL >= LOGLEVEL_DEBUG
-			float now_f =
-				__CURRENT_TIME.tv_sec +
-				__CURRENT_TIME.tv_nsec / (float)1000000000;
-			PRINTF("\ntick=%llu    time=%.3fs    tick_time=%llums\n",
-			       tick, now_f, common_ticktime__ / MILLION);
-
-			// measure clock precision
-			static uint32_t last_time = 0;
-			uint32_t now = uptime_usec();
-			int32_t tdiff = now - last_time;
-			PRINTF("time=%dus    precision: %d - %lld = %lldus\n",
-			       now, tdiff, (common_ticktime__ / 1000),
-			       tdiff - (common_ticktime__ / 1000));
-			last_time = now;
+			PRINTF("\n%s: tick=%llu    time=%lu.%09lus    "
+			       "period=%llums\n",
+			       task->name, task->tick,
+			       (unsigned long)task->time.tv_sec,
+			       (unsigned long)task->time.tv_nsec,
+			       period_nsec / MILLION);
 #endif
 
-			update_inputs();
-			// execute plc program
-			config_run__(tick);
-			update_outputs();
+			uint64_t t0 = hal_uptime_usec();
+			update_inputs(mask);
+			uint64_t t1 = hal_uptime_usec();
+			task_run(task);
+			uint64_t t2 = hal_uptime_usec();
+			update_outputs(mask);
+			uint64_t t3 = hal_uptime_usec();
+
+			if (primary) {
+				plc_stats_add_cycle(
+					t0 > nominal_wake ? t0 - nominal_wake :
+							    0,
+					t1 - t0, t2 - t1, t3 - t2);
+			}
+		}
+
+		skipped = handle_overrun(primary, &last_wake, period);
+		if (skipped == SCHEDULE_RESTARTED) {
+			skipped = 0;
+			nominal_wake = hal_uptime_usec();
+		} else {
+			nominal_wake += (uint64_t)(skipped + 1) * period_usec;
+		}
+
+		vTaskDelayUntil(&last_wake, period);
+	}
+}
+
+// execute programs of the task
+static void task_run(plc_task_t *task)
+{
+#ifdef IEC_TASKS_NUM
+	for (uint8_t i = 0; i < sizeof(programs) / sizeof(programs[0]); i++) {
+		if (programs[i].task == task - tasks) {
+			programs[i].run();
 		}
+	}
+#else
+	config_run__(task->tick);
+#endif
+}
+
+/*
+Apply PLC_OVERRUN_POLICY when the next cycle should have started already.
+`last_wake` is adjusted so that following vTaskDelayUntil() wakes up according
+to the policy. Returns number of skipped cycles or SCHEDULE_RESTARTED
+(stretch policy). Skipped cycles of the primary task are counted in the stats.
+*/
+static uint32_t handle_overrun(bool primary, TickType_t *last_wake,
+			       TickType_t period)
+{
+	TickType_t behind = xTaskGetTickCount() - *last_wake;
+
+	if (period == 0 || behind <= period) {
+		return 0;
+	}
 
-		vTaskDelayUntil(&last_wake,
-				pdMS_TO_TICKS(common_ticktime__ / MILLION));
+#if PLC_OVERRUN_POLICY == PLC_OVERRUN_SKIP
+	// continue with the first period boundary which is not in the past
+	uint32_t skipped = (behind - 1) / period;
+	*last_wake += skipped * period;
+	if (primary) {
+		plc_stats_add_skipped(skipped);
 	}
+	return skipped;
+#elif PLC_OVERRUN_POLICY == PLC_OVERRUN_STRETCH
+	// run the next cycle immediately, following cycles are relative to it
+	*last_wake += behind - period;
+	return SCHEDULE_RESTARTED;
+#else
+	// PLC_OVERRUN_CATCH_UP: vTaskDelayUntil() returns immediately until
+	// the missed cycles are executed
+	return 0;
+#endif
 }
 
 void plc_set_state(plc_state_t state)
@@ -110,20 +306,48 @@ void plc_set_state(plc_state_t state)
 }
 
 /*
-NOTE: This is how __CURRENT_TIME is updated in OpenPLC. PLC clock can get
-skewed if PLC task is not fired at the right moment. I don't know if
-regular time increments are essential for OpenPLC runtime functions
-so I think it's safer to stick with their implementation...
+Matiec-compiled PLC program reads __CURRENT_TIME, which is defined to
+(*plc_current_time()) by build flags: the clock snapshot of the calling PLC
+task. Outside of PLC tasks (config_init__()) it's the PLC clock itself.
 */
-static void update_time()
+IEC_TIME *plc_current_time(void)
 {
-	__CURRENT_TIME.tv_nsec += common_ticktime__;
-	while (__CURRENT_TIME.tv_nsec >= BILLION) {
-		__CURRENT_TIME.tv_nsec -= BILLION;
-		__CURRENT_TIME.tv_sec++;
+	TaskHandle_t current = xTaskGetCurrentTaskHandle();
+
+	for (uint8_t i = 0; i < TASKS_NUM; i++) {
+		if (tasks[i].handle == current) {
+			return &tasks[i].time;
+		}
 	}
+	return &plc_clock;
+}
 
-	tick++;
+/*
+Update PLC clock according to PLC_CLOCK, called with io_mutex held:
+
+PLC_CLOCK_TICKS: This is how __CURRENT_TIME is updated in OpenPLC - the clock is
+advanced by one period (`ticks` of common_ticktime__) on every wake-up of the
+primary task. It can get skewed if PLC task is not
+fired at the right moment. Skipped cycles (see PLC_OVERRUN_POLICY) are added
+so the clock does not lag behind after an overrun at least.
+
+PLC_CLOCK_UPTIME: The clock is derived from HW uptime, so it's monotonic and
+doesn't drift whatever the scheduling, IEC timers stay accurate under load.
+*/
+static void update_time(uint32_t ticks)
+{
+#if PLC_CLOCK == PLC_CLOCK_UPTIME
+	uint64_t now = hal_uptime_usec();
+
+	plc_clock.tv_sec = now / MILLION;
+	plc_clock.tv_nsec = (now % MILLION) * 1000;
+#else
+	plc_clock.tv_nsec += common_ticktime__ * ticks;
+	while (plc_clock.tv_nsec >= BILLION) {
+		plc_clock.tv_nsec -= BILLION;
+		plc_clock.tv_sec++;
+	}
+#endif
 }
 
 // ---------------------------------------------- program-specific vars --------
@@ -140,22 +364,103 @@ static void update_time()
 #include "LOCATED_VARIABLES.h"
 #undef __LOCATED_VAR
 
+#ifdef IEC_TASKS_NUM
+// located variables used by programs of IEC tasks
+typedef struct {
+	uint8_t task;
+	const void *var;
+} iec_located_t;
+
+// generates something like:
+//  { 0, &____QX0_0 },
+#define __IEC_LOCATED(task, name) { task, &__##name },
+static const iec_located_t located[] = {
+#include "IEC_TASKS.h"
+};
+#undef __IEC_LOCATED
+#endif
+
 // ---------------------------------------------- remote vars ------------------
 
 #ifdef WITH_CAN
+#ifdef WITH_DISCOVERY
+// filled in by discovery_run()
+uavcan_vals_block_t uavcan_dis_blocks[UAVCAN_MAX_BLOCKS];
+uavcan_vals_block_t uavcan_dos_blocks[UAVCAN_MAX_BLOCKS];
+uavcan_vals_block_t uavcan_ais_blocks[UAVCAN_MAX_BLOCKS];
+uavcan_vals_block_t uavcan_aos_blocks[UAVCAN_MAX_BLOCKS];
+
+uint8_t uavcan_dis_blocks_len = 0;
+uint8_t uavcan_dos_blocks_len = 0;
+uint8_t uavcan_ais_blocks_len = 0;
+uint8_t uavcan_aos_blocks_len = 0;
+#else
 uavcan_vals_block_t uavcan_dis_blocks[] = UAVCAN_DIS_BLOCKS;
 uavcan_vals_block_t uavcan_dos_blocks[] = UAVCAN_DOS_BLOCKS;
 uavcan_vals_block_t uavcan_ais_blocks[] = UAVCAN_AIS_BLOCKS;
 uavcan_vals_block_t uavcan_aos_blocks[] = UAVCAN_AOS_BLOCKS;
 
-const uint8_t uavcan_dis_blocks_len =
+uint8_t uavcan_dis_blocks_len =
 	sizeof(uavcan_dis_blocks) / sizeof(uavcan_dis_blocks[0]);
-const uint8_t uavcan_dos_blocks_len =
+uint8_t uavcan_dos_blocks_len =
 	sizeof(uavcan_dos_blocks) / sizeof(uavcan_dos_blocks[0]);
-const uint8_t uavcan_ais_blocks_len =
+uint8_t uavcan_ais_blocks_len =
 	sizeof(uavcan_ais_blocks) / sizeof(uavcan_ais_blocks[0]);
-const uint8_t uavcan_aos_blocks_len =
+uint8_t uavcan_aos_blocks_len =
 	sizeof(uavcan_aos_blocks) / sizeof(uavcan_aos_blocks[0]);
+#endif // ifdef WITH_DISCOVERY
+
+static uavcan_vals_block_t
+	*dis_by_node[sizeof(uavcan_dis_blocks) / sizeof(uavcan_dis_blocks[0])];
+static uavcan_vals_block_t
+	*ais_by_node[sizeof(uavcan_ais_blocks) / sizeof(uavcan_ais_blocks[0])];
+
+uavcan_blocks_index_t uavcan_dis_index = { .blocks = dis_by_node };
+uavcan_blocks_index_t uavcan_ais_index = { .blocks = ais_by_node };
+
+#ifdef UAVCAN_NODES_STATUS
+// every node has a block at least
+uavcan_node_vars_t uavcan_nodes_vars
+	[sizeof(uavcan_dis_blocks) / sizeof(uavcan_dis_blocks[0]) +
+	 sizeof(uavcan_dos_blocks) / sizeof(uavcan_dos_blocks[0]) +
+	 sizeof(uavcan_ais_blocks) / sizeof(uavcan_ais_blocks[0]) +
+	 sizeof(uavcan_aos_blocks) / sizeof(uavcan_aos_blocks[0])];
+uint8_t uavcan_nodes_vars_len = 0;
+
+static bool has_blocks(uint8_t node_id, const uavcan_vals_block_t *blocks,
+		       uint8_t len)
+{
+	for (uint8_t i = 0; i < len; i++) {
+		if (blocks[i].node_id == node_id) {
+			return true;
+		}
+	}
+	return false;
+}
+#endif
+
+// counting sort of blocks by node
+static void index_blocks(uavcan_blocks_index_t *index,
+			 uavcan_vals_block_t *blocks, uint8_t len)
+{
+	uint8_t next[UAVCAN_NODES_NUM];
+
+	memset(index->node_first, 0, sizeof(index->node_first));
+	for (uint8_t i = 0; i < len; i++) {
+		if (blocks[i].node_id >= UAVCAN_NODES_NUM) {
+			log_error("invalid block node id %d", blocks[i].node_id);
+			die(DEATH_INIT_FAILED);
+		}
+		index->node_first[blocks[i].node_id + 1]++;
+	}
+	for (uint8_t n = 0; n < UAVCAN_NODES_NUM; n++) {
+		index->node_first[n + 1] += index->node_first[n];
+		next[n] = index->node_first[n];
+	}
+	for (uint8_t i = 0; i < len; i++) {
+		index->blocks[next[blocks[i].node_id]++] = &blocks[i];
+	}
+}
 #endif // ifdef WITH_CAN
 
 #if 0
@@ -194,11 +499,142 @@ bool ext_dos[EXT_BUFF_SIZE];
 uint16_t ext_aos[EXT_BUFF_SIZE];
 bool ext_dis[EXT_BUFF_SIZE];
 uint16_t ext_ais[EXT_BUFF_SIZE];
+
+// Process images exchanged between PLC and UAVCAN task. They are triple
+// buffered, so a scan always sees a consistent set of inputs (i.e. never a half
+// of a block update) and neither task waits for the other one.
+typedef struct {
+	bool dis[EXT_BUFF_SIZE];
+	uint16_t ais[EXT_BUFF_SIZE];
+} ext_inputs_t;
+
+typedef struct {
+	bool dos[EXT_BUFF_SIZE];
+	uint16_t aos[EXT_BUFF_SIZE];
+} ext_outputs_t;
+
+static ext_inputs_t ext_inputs[3];
+static tbuf_t ext_inputs_tb;
+static ext_outputs_t ext_outputs[3];
+static tbuf_t ext_outputs_tb;
+// remote outputs of all PLC tasks, every task updates just its own ones
+static ext_outputs_t ext_outputs_image;
+
+void plc_publish_ext_inputs()
+{
+	ext_inputs_t *in = &ext_inputs[ext_inputs_tb.back];
+
+	memcpy(in->dis, ext_dis, sizeof(in->dis));
+	memcpy(in->ais, ext_ais, sizeof(in->ais));
+	tbuf_publish(&ext_inputs_tb);
+}
+
+void plc_fetch_ext_outputs()
+{
+	const ext_outputs_t *out = &ext_outputs[tbuf_acquire(&ext_outputs_tb)];
+
+	memcpy(ext_dos, out->dos, sizeof(ext_dos));
+	memcpy(ext_aos, out->aos, sizeof(ext_aos));
+}
 #endif
 
 #define AIDX(i) ((i) / 8)
 #define BIDX(i) ((i) % 8)
 
+// Located variable bound to a local pin or to an external vars buffer slot.
+// Built once by connect_buffers() so the scan cycle touches only variables
+// which are actually used by the program.
+typedef struct {
+	uint16_t index; // IO index (local) or external buffer index (remote)
+	uint8_t tasks; // PLC tasks exchanging the variable (bit mask)
+	union {
+		IEC_BOOL *bool_var;
+		IEC_UINT *uint_var;
+	};
+} io_binding_t;
+
+typedef struct {
+	uint16_t len;
+	io_binding_t items[IO_BUFFER_SIZE];
+} io_table_t;
+
+static io_table_t local_dis, local_dos, local_ais, local_aos;
+#ifdef WITH_CAN
+static io_table_t remote_dis, remote_dos, remote_ais, remote_aos;
+#endif
+
+// PLC tasks which use the variable, all of them if it's not known
+static uint8_t var_tasks(const void *var)
+{
+	uint8_t mask = 0;
+
+#ifdef IEC_TASKS_NUM
+	for (uint16_t i = 0; i < sizeof(located) / sizeof(located[0]); i++) {
+		if (located[i].var == var) {
+			mask |= 1 << located[i].task;
+		}
+	}
+#endif
+	return mask ? mask : ALL_TASKS;
+}
+
+static void io_table_add(io_table_t *table, uint16_t index, void *var)
+{
+	io_binding_t *item = &table->items[table->len++];
+
+	item->index = index;
+	item->tasks = var_tasks(var);
+	item->bool_var = var;
+}
+
+static void build_io_tables(void)
+{
+	for (uint16_t i = 0; i < IO_BUFFER_SIZE; i++) {
+		IEC_BOOL *bin = bool_input[AIDX(i)][BIDX(i)];
+		IEC_BOOL *bout = bool_output[AIDX(i)][BIDX(i)];
+
+		if (i < REMOTE_VARS_INDEX) {
+			if (bin != NULL) {
+				io_table_add(&local_dis, i, bin);
+			}
+			if (bout != NULL) {
+				io_table_add(&local_dos, i, bout);
+			}
+			if (int_input[i] != NULL) {
+				io_table_add(&local_ais, i, int_input[i]);
+			}
+			if (int_output[i] != NULL) {
+				io_table_add(&local_aos, i, int_output[i]);
+			}
+			continue;
+		}
+
+#ifdef WITH_CAN
+		uint16_t ext = i - REMOTE_VARS_INDEX;
+		if (bin != NULL) {
+			io_table_add(&remote_dis, ext, bin);
+		}
+		if (bout != NULL) {
+			io_table_add(&remote_dos, ext, bout);
+		}
+		if (int_input[i] != NULL) {
+			io_table_add(&remote_ais, ext, int_input[i]);
+		}
+		if (int_output[i] != NULL) {
+			io_table_add(&remote_aos, ext, int_output[i]);
+		}
+#endif // ifdef WITH_CAN
+	}
+
+	log_debug("bound IO: DI %u, DO %u, AI %u, AO %u", local_dis.len,
+		  local_dos.len, local_ais.len, local_aos.len);
+#ifdef WITH_CAN
+	log_debug("bound remote IO: DI %u, DO %u, AI %u, AO %u",
+		  remote_dis.len, remote_dos.len, remote_ais.len,
+		  remote_aos.len);
+#endif
+}
+
 void connect_buffers()
 {
 	// connect program vars to IO buffer
@@ -218,137 +654,231 @@ void connect_buffers()
 #include "LOCATED_VARIABLES.h"
 #undef __LOCATED_VAR
 
-	uint8_t dis_idx = 0, ais_idx = 0, dos_idx = 0, aos_idx = 0;
+	build_io_tables();
 
 #ifdef WITH_CAN
+	tbuf_init(&ext_inputs_tb);
+	tbuf_init(&ext_outputs_tb);
+#endif
+}
+
+#ifdef WITH_CAN
+#define NO_ROOM(type, block)                                                   \
+	log_error("no room for uavcan %s block: node=%d index=%d", type,      \
+		  block->node_id, block->index)
+
+void plc_connect_blocks()
+{
+	uint8_t dis_idx = 0, ais_idx = 0, dos_idx = 0, aos_idx = 0;
+
 	log_debug("\nexternal vars blocks...");
 
-	// connect UAVCAN blocks
+	// connect UAVCAN blocks, the ones which don't fit are dropped
 	for (int i = 0; i < uavcan_dis_blocks_len; i++) {
 		uavcan_vals_block_t *block = &uavcan_dis_blocks[i];
+		if (dis_idx + block->len > EXT_BUFF_SIZE) {
+			NO_ROOM("DI", block);
+			uavcan_dis_blocks_len = i;
+			break;
+		}
 		log_debug("uavcan DI block: node=%d index=%d len=%d -> %d",
 			  block->node_id, block->index, block->len, dis_idx);
 		block->digital_vals = &ext_dis[dis_idx];
 		dis_idx += block->len;
-		// TODO: check bounds
 	}
 	for (int i = 0; i < uavcan_ais_blocks_len; i++) {
 		uavcan_vals_block_t *block = &uavcan_ais_blocks[i];
+		if (ais_idx + block->len > EXT_BUFF_SIZE) {
+			NO_ROOM("AI", block);
+			uavcan_ais_blocks_len = i;
+			break;
+		}
 		log_debug("uavcan AI block: node=%d index=%d len=%d -> %d",
 			  block->node_id, block->index, block->len, ais_idx);
 		block->analog_vals = &ext_ais[ais_idx];
 		ais_idx += block->len;
-		// TODO: check bounds
 	}
+#ifdef UAVCAN_BLOCKS_STATUS
+	// status DI for every input block, DI blocks first
+	for (int i = 0; i < uavcan_dis_blocks_len + uavcan_ais_blocks_len;
+	     i++) {
+		uavcan_vals_block_t *block =
+			(i < uavcan_dis_blocks_len) ?
+				&uavcan_dis_blocks[i] :
+				&uavcan_ais_blocks[i - uavcan_dis_blocks_len];
+		if (dis_idx >= EXT_BUFF_SIZE) {
+			log_error("no room for remote blocks status");
+			break;
+		}
+		log_debug("uavcan block status: node=%d index=%d -> %d",
+			  block->node_id, block->index, dis_idx);
+		block->status_val = &ext_dis[dis_idx++];
+	}
+#endif
 	for (int i = 0; i < uavcan_dos_blocks_len; i++) {
 		uavcan_vals_block_t *block = &uavcan_dos_blocks[i];
+		if (dos_idx + block->len > EXT_BUFF_SIZE) {
+			NO_ROOM("DO", block);
+			uavcan_dos_blocks_len = i;
+			break;
+		}
 		log_debug("uavcan DO block: node=%d index=%d len=%d -> %d",
 			  block->node_id, block->index, block->len, dos_idx);
 		block->digital_vals = &ext_dos[dos_idx];
 		dos_idx += block->len;
-		// TODO: check bounds
 	}
 	for (int i = 0; i < uavcan_aos_blocks_len; i++) {
 		uavcan_vals_block_t *block = &uavcan_aos_blocks[i];
+		if (aos_idx + block->len > EXT_BUFF_SIZE) {
+			NO_ROOM("AO", block);
+			uavcan_aos_blocks_len = i;
+			break;
+		}
 		log_debug("uavcan AO block: node=%d index=%d len=%d -> %d",
 			  block->node_id, block->index, block->len, aos_idx);
 		block->analog_vals = &ext_aos[aos_idx];
 		aos_idx += block->len;
-		// TODO: check bounds
 	}
-#endif // ifdef WITH_CAN
+#ifdef UAVCAN_NODES_STATUS
+	// online DI and health AI for every node with blocks
+	uavcan_nodes_vars_len = 0;
+	for (uint8_t id = 0; id < UAVCAN_NODES_NUM; id++) {
+		if (!has_blocks(id, uavcan_dis_blocks, uavcan_dis_blocks_len) &&
+		    !has_blocks(id, uavcan_dos_blocks, uavcan_dos_blocks_len) &&
+		    !has_blocks(id, uavcan_ais_blocks, uavcan_ais_blocks_len) &&
+		    !has_blocks(id, uavcan_aos_blocks, uavcan_aos_blocks_len)) {
+			continue;
+		}
+		if (dis_idx >= EXT_BUFF_SIZE || ais_idx >= EXT_BUFF_SIZE) {
+			log_error("no room for remote nodes status");
+			break;
+		}
+		log_debug("uavcan node status: node=%d -> DI %d, AI %d", id,
+			  dis_idx, ais_idx);
+		uavcan_node_vars_t *vars =
+			&uavcan_nodes_vars[uavcan_nodes_vars_len++];
+		vars->node_id = id;
+		vars->online_val = &ext_dis[dis_idx++];
+		vars->health_val = &ext_ais[ais_idx++];
+	}
+#endif
+
+	index_blocks(&uavcan_dis_index, uavcan_dis_blocks,
+		     uavcan_dis_blocks_len);
+	index_blocks(&uavcan_ais_index, uavcan_ais_blocks,
+		     uavcan_ais_blocks_len);
 }
 
+#undef NO_ROOM
+#endif // ifdef WITH_CAN
+
 // ---------------------------------------------- IO ---------------------------
 
-void update_inputs()
+/*
+A PLC task exchanges just the variables used by its programs (`mask` is the
+task bit). IO of all the tasks is serialized by io_mutex, so a task always
+gets consistent remote inputs and publishes all the remote outputs.
+*/
+
+void update_inputs(uint8_t mask)
 {
 	log_debug("updating inputs");
 
+	xSemaphoreTake(io_mutex, portMAX_DELAY);
+
 	// local
-	for (uint8_t i = 0; i < REMOTE_VARS_INDEX; i++) {
-		// digital
-		uint8_t a = AIDX(i);
-		uint8_t b = BIDX(i);
-		IEC_BOOL *bval = bool_input[a][b];
-		if (bval != NULL) {
-			bool val2;
-			io_get_di(i, &val2);
-			log_debug("IX%u.%u = %u", a, b, val2);
-			*bval = val2;
+	for (uint16_t i = 0; i < local_dis.len; i++) {
+		io_binding_t *b = &local_dis.items[i];
+		if (!(b->tasks & mask)) {
+			continue;
 		}
-
-		// analog
-		IEC_UINT *uval = int_input[i];
-		if (uval != NULL) {
-			io_get_ai(i, uval);
-			log_debug("IW%u.%u = %u", a, b, *uval);
+		bool val;
+		io_get_di(b->index, &val);
+		*b->bool_var = val;
+		log_debug("IX%u.%u = %u", AIDX(b->index), BIDX(b->index), val);
+	}
+	for (uint16_t i = 0; i < local_ais.len; i++) {
+		io_binding_t *b = &local_ais.items[i];
+		if (!(b->tasks & mask)) {
+			continue;
 		}
+		io_get_ai(b->index, b->uint_var);
+		log_debug("IW%u = %u", b->index, *b->uint_var);
 	}
 
 #ifdef WITH_CAN
 	// remote
-	for (uint8_t i = REMOTE_VARS_INDEX; i < IO_BUFFER_SIZE; i++) {
-		// digital
-		uint8_t a = AIDX(i);
-		uint8_t b = BIDX(i);
-		IEC_BOOL *bval = bool_input[a][b];
-		if (bval != NULL) {
-			*bval = ext_dis[i - REMOTE_VARS_INDEX];
-			log_debug("IX%u.%u (R) = %u", a, b, *bval);
+	const ext_inputs_t *in = &ext_inputs[tbuf_acquire(&ext_inputs_tb)];
+	for (uint16_t i = 0; i < remote_dis.len; i++) {
+		io_binding_t *b = &remote_dis.items[i];
+		if (!(b->tasks & mask)) {
+			continue;
 		}
-
-		// analog
-		IEC_UINT *uval = int_input[i];
-		if (uval != NULL) {
-			*uval = ext_ais[i - REMOTE_VARS_INDEX];
-			log_debug("IW%u.%u (R) = %u\n", a, b, *uval);
+		*b->bool_var = in->dis[b->index];
+		log_debug("IX (R%u) = %u", b->index, *b->bool_var);
+	}
+	for (uint16_t i = 0; i < remote_ais.len; i++) {
+		io_binding_t *b = &remote_ais.items[i];
+		if (!(b->tasks & mask)) {
+			continue;
 		}
+		*b->uint_var = in->ais[b->index];
+		log_debug("IW (R%u) = %u", b->index, *b->uint_var);
 	}
 #endif // ifdef WITH_CAN
+
+	xSemaphoreGive(io_mutex);
 }
 
-void update_outputs()
+void update_outputs(uint8_t mask)
 {
 	log_debug("updating outputs");
 
+	xSemaphoreTake(io_mutex, portMAX_DELAY);
+
 	// local
-	for (uint8_t i = 0; i < REMOTE_VARS_INDEX; i++) {
-		// digital
-		uint8_t a = AIDX(i);
-		uint8_t b = BIDX(i);
-		IEC_BOOL *bval = bool_output[a][b];
-		if (bval != NULL) {
-			log_debug("QX%u.%u = %u", a, b, *bval);
-			io_set_do(i, *bval);
+	for (uint16_t i = 0; i < local_dos.len; i++) {
+		io_binding_t *b = &local_dos.items[i];
+		if (!(b->tasks & mask)) {
+			continue;
 		}
-
-		// analog
-		IEC_UINT *uval = int_output[i];
-		if (uval != NULL) {
-			log_debug("QW%u.%u = %u", a, b, *uval);
-			io_set_ao(i, *uval);
+		log_debug("QX%u.%u = %u", AIDX(b->index), BIDX(b->index),
+			  *b->bool_var);
+		io_set_do(b->index, *b->bool_var);
+	}
+	for (uint16_t i = 0; i < local_aos.len; i++) {
+		io_binding_t *b = &local_aos.items[i];
+		if (!(b->tasks & mask)) {
+			continue;
 		}
+		log_debug("QW%u = %u", b->index, *b->uint_var);
+		io_set_ao(b->index, *b->uint_var);
 	}
 
 #ifdef WITH_CAN
 	// remote
-	for (uint8_t i = REMOTE_VARS_INDEX; i < IO_BUFFER_SIZE; i++) {
-		// digital
-		uint8_t a = AIDX(i);
-		uint8_t b = BIDX(i);
-		IEC_BOOL *bval = bool_output[a][b];
-		if (bval != NULL) {
-			log_debug("QX%u.%u (R) = %u\n", a, b, *bval);
-			ext_dos[i - REMOTE_VARS_INDEX] = *bval;
+	// NOTE: back buffer holds outputs of an older scan, the image holds the
+	//       latest outputs of all the tasks
+	ext_outputs_t *out = &ext_outputs_image;
+	for (uint16_t i = 0; i < remote_dos.len; i++) {
+		io_binding_t *b = &remote_dos.items[i];
+		if (!(b->tasks & mask)) {
+			continue;
 		}
-
-		// analog
-		IEC_UINT *uval = int_output[i];
-		if (uval != NULL) {
-			log_debug("QW%u.%u (R) = %u\n", a, b, *uval);
-			ext_aos[i - REMOTE_VARS_INDEX] = *uval;
+		log_debug("QX (R%u) = %u", b->index, *b->bool_var);
+		out->dos[b->index] = *b->bool_var;
+	}
+	for (uint16_t i = 0; i < remote_aos.len; i++) {
+		io_binding_t *b = &remote_aos.items[i];
+		if (!(b->tasks & mask)) {
+			continue;
 		}
+		log_debug("QW (R%u) = %u", b->index, *b->uint_var);
+		out->aos[b->index] = *b->uint_var;
 	}
+	ext_outputs[ext_outputs_tb.back] = *out;
+	tbuf_publish(&ext_outputs_tb);
 #endif // ifdef WITH_CAN
+
+	xSemaphoreGive(io_mutex);
 }
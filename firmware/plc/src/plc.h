@@ -17,11 +17,25 @@ extern unsigned long long common_ticktime__;
 typedef struct {
 	uint8_t node_id;
 	uint8_t index;
+	// whole block is transferred at once, max. 63 DIs/DOs or 16 AIs/AOs
 	uint8_t len;
+	// inputs are reported by the node on change (TellValues), don't poll
+	bool tell;
 	union {
 		uint16_t *analog_vals;
 		bool *digital_vals;
 	};
+
+	// input blocks status, maintained by UAVCAN task
+	bool fresh; // values are up to date (not timed out)
+	uint32_t rtt; // last request round-trip time [us]
+	uint32_t last_update; // [ms]
+	// `fresh` copy visible to PLC program (see UAVCAN_BLOCKS_STATUS)
+	bool *status_val;
+
+	// output blocks status, maintained by UAVCAN task
+	bool sent; // values were sent at least once
+	uint32_t last_sent; // [ms]
 } uavcan_vals_block_t;
 
 typedef enum {
@@ -37,16 +51,55 @@ extern uavcan_vals_block_t uavcan_dos_blocks[];
 extern uavcan_vals_block_t uavcan_ais_blocks[];
 extern uavcan_vals_block_t uavcan_aos_blocks[];
 
-extern const uint8_t uavcan_dis_blocks_len;
-extern const uint8_t uavcan_dos_blocks_len;
-extern const uint8_t uavcan_ais_blocks_len;
-extern const uint8_t uavcan_aos_blocks_len;
+// UAVCAN_*_BLOCKS, or up to UAVCAN_MAX_BLOCKS filled in by discovery
+extern uint8_t uavcan_dis_blocks_len;
+extern uint8_t uavcan_dos_blocks_len;
+extern uint8_t uavcan_ais_blocks_len;
+extern uint8_t uavcan_aos_blocks_len;
+
+#define UAVCAN_NODES_NUM 128
+
+// Blocks grouped by node, built by plc_connect_blocks(). Blocks of node N are:
+//  index.blocks[index.node_first[N]] ... index.blocks[index.node_first[N + 1] - 1]
+typedef struct {
+	uavcan_vals_block_t **blocks;
+	uint8_t node_first[UAVCAN_NODES_NUM + 1];
+} uavcan_blocks_index_t;
+
+extern uavcan_blocks_index_t uavcan_dis_index;
+extern uavcan_blocks_index_t uavcan_ais_index;
+
+#ifdef UAVCAN_NODES_STATUS
+// Status of a node with remote blocks visible to PLC program (see
+// UAVCAN_NODES_STATUS), maintained by UAVCAN task
+typedef struct {
+	uint8_t node_id;
+	bool *online_val;
+	uint16_t *health_val;
+} uavcan_node_vars_t;
+
+// ascending node IDs, built by plc_connect_blocks()
+extern uavcan_node_vars_t uavcan_nodes_vars[];
+extern uint8_t uavcan_nodes_vars_len;
+#endif
 
 #define EXT_BUFF_SIZE (IO_BUFFER_SIZE - REMOTE_VARS_INDEX)
+// External vars buffers, owned by UAVCAN task (blocks point into them). PLC
+// tasks never touch them directly, they exchange whole process images with
+// UAVCAN task by the functions below.
 extern bool ext_dos[EXT_BUFF_SIZE];
 extern uint16_t ext_aos[EXT_BUFF_SIZE];
 extern bool ext_dis[EXT_BUFF_SIZE];
 extern uint16_t ext_ais[EXT_BUFF_SIZE];
+
+// Connect remote blocks to the external vars buffers. Blocks which don't fit
+// are dropped. Must be called after plc_init(), before UAVCAN task starts.
+void plc_connect_blocks(void);
+
+// UAVCAN task: hand ext_dis/ext_ais over to PLC (used by the next scan)
+void plc_publish_ext_inputs(void);
+// UAVCAN task: update ext_dos/ext_aos with outputs of the last finished scan
+void plc_fetch_ext_outputs(void);
 #endif // ifdef WITH_CAN
 
 #ifdef __cplusplus
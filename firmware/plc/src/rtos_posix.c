@@ -0,0 +1,270 @@
+#include "app_config.h"
+
+#ifdef POSIX
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "hal.h"
+#include "rtos_posix.h"
+
+#define TICK_USEC (1000000ULL / configTICK_RATE_HZ)
+
+struct rtos_task {
+	pthread_t thread;
+	TaskFunction_t task_fn;
+	void *params;
+};
+
+struct rtos_event_group {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	EventBits_t bits;
+};
+
+struct rtos_mutex {
+	pthread_mutex_t mutex;
+};
+
+static uint64_t monotonic_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void usec_to_timespec(uint64_t usec, struct timespec *ts)
+{
+	ts->tv_sec = usec / 1000000ULL;
+	ts->tv_nsec = (usec % 1000000ULL) * 1000;
+}
+
+static void sleep_until_usec(uint64_t usec)
+{
+	struct timespec ts;
+
+	usec_to_timespec(usec, &ts);
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) ==
+	       EINTR)
+		;
+}
+
+// ---------------------------------------------- tasks ------------------------
+
+static __thread struct rtos_task *current_task;
+
+static void *task_trampoline(void *arg)
+{
+	struct rtos_task *task = arg;
+
+	current_task = task;
+	task->task_fn(task->params);
+
+	// FreeRTOS tasks must never return
+	log_error("task returned");
+	die(DEATH_UNREACHABLE_REACHED);
+	return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t task_fn, const char *name,
+		       uint32_t stack_depth, void *params,
+		       UBaseType_t priority, TaskHandle_t *out_handle)
+{
+	struct rtos_task *task;
+	pthread_attr_t attr;
+	struct sched_param sp;
+
+	if ((task = calloc(1, sizeof(*task))) == NULL) {
+		return pdFAIL;
+	}
+	task->task_fn = task_fn;
+	task->params = params;
+
+	// Try to mimic FreeRTOS priorities with realtime scheduling. It's
+	// usually not permitted for unprivileged users - fallback to the
+	// default scheduler then.
+	pthread_attr_init(&attr);
+	pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+	sp.sched_priority = sched_get_priority_min(SCHED_FIFO) + priority;
+	pthread_attr_setschedparam(&attr, &sp);
+	if (pthread_create(&task->thread, &attr, task_trampoline, task) != 0 &&
+	    pthread_create(&task->thread, NULL, task_trampoline, task) != 0) {
+		pthread_attr_destroy(&attr);
+		free(task);
+		return pdFAIL;
+	}
+	pthread_attr_destroy(&attr);
+
+	if (out_handle) {
+		*out_handle = task;
+	}
+
+	return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+	return current_task;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+	return (TickType_t)(monotonic_usec() / TICK_USEC);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+	sleep_until_usec(monotonic_usec() + ticks * TICK_USEC);
+}
+
+// Same semantics as in FreeRTOS: when the wake time already passed, return
+// immediately but still advance *prev_wake by exactly one increment.
+void vTaskDelayUntil(TickType_t *prev_wake, TickType_t increment)
+{
+	uint64_t now = monotonic_usec();
+	TickType_t wake = *prev_wake + increment;
+	int32_t remaining = (int32_t)(wake - (TickType_t)(now / TICK_USEC));
+
+	if (remaining > 0) {
+		sleep_until_usec((now / TICK_USEC + remaining) * TICK_USEC);
+	}
+	*prev_wake = wake;
+}
+
+// ---------------------------------------------- event groups -----------------
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+	struct rtos_event_group *group;
+	pthread_condattr_t attr;
+
+	if ((group = calloc(1, sizeof(*group))) == NULL) {
+		return NULL;
+	}
+	pthread_mutex_init(&group->mutex, NULL);
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&group->cond, &attr);
+	pthread_condattr_destroy(&attr);
+
+	return group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+	EventBits_t res;
+
+	pthread_mutex_lock(&group->mutex);
+	group->bits |= bits;
+	res = group->bits;
+	pthread_cond_broadcast(&group->cond);
+	pthread_mutex_unlock(&group->mutex);
+
+	return res;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+	EventBits_t res;
+
+	pthread_mutex_lock(&group->mutex);
+	// FreeRTOS returns bits *before* clearing
+	res = group->bits;
+	group->bits &= ~bits;
+	pthread_mutex_unlock(&group->mutex);
+
+	return res;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+	EventBits_t res;
+
+	pthread_mutex_lock(&group->mutex);
+	res = group->bits;
+	pthread_mutex_unlock(&group->mutex);
+
+	return res;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits,
+				BaseType_t clear_on_exit,
+				BaseType_t wait_for_all, TickType_t ticks)
+{
+	struct timespec deadline;
+	EventBits_t res;
+
+	usec_to_timespec(monotonic_usec() + (uint64_t)ticks * TICK_USEC,
+			 &deadline);
+
+	pthread_mutex_lock(&group->mutex);
+	for (;;) {
+		res = group->bits;
+		if (wait_for_all ? ((res & bits) == bits) : (res & bits)) {
+			if (clear_on_exit) {
+				group->bits &= ~bits;
+			}
+			break;
+		}
+		if (ticks == portMAX_DELAY) {
+			pthread_cond_wait(&group->cond, &group->mutex);
+		} else if (pthread_cond_timedwait(&group->cond, &group->mutex,
+						  &deadline) == ETIMEDOUT) {
+			res = group->bits;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&group->mutex);
+
+	return res;
+}
+
+// ---------------------------------------------- mutexes ----------------------
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+	struct rtos_mutex *mutex;
+	pthread_mutexattr_t attr;
+
+	if ((mutex = calloc(1, sizeof(*mutex))) == NULL) {
+		return NULL;
+	}
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+	pthread_mutex_init(&mutex->mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+
+	return mutex;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks)
+{
+	struct timespec deadline;
+
+	if (ticks == portMAX_DELAY) {
+		return pthread_mutex_lock(&mutex->mutex) == 0 ? pdTRUE :
+								 pdFALSE;
+	}
+
+	// pthread_mutex_timedlock() takes CLOCK_REALTIME deadline
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	usec_to_timespec((uint64_t)deadline.tv_sec * 1000000ULL +
+				 deadline.tv_nsec / 1000 +
+				 (uint64_t)ticks * TICK_USEC,
+			 &deadline);
+	return pthread_mutex_timedlock(&mutex->mutex, &deadline) == 0 ?
+		       pdTRUE :
+		       pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex)
+{
+	return pthread_mutex_unlock(&mutex->mutex) == 0 ? pdTRUE : pdFALSE;
+}
+
+#endif // ifdef POSIX
@@ -0,0 +1,82 @@
+// Subset of FreeRTOS API used by the firmware implemented on top of POSIX
+// threads. It makes it possible to run the firmware as a regular Linux
+// process (see hal_posix.c).
+
+#ifndef RTOS_POSIX_H
+#define RTOS_POSIX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t EventBits_t;
+typedef void (*TaskFunction_t)(void *);
+typedef struct rtos_task *TaskHandle_t;
+typedef struct rtos_event_group *EventGroupHandle_t;
+typedef struct rtos_mutex *SemaphoreHandle_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+
+#define configTICK_RATE_HZ 1000
+// stack sizes are ignored, every task gets default pthread stack
+#define configMINIMAL_STACK_SIZE 768
+#define configMAX_PRIORITIES 25
+#define tskIDLE_PRIORITY 0
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)                                                      \
+	((TickType_t)(((uint64_t)(ms)*configTICK_RATE_HZ) / 1000))
+
+#define BIT0 0x00000001
+#define BIT1 0x00000002
+#define BIT2 0x00000004
+#define BIT3 0x00000008
+#define BIT4 0x00000010
+#define BIT5 0x00000020
+#define BIT6 0x00000040
+#define BIT7 0x00000080
+
+// ---------------------------------------------- tasks ------------------------
+
+BaseType_t xTaskCreate(TaskFunction_t task_fn, const char *name,
+		       uint32_t stack_depth, void *params,
+		       UBaseType_t priority, TaskHandle_t *out_handle);
+// NULL outside of tasks created by xTaskCreate()
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t *prev_wake, TickType_t increment);
+
+// ---------------------------------------------- event groups -----------------
+
+EventGroupHandle_t xEventGroupCreate(void);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits,
+				BaseType_t clear_on_exit,
+				BaseType_t wait_for_all, TickType_t ticks);
+
+// ---------------------------------------------- mutexes ----------------------
+
+// priority inheriting mutexes, as in FreeRTOS
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ifndef RTOS_POSIX_H
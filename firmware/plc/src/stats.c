@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "stats.h"
+
+// ---------------------------------------------- timing statistics ------------
+
+static uint8_t hist_bucket(uint32_t usec)
+{
+	uint8_t bucket = (usec == 0) ? 0 : 32 - __builtin_clz(usec);
+
+	return (bucket < STATS_HIST_BUCKETS) ? bucket : STATS_HIST_BUCKETS - 1;
+}
+
+void stats_timing_reset(stats_timing_t *t)
+{
+	memset(t, 0, sizeof(*t));
+	t->min = UINT32_MAX;
+}
+
+void stats_timing_add(stats_timing_t *t, uint32_t usec)
+{
+	t->count++;
+	t->sum += usec;
+	if (usec < t->min) {
+		t->min = usec;
+	}
+	if (usec > t->max) {
+		t->max = usec;
+	}
+	t->hist[hist_bucket(usec)]++;
+}
+
+uint32_t stats_timing_mean(const stats_timing_t *t)
+{
+	return t->count ? t->sum / t->count : 0;
+}
+
+// ---------------------------------------------- PLC scan cycle ---------------
+
+static plc_stats_t stats;
+static volatile bool reset_pending = false;
+
+static void reset(void)
+{
+	stats.cycles = 0;
+	stats.overruns = 0;
+	stats.skipped = 0;
+	stats_timing_reset(&stats.inputs);
+	stats_timing_reset(&stats.program);
+	stats_timing_reset(&stats.outputs);
+	stats_timing_reset(&stats.scan);
+	stats_timing_reset(&stats.lateness);
+}
+
+void plc_stats_init(uint32_t period_usec)
+{
+	stats.period = period_usec;
+	reset();
+}
+
+// Stats are written by the primary PLC task only, others just ask for reset.
+void plc_stats_reset(void)
+{
+	reset_pending = true;
+}
+
+void plc_stats_add_cycle(uint32_t late_usec, uint32_t inputs_usec,
+			 uint32_t program_usec, uint32_t outputs_usec)
+{
+	uint32_t scan_usec = inputs_usec + program_usec + outputs_usec;
+
+	__atomic_store_n(&stats.seq, stats.seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	if (reset_pending) {
+		reset_pending = false;
+		reset();
+	}
+
+	stats.cycles++;
+	if (late_usec + scan_usec > stats.period) {
+		stats.overruns++;
+	}
+	stats_timing_add(&stats.inputs, inputs_usec);
+	stats_timing_add(&stats.program, program_usec);
+	stats_timing_add(&stats.outputs, outputs_usec);
+	stats_timing_add(&stats.scan, scan_usec);
+	stats_timing_add(&stats.lateness, late_usec);
+
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	__atomic_store_n(&stats.seq, stats.seq + 1, __ATOMIC_RELAXED);
+}
+
+void plc_stats_get(plc_stats_t *out)
+{
+	uint32_t seq;
+
+	do {
+		while ((seq = __atomic_load_n(&stats.seq, __ATOMIC_ACQUIRE)) &
+		       1)
+			;
+		memcpy(out, &stats, sizeof(*out));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while (seq != __atomic_load_n(&stats.seq, __ATOMIC_RELAXED));
+}
+
+void plc_stats_add_skipped(uint32_t cycles)
+{
+	__atomic_store_n(&stats.seq, stats.seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	stats.skipped += cycles;
+
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	__atomic_store_n(&stats.seq, stats.seq + 1, __ATOMIC_RELAXED);
+}
+
+uint16_t plc_stats_vendor_status(void)
+{
+	// word-sized reads, no need for a full snapshot
+	uint32_t load = stats.period ? (uint64_t)stats.scan.max * 100 /
+					       stats.period :
+				       0;
+	uint32_t overruns = stats.overruns;
+
+	if (load > 0xff) {
+		load = 0xff;
+	}
+	if (overruns > 0xff) {
+		overruns = 0xff;
+	}
+
+	return (overruns << 8) | load;
+}
+
+static int timing_to_json(char *buf, size_t len, const char *name,
+			  const stats_timing_t *t)
+{
+	int n;
+	size_t pos;
+
+	n = snprintf(buf, len,
+		     "\"%s\":{\"min\":%u,\"max\":%u,\"mean\":%u,\"hist\":[",
+		     name, (unsigned)(t->count ? t->min : 0), (unsigned)t->max,
+		     (unsigned)stats_timing_mean(t));
+	for (uint8_t i = 0; i < STATS_HIST_BUCKETS; i++) {
+		pos = (n < (int)len) ? n : len;
+		n += snprintf(buf + pos, len - pos, "%s%u", i ? "," : "",
+			      (unsigned)t->hist[i]);
+	}
+	pos = (n < (int)len) ? n : len;
+	n += snprintf(buf + pos, len - pos, "]}");
+
+	return n;
+}
+
+int plc_stats_to_json(char *buf, size_t len)
+{
+	plc_stats_t s;
+	int n;
+	size_t pos;
+
+	plc_stats_get(&s);
+
+	n = snprintf(buf, len,
+		     "{\"period\":%u,\"cycles\":%u,\"overruns\":%u,"
+		     "\"skipped\":%u,",
+		     (unsigned)s.period, (unsigned)s.cycles,
+		     (unsigned)s.overruns, (unsigned)s.skipped);
+
+#define APPEND_TIMING(name, comma)                                             \
+	pos = (n < (int)len) ? n : len;                                        \
+	n += timing_to_json(buf + pos, len - pos, #name, &s.name);             \
+	pos = (n < (int)len) ? n : len;                                        \
+	n += snprintf(buf + pos, len - pos, comma);
+
+	APPEND_TIMING(inputs, ",");
+	APPEND_TIMING(program, ",");
+	APPEND_TIMING(outputs, ",");
+	APPEND_TIMING(scan, ",");
+	APPEND_TIMING(lateness, "}");
+#undef APPEND_TIMING
+
+	return n;
+}
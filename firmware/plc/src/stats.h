@@ -0,0 +1,73 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ---------------------------------------------- timing statistics ------------
+
+// Histogram bucket `i` counts samples in <2^(i-1), 2^i) [us], bucket 0 counts
+// zeros and the last bucket also counts everything longer.
+#define STATS_HIST_BUCKETS 20
+
+typedef struct {
+	uint32_t count;
+	uint32_t min; // [us]
+	uint32_t max; // [us]
+	uint64_t sum; // [us]
+	uint32_t hist[STATS_HIST_BUCKETS];
+} stats_timing_t;
+
+void stats_timing_reset(stats_timing_t *t);
+void stats_timing_add(stats_timing_t *t, uint32_t usec);
+uint32_t stats_timing_mean(const stats_timing_t *t);
+
+// ---------------------------------------------- PLC scan cycle ---------------
+
+typedef struct {
+	// incremented before and after every update (seqlock), odd value means
+	// update in progress
+	volatile uint32_t seq;
+
+	uint32_t period; // nominal scan period [us]
+	uint32_t cycles;
+	// cycles which did not finish before the next one should have started
+	uint32_t overruns;
+	// cycles dropped by PLC_OVERRUN_SKIP policy
+	uint32_t skipped;
+
+	stats_timing_t inputs;
+	stats_timing_t program;
+	stats_timing_t outputs;
+	// whole scan (inputs + program + outputs)
+	stats_timing_t scan;
+	// wake-up lateness against the nominal schedule
+	stats_timing_t lateness;
+} plc_stats_t;
+
+void plc_stats_init(uint32_t period_usec);
+void plc_stats_reset(void);
+// called by the primary PLC task only (see plc.c)
+void plc_stats_add_cycle(uint32_t late_usec, uint32_t inputs_usec,
+			 uint32_t program_usec, uint32_t outputs_usec);
+// called by the primary PLC task only (see plc.c)
+void plc_stats_add_skipped(uint32_t cycles);
+// consistent snapshot, can be called from any task
+void plc_stats_get(plc_stats_t *out);
+
+/*
+Value for NodeStatus.vendor_specific_status_code:
+
+    bits 0-7    worst scan time in % of scan period (saturated to 255)
+    bits 8-15   overruns count (saturated to 255)
+*/
+uint16_t plc_stats_vendor_status(void);
+
+// returns number of chars written (see snprintf)
+int plc_stats_to_json(char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -9,26 +9,41 @@
 #include <automation/SetValues.h>
 #include <automation/GetValues.h>
 
+#include "discovery.h"
 #include "hal.h"
 #include "locks.h"
+#include "params.h"
 #include "plc.h"
+#include "stats.h"
+#include "tools.h"
 #include "uavcan_impl.h"
 
 void uavcan_task(void *pvParameters);
 
 TaskHandle_t uavcan_task_h = NULL;
 
+// ext_dis/ext_ais changed since the last plc_publish_ext_inputs()
+static bool ext_inputs_dirty = false;
+
+// tunable by parameters (see uavcan_params)
+static uint32_t io_period = 0; // [us], 0 - PLC scan period
+static uint32_t request_timeout = UAVCAN_REQUEST_TIMEOUT;
+static uint32_t tell_timeout = UAVCAN_TELL_TIMEOUT;
+static uint32_t outputs_refresh_period = UAVCAN_OUTPUTS_REFRESH_PERIOD;
+
+static int params_init(void);
+
 int uavcan2_init()
 {
+	// init UAVCAN, CAN filters planned by can2_init() need the node ID
+	uavcan_init();
+
 	// init CAN HW
 	int res;
 	if ((res = can2_init())) {
 		return res;
 	}
 
-	// init UAVCAN
-	uavcan_init();
-
 	uavcan_node_status.health = UAVCAN_PROTOCOL_NODESTATUS_HEALTH_OK;
 	uavcan_node_status.mode =
 		UAVCAN_PROTOCOL_NODESTATUS_MODE_INITIALIZATION;
@@ -48,6 +63,17 @@ int uavcan2_init()
 
 	uavcan_broadcast_status();
 
+	if ((res = params_init())) {
+		return res;
+	}
+
+#ifdef WITH_DISCOVERY
+	if ((res = discovery_run())) {
+		return res;
+	}
+#endif
+	plc_connect_blocks();
+
 	if (xTaskCreate(uavcan_task, "uavcan", STACK_SIZE_UAVCAN, NULL,
 			TASK_PRIORITY_UAVCAN, &uavcan_task_h) != pdPASS) {
 		log_error("Failed to create uavcan status task");
@@ -57,10 +83,277 @@ int uavcan2_init()
 	return 0;
 }
 
+// ---------------------------------------------- requests tracking ------------
+
+typedef struct {
+	uavcan_vals_block_t *block; // NULL - free slot
+	bool digital;
+	uint8_t transfer_id;
+	uint32_t sent; // [us]
+} pending_request_t;
+
+// outstanding GetValues requests, keyed by (block->node_id, transfer_id)
+static pending_request_t pending[UAVCAN_MAX_PENDING_REQUESTS];
+
+static pending_request_t *request_find(const uavcan_vals_block_t *block)
+{
+	for (uint8_t i = 0; i < UAVCAN_MAX_PENDING_REQUESTS; i++) {
+		if (pending[i].block == block) {
+			return &pending[i];
+		}
+	}
+	return NULL;
+}
+
+static void block_set_fresh(uavcan_vals_block_t *block, bool fresh)
+{
+	if (fresh) {
+		block->last_update = hal_uptime_msec();
+	} else if (block->fresh) {
+		log_warning("Node %d values %d-%d are stale", block->node_id,
+			    block->index, block->index + block->len - 1);
+	}
+	block->fresh = fresh;
+	if (block->status_val != NULL && *block->status_val != fresh) {
+		*block->status_val = fresh;
+		ext_inputs_dirty = true;
+	}
+}
+
+// Returns the block the request was sent for, NULL if the response is not
+// expected (already timed out for instance).
+static uavcan_vals_block_t *request_done(uint8_t node_id, uint8_t transfer_id,
+					 bool digital)
+{
+	for (uint8_t i = 0; i < UAVCAN_MAX_PENDING_REQUESTS; i++) {
+		pending_request_t *req = &pending[i];
+		if (req->block == NULL || req->block->node_id != node_id ||
+		    req->transfer_id != transfer_id ||
+		    req->digital != digital) {
+			continue;
+		}
+		uavcan_vals_block_t *block = req->block;
+		block->rtt = (uint32_t)hal_uptime_usec() - req->sent;
+		req->block = NULL;
+		return block;
+	}
+	return NULL;
+}
+
+static void check_timeouts(void)
+{
+	uint32_t now_usec = hal_uptime_usec();
+	uint32_t now_msec = hal_uptime_msec();
+
+	for (uint8_t i = 0; i < UAVCAN_MAX_PENDING_REQUESTS; i++) {
+		pending_request_t *req = &pending[i];
+		if (req->block != NULL &&
+		    now_usec - req->sent > request_timeout * 1000UL) {
+			block_set_fresh(req->block, false);
+			req->block = NULL;
+		}
+	}
+
+	// nobody asks for told values, they just stop coming
+	for (uint8_t i = 0; i < uavcan_dis_blocks_len; i++) {
+		uavcan_vals_block_t *block = &uavcan_dis_blocks[i];
+		if (block->tell && block->fresh &&
+		    now_msec - block->last_update > tell_timeout) {
+			block_set_fresh(block, false);
+		}
+	}
+	for (uint8_t i = 0; i < uavcan_ais_blocks_len; i++) {
+		uavcan_vals_block_t *block = &uavcan_ais_blocks[i];
+		if (block->tell && block->fresh &&
+		    now_msec - block->last_update > tell_timeout) {
+			block_set_fresh(block, false);
+		}
+	}
+}
+
+// ---------------------------------------------- nodes liveness ---------------
+
+#if UAVCAN_WITH_NODE_TABLE
+// A node is offline when it stopped broadcasting NodeStatus. Nodes which did
+// not broadcast any yet (or did not fit into the table) are not.
+static bool node_offline(uint8_t node_id)
+{
+	const uavcan_remote_node_t *remote = uavcan_get_remote_node(node_id);
+	return remote != NULL && !remote->online;
+}
+
+static void node_blocks_stale(uint8_t node_id)
+{
+	for (uint8_t i = uavcan_dis_index.node_first[node_id];
+	     i < uavcan_dis_index.node_first[node_id + 1]; i++) {
+		block_set_fresh(uavcan_dis_index.blocks[i], false);
+	}
+	for (uint8_t i = uavcan_ais_index.node_first[node_id];
+	     i < uavcan_ais_index.node_first[node_id + 1]; i++) {
+		block_set_fresh(uavcan_ais_index.blocks[i], false);
+	}
+}
+
+// the node lost its outputs (or has them in the failsafe state), send them
+// in the next round
+static void node_outputs_resend(uint8_t node_id)
+{
+	for (uint8_t i = 0; i < uavcan_dos_blocks_len; i++) {
+		if (uavcan_dos_blocks[i].node_id == node_id) {
+			uavcan_dos_blocks[i].sent = false;
+		}
+	}
+	for (uint8_t i = 0; i < uavcan_aos_blocks_len; i++) {
+		if (uavcan_aos_blocks[i].node_id == node_id) {
+			uavcan_aos_blocks[i].sent = false;
+		}
+	}
+}
+#else
+#define node_offline(node_id) false
+#endif // if UAVCAN_WITH_NODE_TABLE
+
+#ifdef UAVCAN_NODES_STATUS
+static void node_vars_set(const uavcan_remote_node_t *remote)
+{
+	for (uint8_t i = 0; i < uavcan_nodes_vars_len; i++) {
+		uavcan_node_vars_t *vars = &uavcan_nodes_vars[i];
+		if (vars->node_id != remote->node_id) {
+			continue;
+		}
+		if (*vars->online_val != remote->online ||
+		    *vars->health_val != remote->health) {
+			*vars->online_val = remote->online;
+			*vars->health_val = remote->health;
+			ext_inputs_dirty = true;
+		}
+		return;
+	}
+}
+#else
+#define node_vars_set(remote)
+#endif
+
+// ---------------------------------------------- inputs -----------------------
+
+static void poll_inputs(uavcan_vals_block_t *blocks, uint8_t blocks_len,
+			bool digital)
+{
+	const char *type = digital ? "DI" : "AI";
+
+	for (uint8_t i = 0; i < blocks_len; i++) {
+		uavcan_vals_block_t *block = &blocks[i];
+		// told values or the previous request is not finished yet
+		if (block->tell || request_find(block) != NULL) {
+			continue;
+		}
+		// no point in asking, it was made stale when it went offline
+		if (node_offline(block->node_id)) {
+			continue;
+		}
+
+		pending_request_t *req = request_find(NULL);
+		if (req == NULL) {
+			log_error("Too many pending requests");
+			return;
+		}
+
+		log_com_debug("<- %s%d-%d@%d = ?", type, block->index,
+			      block->index + block->len - 1, block->node_id);
+		int16_t transfer_id =
+			digital ? automation_send_get_dis(block->node_id,
+							  block->index,
+							  block->len) :
+				  automation_send_get_ais(block->node_id,
+							  block->index,
+							  block->len);
+		if (transfer_id < 0) {
+			log_error("get %s TX failed", type);
+			continue;
+		}
+
+		req->block = block;
+		req->digital = digital;
+		req->transfer_id = transfer_id;
+		req->sent = hal_uptime_usec();
+	}
+}
+
+// ---------------------------------------------- outputs ----------------------
+
+// values last sent to the nodes, at the same offsets as in ext_dos/ext_aos
+static bool sent_dos[EXT_BUFF_SIZE];
+static uint16_t sent_aos[EXT_BUFF_SIZE];
+
+// Send blocks which changed since they were sent last time. Every block is sent
+// at least once per outputs_refresh_period, so a node which missed a
+// message (or restarted) gets the right values soon.
+static void send_outputs(uavcan_vals_block_t *blocks, uint8_t blocks_len,
+			 bool digital)
+{
+	const char *type = digital ? "DO" : "AO";
+	uint32_t now = hal_uptime_msec();
+
+	for (uint8_t i = 0; i < blocks_len; i++) {
+		uavcan_vals_block_t *block = &blocks[i];
+		const void *vals;
+		void *sent;
+		size_t size;
+
+		if (digital) {
+			vals = block->digital_vals;
+			sent = &sent_dos[block->digital_vals - ext_dos];
+			size = block->len * sizeof(bool);
+		} else {
+			vals = block->analog_vals;
+			sent = &sent_aos[block->analog_vals - ext_aos];
+			size = block->len * sizeof(uint16_t);
+		}
+		if (block->sent &&
+		    now - block->last_sent < outputs_refresh_period &&
+		    memcmp(sent, vals, size) == 0) {
+			continue;
+		}
+		// sent when the node is back online
+		if (node_offline(block->node_id)) {
+			continue;
+		}
+
+#if LOGLEVEL >= LOGLEVEL_DEBUG
+		PRINTF("<- %s%d-%d@%d =", type, block->index,
+		       block->index + block->len - 1, block->node_id);
+		for (int j = 0; j < block->len; j++) {
+			PRINTF(" %d", digital ? block->digital_vals[j] :
+						block->analog_vals[j]);
+		}
+		PRINTF("\n");
+#endif
+		int16_t res =
+			digital ? automation_send_set_dos(
+					  block->node_id, block->index,
+					  block->digital_vals, block->len,
+					  CANARD_TRANSFER_PRIORITY_HIGH) :
+				  automation_send_set_aos(
+					  block->node_id, block->index,
+					  block->analog_vals, block->len,
+					  CANARD_TRANSFER_PRIORITY_HIGH);
+		if (res < 0) {
+			// will be retried in the next round
+			log_error("%s TX failed", type);
+			continue;
+		}
+
+		memcpy(sent, vals, size);
+		block->sent = true;
+		block->last_sent = now;
+	}
+}
+
+// ---------------------------------------------- UAVCAN task ------------------
+
 void uavcan_task(void *pvParameters)
 {
 	TickType_t last_wake = xTaskGetTickCount();
-	uint64_t io_rxtx_delay = common_ticktime__ / 1000;
 
 	// We must wait for PLC buffers initialization
 	// TODO: We are not broadcasting node status and are not responding to NodeInfo
@@ -70,88 +363,45 @@ void uavcan_task(void *pvParameters)
 	}
 
 	for (;;) {
-		uavcan_vals_block_t *block;
 		uint64_t now = hal_uptime_usec();
 
 		static uint64_t last_io_rxtx = 0;
+		uint64_t io_rxtx_delay =
+			io_period ? io_period : common_ticktime__ / 1000;
 		if (now - last_io_rxtx >= io_rxtx_delay) {
 			last_io_rxtx = now;
 
-			// ask for digital inputs
-			for (uint8_t i = 0; i < uavcan_dis_blocks_len; i++) {
-				block = &uavcan_dis_blocks[i];
-				log_com_debug("<- DI%d-%d@%d = ?", block->index,
-					      block->index + block->len - 1,
-					      block->node_id);
-				if (automation_send_get_dis(block->node_id,
-							    block->index,
-							    block->len) < 0) {
-					log_error("get DI TX failed");
-				}
-			}
-			uavcan_update();
+			// outputs of the last finished PLC scan
+			plc_fetch_ext_outputs();
 
-			// ask for analog inputs
-			for (uint8_t i = 0; i < uavcan_ais_blocks_len; i++) {
-				block = &uavcan_ais_blocks[i];
-				log_com_debug("<- AI%d-%d@%d = ?", block->index,
-					      block->index + block->len - 1,
-					      block->node_id);
-				if (automation_send_get_ais(block->node_id,
-							    block->index,
-							    block->len) < 0) {
-					log_error("get AI TX failed");
-				}
+#ifdef WITH_SYNC
+			// Nodes latch inputs requested below and apply outputs
+			// sent in the previous round.
+			if (automation_send_sync() < 0) {
+				log_error("Sync TX failed");
 			}
 			uavcan_update();
-
-			// set digital outputs
-			for (uint8_t i = 0; i < uavcan_dos_blocks_len; i++) {
-				block = &uavcan_dos_blocks[i];
-#if LOGLEVEL >= LOGLEVEL_DEBUG
-				PRINTF("<- DO%d-%d@%d =", block->index,
-				       block->index + block->len - 1,
-				       block->node_id);
-				for (int i = 0; i < block->len; i++) {
-					PRINTF(" %d", block->digital_vals[i]);
-				}
-				PRINTF("\n");
 #endif
-				if (automation_send_set_dos(
-					    block->node_id, block->index,
-					    block->digital_vals, block->len,
-					    CANARD_TRANSFER_PRIORITY_HIGH) <
-				    0) {
-					log_error("DO TX failed");
-				}
-			}
+
+			poll_inputs(uavcan_dis_blocks, uavcan_dis_blocks_len,
+				    true);
+			uavcan_update();
+			poll_inputs(uavcan_ais_blocks, uavcan_ais_blocks_len,
+				    false);
 			uavcan_update();
 
-			// set analog outputs
-			for (uint8_t i = 0; i < uavcan_aos_blocks_len; i++) {
-				block = &uavcan_aos_blocks[i];
-#if LOGLEVEL >= LOGLEVEL_DEBUG
-				PRINTF("<- AO%d-%d@%d =", block->index,
-				       block->index + block->len - 1,
-				       block->node_id);
-				for (int i = 0; i < block->len; i++) {
-					PRINTF(" %d", block->analog_vals[i]);
-				}
-				PRINTF("\n");
-#endif
-				if (automation_send_set_aos(
-					    block->node_id, block->index,
-					    block->analog_vals, block->len,
-					    CANARD_TRANSFER_PRIORITY_HIGH) <
-				    0) {
-					log_error("AO TX failed");
-				}
-			}
+			send_outputs(uavcan_dos_blocks, uavcan_dos_blocks_len,
+				     true);
+			uavcan_update();
+			send_outputs(uavcan_aos_blocks, uavcan_aos_blocks_len,
+				     false);
 			uavcan_update();
 		}
 
 		static uint64_t last_status = 0;
 		if (now - last_status > UAVCAN_STATUS_PERIOD * 1000UL) {
+			uavcan_node_status.vendor_specific_status_code =
+				plc_stats_vendor_status();
 			if (uavcan_broadcast_status() > 0) {
 				last_status = now;
 			}
@@ -159,6 +409,14 @@ void uavcan_task(void *pvParameters)
 
 		uavcan_update();
 
+		check_timeouts();
+
+		// make inputs received in this round available to PLC at once
+		if (ext_inputs_dirty) {
+			ext_inputs_dirty = false;
+			plc_publish_ext_inputs();
+		}
+
 		vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(UAVCAN_RXTX_PERIOD));
 	}
 }
@@ -233,72 +491,382 @@ void uavcan_on_node_status(uint8_t source_node_id,
 {
 	log_com_debug("Node %d uptime = %d", source_node_id,
 		      node_status->uptime_sec);
+#ifdef WITH_DISCOVERY
+	discovery_on_node_status(source_node_id);
+#endif
+#ifdef UAVCAN_NODES_STATUS
+	// health changes
+	const uavcan_remote_node_t *remote =
+		uavcan_get_remote_node(source_node_id);
+	if (remote != NULL) {
+		node_vars_set(remote);
+	}
+#endif
 }
 
-void automation_on_get_dis_response(uint8_t source_node_id, uint8_t index,
-				    bool *values, uint8_t len)
+#if UAVCAN_WITH_NODE_TABLE
+void uavcan_on_remote_node_event(uint8_t node_id,
+				 uavcan_remote_node_event_t event,
+				 const uavcan_remote_node_t *remote)
 {
-#if LOGLEVEL >= LOGLEVEL_DEBUG
-	PRINTF("-> DI%d-%d@%d =", index, index + len - 1, source_node_id);
-	for (int i = 0; i < len; i++) {
-		PRINTF(" %d", values[i]);
+	switch (event) {
+	case UAVCAN_REMOTE_NODE_ONLINE:
+		log_info("Node %d is online", node_id);
+		node_outputs_resend(node_id);
+		break;
+	case UAVCAN_REMOTE_NODE_OFFLINE:
+		log_warning("Node %d is offline", node_id);
+		node_blocks_stale(node_id);
+		break;
+	case UAVCAN_REMOTE_NODE_RESTARTED:
+		log_warning("Node %d restarted", node_id);
+		node_outputs_resend(node_id);
+		break;
 	}
-	PRINTF("\n");
+	node_vars_set(remote);
+}
+#endif
+
+#if UAVCAN_WITH_NODE_INFO_REQUESTS
+void uavcan_on_node_info(uint8_t source_node_id,
+			 uavcan_protocol_GetNodeInfoResponse *info)
+{
+#ifdef WITH_DISCOVERY
+	discovery_on_node_info(source_node_id, info);
+#else
+	log_info("Node %d is %.*s", source_node_id, info->name.len,
+		 (const char *)info->name.data);
 #endif
+}
+#endif
+
+// ---------------------------------------------- parameters -------------------
+
+static uint8_t stale_blocks_count(void)
+{
+	uint8_t count = 0;
+
 	for (uint8_t i = 0; i < uavcan_dis_blocks_len; i++) {
-		uavcan_vals_block_t *block = &uavcan_dis_blocks[i];
-		if (!(block->node_id == source_node_id &&
-		      block->index == index && block->len == len)) {
-			continue;
-		}
-		for (uint8_t j = 0; j < len; j++) {
-			block->digital_vals[j] = values[j];
-		}
-		return;
+		count += !uavcan_dis_blocks[i].fresh;
 	}
-	log_warning("Unexpected DI received");
+	for (uint8_t i = 0; i < uavcan_ais_blocks_len; i++) {
+		count += !uavcan_ais_blocks[i].fresh;
+	}
+	return count;
 }
 
-void automation_on_get_ais_response(uint8_t source_node_id, uint8_t index,
-				    uint16_t *values, uint8_t len)
+static uint32_t diag_get(const param_t *param);
+static void diag_reset(const param_t *param);
+
+#define DIAG(param_name)                                                       \
+	{                                                                      \
+		.name = param_name, .type = PARAM_U32,                         \
+		.flags = PARAM_READ_ONLY, .get = diag_get,                     \
+		.on_set = diag_reset,                                          \
+	}
+
+// Read-only diagnostics, setting any of them resets the scan cycle and bus
+// statistics. diag_get() relies on this order.
+static const param_t diag_params[] = {
+	DIAG("plc.period_us"),
+	DIAG("plc.cycles"),
+	DIAG("plc.overruns"),
+	DIAG("plc.scan_max_us"),
+	DIAG("plc.scan_mean_us"),
+	DIAG("plc.late_max_us"),
+	DIAG("plc.late_mean_us"),
+	DIAG("plc.skipped"),
+	DIAG("uavcan.stale_blocks"),
+	DIAG("uavcan.tx_backlog"),
+	DIAG("uavcan.pool_peak_pct"),
+	DIAG("uavcan.pool_alloc_failures"),
+#if UAVCAN_WITH_STATS
+	DIAG("uavcan.bus_load_pct"),
+	DIAG("uavcan.bus_load_peak_pct"),
+	DIAG("uavcan.tx_queue_peak"),
+	DIAG("uavcan.tx_errors"),
+	DIAG("uavcan.rx_errors"),
+#endif
+};
+
+static uint32_t diag_get(const param_t *param)
 {
-#if LOGLEVEL >= LOGLEVEL_DEBUG
-	PRINTF("-> AI%d-%d@%d =", index, index + len - 1, source_node_id);
-	for (int i = 0; i < len; i++) {
-		PRINTF(" %d", values[i]);
+	plc_stats_t stats;
+	uavcan_pool_stats_t pool;
+#if UAVCAN_WITH_STATS
+	const uavcan_stats_t *bus = uavcan_get_stats();
+#endif
+
+	plc_stats_get(&stats);
+	switch (param - diag_params) {
+	case 0:
+		return stats.period;
+	case 1:
+		return stats.cycles;
+	case 2:
+		return stats.overruns;
+	case 3:
+		return stats.scan.max;
+	case 4:
+		return stats_timing_mean(&stats.scan);
+	case 5:
+		return stats.lateness.max;
+	case 6:
+		return stats_timing_mean(&stats.lateness);
+	case 7:
+		return stats.skipped;
+	case 8:
+		return stale_blocks_count();
+	case 9:
+		return uavcan_tx_backlog();
+	case 10:
+		return uavcan_pool_peak_pct();
+	case 11:
+		uavcan_get_pool_stats(&pool);
+		return pool.alloc_failures;
+#if UAVCAN_WITH_STATS
+	case 12:
+		return bus->bus_load;
+	case 13:
+		return bus->bus_load_peak;
+	case 14:
+		return bus->tx_queue_peak;
+	case 15:
+		return bus->tx_errors + bus->tx_dropped;
+	case 16:
+		return bus->rx_errors + bus->rx_crc_errors + bus->rx_dropped +
+		       bus->decode_errors;
+#endif
 	}
-	PRINTF("\n");
+	return 0;
+}
+
+static void diag_reset(const param_t *param)
+{
+	plc_stats_reset();
+#if UAVCAN_WITH_STATS
+	uavcan_stats_reset();
 #endif
-	for (uint8_t i = 0; i < uavcan_ais_blocks_len; i++) {
-		uavcan_vals_block_t *block = &uavcan_ais_blocks[i];
-		if (!(block->node_id == source_node_id &&
-		      block->index == index && block->len == len)) {
-			continue;
-		}
-		for (uint8_t j = 0; j < len; j++) {
-			block->analog_vals[j] = values[j];
-		}
+}
+
+#ifdef WITH_DISCOVERY
+static uint32_t discovered_nodes_get(const param_t *param)
+{
+	return discovery_nodes_num();
+}
+
+static void discovered_nodes_forget(const param_t *param)
+{
+	if (discovery_forget()) {
+		log_error("Failed to forget discovered nodes");
+	}
+}
+#endif
+
+static const param_t uavcan_params[] = {
+	{
+		// remote IO is exchanged once per this period, 0 once per PLC
+		// scan (PLC program task interval) [us]
+		.name = "uavcan.io_period_us",
+		.type = PARAM_U32,
+		.flags = PARAM_PERSISTENT,
+		.value = &io_period,
+		.def = 0,
+		.min = 0,
+		.max = 10000000,
+	},
+	{
+		.name = "uavcan.outputs_refresh_ms",
+		.type = PARAM_U32,
+		.flags = PARAM_PERSISTENT,
+		.value = &outputs_refresh_period,
+		.def = UAVCAN_OUTPUTS_REFRESH_PERIOD,
+		.min = 0,
+		.max = 60000,
+	},
+	{
+		.name = "uavcan.request_timeout_ms",
+		.type = PARAM_U32,
+		.flags = PARAM_PERSISTENT,
+		.value = &request_timeout,
+		.def = UAVCAN_REQUEST_TIMEOUT,
+		.min = 1,
+		.max = 10000,
+	},
+	{
+		.name = "uavcan.tell_timeout_ms",
+		.type = PARAM_U32,
+		.flags = PARAM_PERSISTENT,
+		.value = &tell_timeout,
+		.def = UAVCAN_TELL_TIMEOUT,
+		.min = 1,
+		.max = 60000,
+	},
+#ifdef WITH_DISCOVERY
+	{
+		// number of mapped nodes, setting it forgets the stored nodes
+		// so they are discovered again at the next start
+		.name = "uavcan.discovered_nodes",
+		.type = PARAM_U32,
+		.flags = PARAM_READ_ONLY,
+		.get = discovered_nodes_get,
+		.on_set = discovered_nodes_forget,
+	},
+#endif
+};
+
+static int params_init(void)
+{
+	if (params_register(diag_params,
+			    sizeof(diag_params) / sizeof(diag_params[0])) ||
+	    params_register(uavcan_params,
+			    sizeof(uavcan_params) / sizeof(uavcan_params[0]))) {
+		return -1;
+	}
+	return 0;
+}
+
+// ---------------------------------------------- automation callbacks ---------
+
+/*
+Responses and told values are decoded straight to the blocks (i.e. to ext_dis,
+ext_ais), there's no intermediate copy.
+*/
+#if LOGLEVEL >= LOGLEVEL_DEBUG
+#define PRINT_VALS(type, block, vals)                                          \
+	do {                                                                   \
+		PRINTF("-> %s%d-%d@%d =", type, block->index,                  \
+		       block->index + block->len - 1, block->node_id);         \
+		for (int i = 0; i < block->len; i++) {                         \
+			PRINTF(" %d", block->vals[i]);                         \
+		}                                                              \
+		PRINTF("\n");                                                  \
+	} while (0)
+#else
+#define PRINT_VALS(type, block, vals)
+#endif
+
+void automation_on_get_dis_response(uint8_t source_node_id,
+				    uint8_t transfer_id, uint8_t index,
+				    const automation_values_t *values)
+{
+	uavcan_vals_block_t *block =
+		request_done(source_node_id, transfer_id, true);
+	if (block == NULL || block->index != index ||
+	    block->len != values->len) {
+		log_warning("Unexpected DI received");
+		return;
+	}
+	if (!automation_read_dis(values, 0, values->len,
+				 block->digital_vals)) {
+		log_error("DI decode failed");
+		return;
+	}
+	PRINT_VALS("DI", block, digital_vals);
+	block_set_fresh(block, true);
+	ext_inputs_dirty = true;
+}
+
+void automation_on_get_ais_response(uint8_t source_node_id,
+				    uint8_t transfer_id, uint8_t index,
+				    const automation_values_t *values)
+{
+	uavcan_vals_block_t *block =
+		request_done(source_node_id, transfer_id, false);
+	if (block == NULL || block->index != index ||
+	    block->len != values->len) {
+		log_warning("Unexpected AI received");
 		return;
 	}
-	log_warning("Unexpected AI received");
+	if (!automation_read_ais(values, 0, values->len,
+				 block->analog_vals)) {
+		log_error("AI decode failed");
+		return;
+	}
+	PRINT_VALS("AI", block, analog_vals);
+	block_set_fresh(block, true);
+	ext_inputs_dirty = true;
 }
 
-// digital inputs broadcast - handle in the same manner as request responses
-void automation_on_tell_dis(uint8_t source_node_id, uint8_t index, bool *values,
-			    uint8_t len)
+#undef PRINT_VALS
+
+// the node refused the request, no point in waiting for the timeout
+void automation_on_get_values_error(uint8_t source_node_id,
+				    uint8_t transfer_id, uint8_t index,
+				    uint8_t result)
 {
-	automation_on_get_dis_response(source_node_id, index, values, len);
+	bool digital = true;
+	uavcan_vals_block_t *block =
+		request_done(source_node_id, transfer_id, digital);
+	if (block == NULL) {
+		digital = false;
+		block = request_done(source_node_id, transfer_id, digital);
+	}
+	if (block == NULL) {
+		log_warning("Unexpected GetValues error received");
+		return;
+	}
+	log_error("Node %d %s %d-%d: GetValues error %d", block->node_id,
+		  digital ? "DI" : "AI", block->index,
+		  block->index + block->len - 1, result);
+	block_set_fresh(block, false);
+}
+
+/*
+Inputs broadcast. Unlike responses, told range does not have to match any block
+(node tells just what has changed), so overlapping parts of all node's blocks
+are updated.
+*/
+#define TELL_TO_BLOCKS(blocks_index, vals, read)                               \
+	for (uint8_t i = blocks_index.node_first[source_node_id];              \
+	     i < blocks_index.node_first[source_node_id + 1]; i++) {           \
+		uavcan_vals_block_t *block = blocks_index.blocks[i];           \
+		int from = max(block->index, index);                           \
+		int to = min(block->index + block->len, index + values->len);  \
+		if (from >= to) {                                              \
+			continue;                                              \
+		}                                                              \
+		if (!read(values, from - index, to - from,                     \
+			  &block->vals[from - block->index])) {                \
+			log_error("Told values decode failed");                \
+			return;                                                \
+		}                                                              \
+		ext_inputs_dirty = true;                                       \
+		block_set_fresh(block, true);                                  \
+	}
+
+void automation_on_tell_dis(uint8_t source_node_id, uint8_t index,
+			    const automation_values_t *values)
+{
+	TELL_TO_BLOCKS(uavcan_dis_index, digital_vals, automation_read_dis);
 }
 
-// analog inputs broadcast - handle in the same manner as request responses
 void automation_on_tell_ais(uint8_t source_node_id, uint8_t index,
-			    uint16_t *values, uint8_t len)
+			    const automation_values_t *values)
 {
-	automation_on_get_ais_response(source_node_id, index, values, len);
+	TELL_TO_BLOCKS(uavcan_ais_index, analog_vals, automation_read_ais);
+}
+
+#undef TELL_TO_BLOCKS
+
+void automation_on_get_inventory_response(
+	uint8_t source_node_id, uint8_t transfer_id,
+	const automation_GetInventoryResponse *inventory)
+{
+#ifdef WITH_DISCOVERY
+	discovery_on_inventory(source_node_id, transfer_id, inventory);
+#else
+	log_warning("Unexpected inventory of node %d", source_node_id);
+#endif
 }
 
 // ------------------------------------ unsupported requests -------------------
 
+void automation_on_sync(uint8_t source_node_id, uint8_t counter)
+{
+	log_warning("Node %d is sending Sync too!", source_node_id);
+}
+
 uint8_t automation_set_dos(uint8_t source_node_id, uint8_t index,
 			   const bool *values, uint8_t len)
 {
@@ -327,4 +895,11 @@ uint8_t automation_get_ais(uint8_t source_node_id, uint8_t index,
 	return AUTOMATION_GETVALUES_RESPONSE_BAD_ARGUMENT;
 }
 
+void automation_get_inventory(uint8_t source_node_id,
+			      automation_GetInventoryResponse *inventory)
+{
+	// no IO to be mapped by others, inventory is left empty
+	log_warning("Node %d is asking for my inventory", source_node_id);
+}
+
 #endif
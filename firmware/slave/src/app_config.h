@@ -64,12 +64,50 @@
 
 #endif // #ifdef STM32F1
 
+#if defined(__unix__)
+
+// host build - pins are simulated, see hal_posix.c
+#define DIS_PINS                                                               \
+	{                                                                      \
+		0, 1, 2, 3                                                     \
+	}
+#define AIS_PINS                                                               \
+	{                                                                      \
+		4, 5                                                           \
+	}
+#define DOS_PINS                                                               \
+	{                                                                      \
+		6, 7, 8, 9                                                     \
+	}
+#define AOS_PINS                                                               \
+	{                                                                      \
+		10, 11                                                         \
+	}
+
+#endif // #if defined(__unix__)
+
 // ---------------------------------------------- communication ----------------
 
 #define APP_NAME "PeaLC-slave"
 #define APP_VERSION_MAJOR 0
 #define APP_VERSION_MINOR 1
 
+// slave is useless without CAN
+#define WITH_CAN
+
+// broadcast inputs on change, PLC does not need to poll them then
+#define WITH_TELL_INPUTS
+
+// latch inputs and apply outputs on Sync from PLC
+#define WITH_SYNC
+
+// set outputs to FAILSAFE_DOS, FAILSAFE_AOS (all off by default) when PLC goes
+// offline or restarts
+#define WITH_FAILSAFE
+
+// room for the parameters of slave_params (uavcan_impl.c)
+#define PARAMS_MAX 8
+
 // ---------------------------------------------- defaults & internal ----------
 
 #include "app_config_defaults.h"
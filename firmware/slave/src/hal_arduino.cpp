@@ -117,6 +117,137 @@ int get_ai_pin_value(int pin, uint16_t *value)
 	return 0;
 }
 
+// ---------------------------------------------- storage ----------------------
+
+/*
+EEPROM (emulated in flash on STM32) holds a single value: a header with hash of
+its key and length, then the value itself. Saving a key replaces the value of
+any other one, slave firmware stores just parameters.
+*/
+
+#if defined(__AVR__)
+#include <avr/eeprom.h>
+#elif defined(STM32)
+#include <stm32_eeprom.h>
+#endif
+
+typedef struct {
+	uint32_t key_hash;
+	uint16_t len;
+} storage_header_t;
+
+// E2END is the last EEPROM address
+#define STORAGE_SIZE (E2END + 1 - sizeof(storage_header_t))
+
+// FNV-1a, never 0xFFFFFFFF (erased EEPROM)
+static uint32_t key_hash(const char *key)
+{
+	uint32_t hash = 2166136261UL;
+
+	while (*key) {
+		hash ^= (uint8_t)*key++;
+		hash *= 16777619UL;
+	}
+	return (hash == 0xFFFFFFFFUL) ? 0 : hash;
+}
+
+#if defined(__AVR__)
+static void storage_read(uint16_t addr, void *buff, size_t len)
+{
+	eeprom_read_block(buff, (const void *)(uintptr_t)addr, len);
+}
+
+// only changed bytes are written, EEPROM wears out
+static void storage_write(uint16_t addr, const void *data, size_t len)
+{
+	eeprom_update_block(data, (void *)(uintptr_t)addr, len);
+}
+
+static void storage_commit(void)
+{
+}
+#elif defined(STM32)
+// Flash page is copied to RAM buffer at first access, written back (erased
+// and programmed) by storage_commit() only if something changed.
+static bool buffer_filled = false;
+static bool buffer_changed = false;
+
+static void buffer_fill(void)
+{
+	if (!buffer_filled) {
+		eeprom_buffer_fill();
+		buffer_filled = true;
+	}
+}
+
+static void storage_read(uint16_t addr, void *buff, size_t len)
+{
+	buffer_fill();
+	for (size_t i = 0; i < len; i++) {
+		((uint8_t *)buff)[i] = eeprom_buffered_read_byte(addr + i);
+	}
+}
+
+static void storage_write(uint16_t addr, const void *data, size_t len)
+{
+	buffer_fill();
+	for (size_t i = 0; i < len; i++) {
+		uint8_t byte = ((const uint8_t *)data)[i];
+		if (eeprom_buffered_read_byte(addr + i) != byte) {
+			eeprom_buffered_write_byte(addr + i, byte);
+			buffer_changed = true;
+		}
+	}
+}
+
+static void storage_commit(void)
+{
+	if (buffer_changed) {
+		eeprom_buffer_flush();
+		buffer_changed = false;
+	}
+}
+#endif
+
+int hal_storage_load(const char *key, void *buff, size_t len)
+{
+	storage_header_t header;
+
+	storage_read(0, &header, sizeof(header));
+	if (header.key_hash != key_hash(key) || header.len > len ||
+	    header.len > STORAGE_SIZE) {
+		return -1;
+	}
+	storage_read(sizeof(header), buff, header.len);
+	return header.len;
+}
+
+int hal_storage_save(const char *key, const void *data, size_t len)
+{
+	storage_header_t header = { key_hash(key), (uint16_t)len };
+
+	if (len > STORAGE_SIZE) {
+		return -1;
+	}
+	storage_write(0, &header, sizeof(header));
+	storage_write(sizeof(header), data, len);
+	storage_commit();
+	return 0;
+}
+
+int hal_storage_erase(const char *key)
+{
+	storage_header_t header;
+
+	storage_read(0, &header, sizeof(header));
+	if (header.key_hash == key_hash(key)) {
+		header.key_hash = 0xFFFFFFFFUL;
+		storage_write(0, &header, sizeof(header));
+		storage_commit();
+	}
+	return 0;
+}
+
 // ---------------------------------------------- misc -------------------------
 
 void die(uint8_t reason)
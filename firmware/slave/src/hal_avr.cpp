@@ -22,6 +22,23 @@ int can2_init()
 		return -1;
 	}
 
+	// RXB0 has mask 0 and filters 0-1, RXB1 mask 1 and filters 2-5 =>
+	// one planned filter per RX buffer
+	uavcan_can_filter_t filters[2];
+	uint8_t len = uavcan_plan_filters(filters, 2);
+	if (len == 1) {
+		filters[1] = filters[0];
+	}
+	if (len > 0) {
+		CAN0.init_Mask(0, 1, filters[0].mask);
+		CAN0.init_Filt(0, 1, filters[0].id);
+		CAN0.init_Filt(1, 1, filters[0].id);
+		CAN0.init_Mask(1, 1, filters[1].mask);
+		for (uint8_t i = 2; i < 6; i++) {
+			CAN0.init_Filt(i, 1, filters[1].id);
+		}
+	}
+
 	return 0;
 }
 
@@ -43,7 +60,7 @@ void uavcan_restart(void)
 	reset();
 }
 
-int uavcan_can_rx(CanardCANFrame *frame)
+int uavcan_can_rx(CanardCANFrame *frame, uint64_t *timestamp_usec)
 {
 	if (CAN0.checkReceive() != CAN_MSGAVAIL) {
 		return 0;
@@ -70,15 +87,19 @@ int uavcan_can_rx(CanardCANFrame *frame)
 
 int uavcan_can_tx(const CanardCANFrame *frame)
 {
-#if LOGLEVEL >= LOGLEVEL_DEBUG
-	print_frame("<-", frame);
-#endif
-
 	unsigned long id2 =
 		frame->id & (~(CANARD_CAN_FRAME_EFF | CANARD_CAN_FRAME_ERR |
 			       CANARD_CAN_FRAME_RTR));
 	byte ext = (frame->id & CANARD_CAN_FRAME_EFF) ? 1 : 0;
-	CAN0.sendMsgBuf(id2, ext, frame->data_len, (byte *)frame->data);
+	// CAN_SENDMSGTIMEOUT: the frame is in TX buffer, it's just not sent yet
+	if (CAN0.sendMsgBuf(id2, ext, frame->data_len, (byte *)frame->data) ==
+	    CAN_GETTXBFTIMEOUT) {
+		return UAVCAN_CAN_TX_BUSY;
+	}
+
+#if LOGLEVEL >= LOGLEVEL_DEBUG
+	print_frame("<-", frame);
+#endif
 
 	ui_can_tx();
 
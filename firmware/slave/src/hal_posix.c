@@ -0,0 +1 @@
+../../plc/src/hal_posix.c
\ No newline at end of file
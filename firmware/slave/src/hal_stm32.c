@@ -28,6 +28,75 @@
 
 static CAN_HandleTypeDef hcan;
 
+// STM32F1 with single CAN has 14 filter banks
+#define CAN_FILTER_BANKS 14
+
+// RX ring buffer, filled by RX interrupts, drained by uavcan_can_rx()
+#if CAN_RX_BUFF_SIZE < 2 || (CAN_RX_BUFF_SIZE & (CAN_RX_BUFF_SIZE - 1))
+#error "CAN_RX_BUFF_SIZE must be a power of 2"
+#endif
+
+typedef struct {
+	CanardCANFrame frame;
+	uint32_t timestamp; // [us]
+} can_rx_item_t;
+
+static can_rx_item_t can_rx_buff[CAN_RX_BUFF_SIZE];
+// written only by ISR
+static volatile uint16_t can_rx_head = 0;
+// written only by uavcan_can_rx()
+static volatile uint16_t can_rx_tail = 0;
+
+// frames lost because the ring buffer was full
+static volatile uint32_t can_rx_overflows = 0;
+// frames lost in hardware FIFOs (not drained in time)
+static volatile uint32_t can_fifo_overruns = 0;
+
+/*
+Program filter banks with filters planned from accepted transfers. Frames of
+service transfers (to this node) go to FIFO1, everything else to FIFO0, so that
+the ISR has 6 mailboxes to drain.
+*/
+static int can_config_filters(void)
+{
+	uavcan_can_filter_t filters[CAN_FILTER_BANKS];
+	uint8_t len = uavcan_plan_filters(filters, CAN_FILTER_BANKS);
+
+	if (len == 0) {
+		// accept all
+		filters[0].id = 0;
+		filters[0].mask = 0;
+		len = 1;
+	}
+
+	for (uint8_t i = 0; i < len; i++) {
+		uavcan_can_filter_t *f = &filters[i];
+		// 32 bit filter registers: ID << 3 | IDE | RTR | 0
+		uint32_t id = (f->id << 3) | CAN_ID_EXT;
+		uint32_t mask = (f->mask << 3) | CAN_ID_EXT;
+		CAN_FilterTypeDef filter;
+
+		filter.FilterBank = i;
+		filter.FilterMode = CAN_FILTERMODE_IDMASK;
+		filter.FilterScale = CAN_FILTERSCALE_32BIT;
+		filter.FilterIdHigh = id >> 16;
+		filter.FilterIdLow = id & 0xFFFF;
+		filter.FilterMaskIdHigh = mask >> 16;
+		filter.FilterMaskIdLow = mask & 0xFFFF;
+		filter.FilterFIFOAssignment =
+			(f->mask & f->id & UAVCAN_FILTER_SERVICE_BIT) ?
+				CAN_RX_FIFO1 :
+				CAN_RX_FIFO0;
+		filter.FilterActivation = ENABLE;
+		filter.SlaveStartFilterBank = CAN_FILTER_BANKS;
+		if (HAL_CAN_ConfigFilter(&hcan, &filter) != HAL_OK) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
 int can2_init()
 {
 	hcan.Instance = CAN1;
@@ -56,25 +125,28 @@ int can2_init()
 		return -1;
 	}
 
-	CAN_FilterTypeDef filter;
-	filter.FilterBank = 0;
-	filter.FilterMode = CAN_FILTERMODE_IDMASK;
-	filter.FilterScale = CAN_FILTERSCALE_32BIT;
-	filter.FilterIdHigh = 0;
-	filter.FilterIdLow = 0;
-	filter.FilterMaskIdHigh = 0;
-	filter.FilterMaskIdLow = 0;
-	filter.FilterFIFOAssignment = CAN_RX_FIFO0;
-	filter.FilterActivation = ENABLE;
-	filter.SlaveStartFilterBank = 14;
-	if (HAL_CAN_ConfigFilter(&hcan, &filter) != HAL_OK) {
+	if (can_config_filters()) {
 		log_error("CAN filter config failed");
 		return -1;
 	}
 
-	//HAL_NVIC_SetPriority(CAN1_RX0_IRQn, 1, 0);
-	//HAL_NVIC_EnableIRQ(CAN1_RX0_IRQn);
-	//HAL_CAN_ActivateNotification(&hcan, CAN_IT_RX_FIFO0_MSG_PENDING);
+	// CAN1 RX0 IRQ is shared with USB, which is not used
+	HAL_NVIC_SetPriority(USB_LP_CAN1_RX0_IRQn, 1, 0);
+	HAL_NVIC_EnableIRQ(USB_LP_CAN1_RX0_IRQn);
+	HAL_NVIC_SetPriority(CAN1_RX1_IRQn, 1, 0);
+	HAL_NVIC_EnableIRQ(CAN1_RX1_IRQn);
+	// FIFO overruns are reported through SCE interrupt
+	HAL_NVIC_SetPriority(CAN1_SCE_IRQn, 1, 0);
+	HAL_NVIC_EnableIRQ(CAN1_SCE_IRQn);
+	if (HAL_CAN_ActivateNotification(
+		    &hcan, CAN_IT_RX_FIFO0_MSG_PENDING |
+				   CAN_IT_RX_FIFO1_MSG_PENDING |
+				   CAN_IT_RX_FIFO0_OVERRUN |
+				   CAN_IT_RX_FIFO1_OVERRUN | CAN_IT_ERROR) !=
+	    HAL_OK) {
+		log_error("CAN interrupts config failed");
+		return -1;
+	}
 
 	if (HAL_CAN_Start(&hcan) != HAL_OK) {
 		log_error("CAN start failed");
@@ -137,6 +209,83 @@ void HAL_CAN_MspDeInit(CAN_HandleTypeDef *canHandle)
 	}
 }
 
+// ---------------------------------------------- CAN interrupts --------------
+
+void USB_LP_CAN1_RX0_IRQHandler(void)
+{
+	HAL_CAN_IRQHandler(&hcan);
+}
+
+void CAN1_RX1_IRQHandler(void)
+{
+	HAL_CAN_IRQHandler(&hcan);
+}
+
+void CAN1_SCE_IRQHandler(void)
+{
+	HAL_CAN_IRQHandler(&hcan);
+}
+
+static void can_rx_drain(CAN_HandleTypeDef *h, uint32_t fifo)
+{
+	CAN_RxHeaderTypeDef header;
+	uint32_t timestamp = hal_uptime_usec();
+
+	while (HAL_CAN_GetRxFifoFillLevel(h, fifo) > 0) {
+		uint16_t head = can_rx_head;
+		uint16_t next = (head + 1) & (CAN_RX_BUFF_SIZE - 1);
+		uint8_t dummy[8];
+
+		if (next == can_rx_tail) {
+			// full => release the mailbox anyway, drop the frame
+			HAL_CAN_GetRxMessage(h, fifo, &header, dummy);
+			can_rx_overflows++;
+			continue;
+		}
+
+		CanardCANFrame *frame = &can_rx_buff[head].frame;
+		if (HAL_CAN_GetRxMessage(h, fifo, &header, frame->data) !=
+		    HAL_OK) {
+			return;
+		}
+
+		// Set UAVCAN frame flags
+		if (header.IDE == CAN_ID_EXT) {
+			frame->id = header.ExtId | CANARD_CAN_FRAME_EFF;
+		} else {
+			frame->id = header.StdId;
+		}
+		if (header.RTR == CAN_RTR_REMOTE) {
+			frame->id |= CANARD_CAN_FRAME_RTR;
+		}
+		// TODO: error flag?!
+		frame->data_len = header.DLC;
+		can_rx_buff[head].timestamp = timestamp;
+
+		// publish the item after it's written
+		__DMB();
+		can_rx_head = next;
+	}
+}
+
+void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *h)
+{
+	can_rx_drain(h, CAN_RX_FIFO0);
+}
+
+void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef *h)
+{
+	can_rx_drain(h, CAN_RX_FIFO1);
+}
+
+void HAL_CAN_ErrorCallback(CAN_HandleTypeDef *h)
+{
+	if (h->ErrorCode & (HAL_CAN_ERROR_RX_FOV0 | HAL_CAN_ERROR_RX_FOV1)) {
+		can_fifo_overruns++;
+	}
+	HAL_CAN_ResetError(h);
+}
+
 // ---------------------------------------------- UAVCAN -----------------------
 
 void uavcan_get_unique_id(
@@ -163,29 +312,33 @@ void uavcan_restart(void)
 	NVIC_SystemReset();
 }
 
-int uavcan_can_rx(CanardCANFrame *frame)
+int uavcan_can_rx(CanardCANFrame *frame, uint64_t *timestamp_usec)
 {
-	CAN_RxHeaderTypeDef header;
-
-	if (HAL_CAN_GetRxFifoFillLevel(&hcan, CAN_RX_FIFO0) == 0)
-		return 0;
+	static uint32_t reported_overflows = 0;
+	static uint32_t reported_overruns = 0;
+
+	if (reported_overflows != can_rx_overflows ||
+	    reported_overruns != can_fifo_overruns) {
+		reported_overflows = can_rx_overflows;
+		reported_overruns = can_fifo_overruns;
+		log_error("CAN RX lost (buffer full %lu, FIFO overrun %lu)",
+			  reported_overflows, reported_overruns);
+	}
 
-	if (HAL_CAN_GetRxMessage(&hcan, CAN_RX_FIFO0, &header, frame->data) !=
-	    HAL_OK)
+	uint16_t tail = can_rx_tail;
+	if (tail == can_rx_head) {
 		return 0;
-
-	// Set UAVCAN frame flags
-	if (header.IDE == CAN_ID_EXT) {
-		frame->id = header.ExtId | CANARD_CAN_FRAME_EFF;
-	} else {
-		frame->id = header.StdId;
-	}
-	if (header.RTR == CAN_RTR_REMOTE) {
-		frame->id |= CANARD_CAN_FRAME_RTR;
 	}
-	// TODO: error flag?!
+	// read the item after head was read
+	__DMB();
 
-	frame->data_len = header.DLC;
+	*frame = can_rx_buff[tail].frame;
+	// RX time of the frame
+	uint32_t age = (uint32_t)*timestamp_usec - can_rx_buff[tail].timestamp;
+	*timestamp_usec -= age;
+
+	__DMB();
+	can_rx_tail = (tail + 1) & (CAN_RX_BUFF_SIZE - 1);
 
 #if LOGLEVEL >= LOGLEVEL_DEBUG
 	print_frame("->", frame);
@@ -221,6 +374,10 @@ int uavcan_can_tx(const CanardCANFrame *frame)
 						   CANARD_CAN_FRAME_RTR));
 	}
 
+	if (HAL_CAN_GetTxMailboxesFreeLevel(&hcan) == 0) {
+		return UAVCAN_CAN_TX_BUSY;
+	}
+
 #if LOGLEVEL >= LOGLEVEL_DEBUG
 	print_frame("<-", frame);
 #endif
@@ -1,4 +1,6 @@
+#if defined(ARDUINO)
 #include <Arduino.h>
+#endif
 
 #include <uavcan_node.h>
 
@@ -6,6 +8,8 @@
 #include "dallas.h"
 #include "hal.h"
 #include "io.h"
+#include "params.h"
+#include "tools.h"
 #include "ui.h"
 #include "uavcan_impl.h"
 
@@ -49,13 +53,34 @@ void loop()
 		uint32_t now = hal_uptime_msec();
 		static uint32_t last_status = 0;
 		if (now - last_status > UAVCAN_STATUS_PERIOD) {
+			uavcan_node_status.vendor_specific_status_code =
+				uavcan_vendor_status();
 			if (uavcan_broadcast_status() > 0) {
 				last_status = now;
 			}
 		}
 #ifdef WITH_DALLAS
 		dallas_update();
+#endif
+#ifdef WITH_TELL_INPUTS
+		MAX_ONCE_PER(tell_sample_period, { uavcan_tell_inputs(); });
+#endif
+#ifdef WITH_SYNC
+		uavcan_check_sync();
 #endif
 		uavcan_update();
+#if UAVCAN_WITH_PARAM_GETSET
+		params_update();
+#endif
 	}
-}
\ No newline at end of file
+}
+
+#ifdef POSIX
+int main()
+{
+	setup();
+	loop();
+	die(DEATH_UNREACHABLE_REACHED);
+	return 0;
+}
+#endif // ifdef POSIX
@@ -0,0 +1 @@
+../../plc/src/params.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../plc/src/params.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../plc/src/rtos_posix.h
\ No newline at end of file
@@ -1,27 +1,48 @@
+#if defined(ARDUINO)
 #include <Arduino.h>
+#endif
+
+#include <stdarg.h>
+#include <string.h>
 
 #include "uavcan_node.h"
 #include "uavcan_automation.h"
 
 #include "automation/SetValues.h"
 #include "automation/GetValues.h"
+#include "automation/AnalogValues.h"
+#include "automation/DigitalValues.h"
 
 #include "app_config.h"
 #include "hal.h"
 #include "io.h"
+#include "params.h"
+#include "tools.h"
 #include "uavcan_impl.h"
 
+// tunable by parameters (see slave_params)
+#ifdef WITH_TELL_INPUTS
+uint16_t tell_sample_period = TELL_SAMPLE_PERIOD;
+static uint16_t tell_refresh_period = TELL_REFRESH_PERIOD;
+static uint16_t tell_ai_deadband = TELL_AI_DEADBAND;
+#endif
+#ifdef WITH_SYNC
+static uint16_t sync_timeout = SYNC_TIMEOUT;
+#endif
+
+static int params_init(void);
+
 int uavcan2_init()
 {
+	// init UAVCAN, CAN filters planned by can2_init() need the node ID
+	uavcan_init();
+
 	// init CAN HW
 	int res;
 	if ((res = can2_init())) {
 		return res;
 	}
 
-	// init UAVCAN
-	uavcan_init();
-
 	uavcan_node_status.health = UAVCAN_PROTOCOL_NODESTATUS_HEALTH_OK;
 	uavcan_node_status.mode =
 		UAVCAN_PROTOCOL_NODESTATUS_MODE_INITIALIZATION;
@@ -39,9 +60,23 @@ int uavcan2_init()
 	uavcan_node_info.name.data = (uint8_t *)APP_NAME;
 	uavcan_node_info.name.len = strlen(APP_NAME);
 
+	if ((res = params_init())) {
+		return res;
+	}
+
 	return 0;
 }
 
+uint16_t uavcan_vendor_status()
+{
+	uavcan_pool_stats_t pool;
+
+	uavcan_get_pool_stats(&pool);
+	uint8_t failures =
+		(pool.alloc_failures > 255) ? 255 : pool.alloc_failures;
+	return ((uint16_t)failures << 8) | uavcan_pool_peak_pct();
+}
+
 bool uavcan_user_should_accept_transfer(const CanardInstance *ins,
 					uint64_t *out_data_type_signature,
 					uint16_t data_type_id,
@@ -82,9 +117,159 @@ void print_frame(const char *direction, const CanardCANFrame *frame)
 	PRINTS("\n");
 }
 
+// ---------------------------------------------- sync -------------------------
+
+#ifdef WITH_SYNC
+/*
+Sync mode is on while Sync messages keep coming. Inputs are served from the
+snapshot latched on the last Sync then, and outputs are staged until the next
+one. Without Sync (or when it stops), inputs and outputs are accessed directly.
+*/
+static bool sync_on = false;
+static uint32_t last_sync;
+static uint8_t last_sync_counter;
+
+static bool synced_dis[IO_DIS_NUM];
+static uint16_t synced_ais[IO_AIS_NUM];
+static bool staged_dos[IO_DOS_NUM];
+static uint16_t staged_aos[IO_AOS_NUM];
+// staged output is to be applied
+static bool staged_dos_set[IO_DOS_NUM];
+static bool staged_aos_set[IO_AOS_NUM];
+
+static void apply_staged_outputs(void)
+{
+	for (uint8_t i = 0; i < IO_DOS_NUM; i++) {
+		if (staged_dos_set[i]) {
+			staged_dos_set[i] = false;
+			io_set_do(i, staged_dos[i]);
+		}
+	}
+	for (uint8_t i = 0; i < IO_AOS_NUM; i++) {
+		if (staged_aos_set[i]) {
+			staged_aos_set[i] = false;
+			io_set_ao(i, staged_aos[i]);
+		}
+	}
+}
+
+void automation_on_sync(uint8_t source_node_id, uint8_t counter)
+{
+	if (sync_on && counter != (uint8_t)(last_sync_counter + 1)) {
+		PRINTS("Sync missed\n");
+	}
+	last_sync_counter = counter;
+	last_sync = hal_uptime_msec();
+	sync_on = true;
+
+	for (uint8_t i = 0; i < IO_DIS_NUM; i++) {
+		io_get_di(i, &synced_dis[i]);
+	}
+	for (uint8_t i = 0; i < IO_AIS_NUM; i++) {
+		io_get_ai(i, &synced_ais[i]);
+	}
+	apply_staged_outputs();
+}
+
+void uavcan_check_sync()
+{
+	if (sync_on && hal_uptime_msec() - last_sync > sync_timeout) {
+		PRINTS("Sync lost\n");
+		sync_on = false;
+		apply_staged_outputs();
+	}
+}
+#else
+void automation_on_sync(uint8_t source_node_id, uint8_t counter)
+{
+}
+#endif // ifdef WITH_SYNC
+
+// ---------------------------------------------- failsafe ---------------------
+
+#ifdef WITH_FAILSAFE
+/*
+The master is the node which set outputs last time. When it goes offline or
+restarts (it does not know outputs state then), outputs are set to the safe
+values and kept until the master (or another node) sets them again. The master
+is pinned in the node table, so other nodes can't take its entry.
+*/
+static uint8_t master_node_id = CANARD_BROADCAST_NODE_ID; // none yet
+static bool failsafe_on = false;
+
+static const bool failsafe_dos[IO_DOS_NUM] = FAILSAFE_DOS;
+static const uint16_t failsafe_aos[IO_AOS_NUM] = FAILSAFE_AOS;
+
+static void failsafe_enter(const char *reason)
+{
+	PRINTS("Failsafe, master ");
+	PRINTS(reason);
+	PRINTS("\n");
+	failsafe_on = true;
+#ifdef WITH_SYNC
+	// outputs staged by the lost master must not be applied later
+	memset(staged_dos_set, 0, sizeof(staged_dos_set));
+	memset(staged_aos_set, 0, sizeof(staged_aos_set));
+#endif
+	for (uint8_t i = 0; i < IO_DOS_NUM; i++) {
+		io_set_do(i, failsafe_dos[i]);
+	}
+	for (uint8_t i = 0; i < IO_AOS_NUM; i++) {
+		io_set_ao(i, failsafe_aos[i]);
+	}
+	uavcan_node_status.health = UAVCAN_PROTOCOL_NODESTATUS_HEALTH_WARNING;
+}
+
+static void master_sets_outputs(uint8_t source_node_id)
+{
+	if (source_node_id != master_node_id) {
+		uavcan_pin_remote_node(master_node_id, false);
+		uavcan_pin_remote_node(source_node_id, true);
+	}
+	master_node_id = source_node_id;
+	if (failsafe_on) {
+		PRINTS("Failsafe off\n");
+		failsafe_on = false;
+		uavcan_node_status.health =
+			UAVCAN_PROTOCOL_NODESTATUS_HEALTH_OK;
+	}
+}
+
+void uavcan_on_remote_node_event(uint8_t node_id,
+				 uavcan_remote_node_event_t event,
+				 const uavcan_remote_node_t *remote)
+{
+	if (node_id != master_node_id || failsafe_on) {
+		return;
+	}
+	if (event == UAVCAN_REMOTE_NODE_OFFLINE) {
+		failsafe_enter("offline");
+	} else if (event == UAVCAN_REMOTE_NODE_RESTARTED) {
+		failsafe_enter("restarted");
+	}
+}
+#else
+#define master_sets_outputs(source_node_id)
+#endif // ifdef WITH_FAILSAFE
+
+// ---------------------------------------------- IO requests ------------------
+
 uint8_t automation_set_dos(uint8_t source_node_id, uint8_t start_index,
 			   const bool *values, uint8_t len)
 {
+	master_sets_outputs(source_node_id);
+#ifdef WITH_SYNC
+	if (sync_on) {
+		if (start_index + len > IO_DOS_NUM) {
+			return 1;
+		}
+		for (int i = 0; i < len; i++) {
+			staged_dos[start_index + i] = values[i];
+			staged_dos_set[start_index + i] = true;
+		}
+		return 0;
+	}
+#endif
 	for (int i = 0; i < len; i++) {
 		if (io_set_do(start_index + i, values[i]) != IO_OK) {
 			return 1;
@@ -109,6 +294,19 @@ uint8_t automation_set_dos(uint8_t source_node_id, uint8_t start_index,
 uint8_t automation_set_aos(uint8_t source_node_id, uint8_t start_index,
 			   const uint16_t *values, uint8_t len)
 {
+	master_sets_outputs(source_node_id);
+#ifdef WITH_SYNC
+	if (sync_on) {
+		if (start_index + len > IO_AOS_NUM) {
+			return 1;
+		}
+		for (int i = 0; i < len; i++) {
+			staged_aos[start_index + i] = values[i];
+			staged_aos_set[start_index + i] = true;
+		}
+		return 0;
+	}
+#endif
 	for (int i = 0; i < len; i++) {
 		if (io_set_ao(start_index + i, values[i]) != IO_OK) {
 			return 1;
@@ -134,6 +332,16 @@ uint8_t automation_set_aos(uint8_t source_node_id, uint8_t start_index,
 uint8_t automation_get_dis(uint8_t source_node_id, uint8_t start_index,
 			   bool *values, uint8_t len)
 {
+#ifdef WITH_SYNC
+	if (sync_on) {
+		if (start_index + len > IO_DIS_NUM) {
+			return AUTOMATION_GETVALUES_RESPONSE_BAD_ARGUMENT;
+		}
+		memcpy(values, &synced_dis[start_index],
+		       len * sizeof(values[0]));
+		return AUTOMATION_GETVALUES_RESPONSE_OK;
+	}
+#endif
 	for (int i = 0; i < len; i++) {
 		switch (io_get_di(start_index + i, &values[i])) {
 		case IO_OK:
@@ -153,6 +361,16 @@ uint8_t automation_get_dis(uint8_t source_node_id, uint8_t start_index,
 uint8_t automation_get_ais(uint8_t source_node_id, uint8_t start_index,
 			   uint16_t *values, uint8_t len)
 {
+#ifdef WITH_SYNC
+	if (sync_on) {
+		if (start_index + len > IO_AIS_NUM) {
+			return AUTOMATION_GETVALUES_RESPONSE_BAD_ARGUMENT;
+		}
+		memcpy(values, &synced_ais[start_index],
+		       len * sizeof(values[0]));
+		return AUTOMATION_GETVALUES_RESPONSE_OK;
+	}
+#endif
 	for (int i = 0; i < len; i++) {
 		switch (io_get_ai(start_index + i, &values[i])) {
 		case IO_OK:
@@ -169,27 +387,196 @@ uint8_t automation_get_ais(uint8_t source_node_id, uint8_t start_index,
 	return AUTOMATION_GETVALUES_RESPONSE_OK;
 }
 
+// PLC maps all the points of the node, see plc/src/discovery.c
+void automation_get_inventory(uint8_t source_node_id,
+			      automation_GetInventoryResponse *inventory)
+{
+	inventory->dis_num = IO_DIS_NUM;
+	inventory->dos_num = IO_DOS_NUM;
+	inventory->ais_num = IO_AIS_NUM;
+	inventory->aos_num = IO_AOS_NUM;
+#ifdef WITH_TELL_INPUTS
+	inventory->tell_inputs = true;
+#endif
+}
+
+// ---------------------------------------------- inputs reporting -------------
+
+#ifdef WITH_TELL_INPUTS
+static bool told_dis[IO_DIS_NUM];
+static uint16_t told_ais[IO_AIS_NUM];
+
+static bool ai_changed(uint16_t old, uint16_t now)
+{
+	return (old > now ? old - now : now - old) > tell_ai_deadband;
+}
+
+/*
+Broadcast inputs which changed since they were told last time. To keep it
+simple, the whole range between the first and the last changed input is told.
+All inputs are told every tell_refresh_period, so lost messages do not matter
+much.
+*/
+void uavcan_tell_inputs()
+{
+	static uint32_t last_refresh = 0;
+	uint32_t now = hal_uptime_msec();
+	bool refresh = now - last_refresh >= tell_refresh_period;
+	int first, last;
+
+	if (refresh) {
+		last_refresh = now;
+	}
+
+	// digital
+	bool dis[IO_DIS_NUM];
+	first = refresh ? 0 : -1;
+	last = refresh ? (int)IO_DIS_NUM - 1 : -1;
+	for (uint8_t i = 0; i < IO_DIS_NUM; i++) {
+		if (io_get_di(i, &dis[i]) != IO_OK) {
+			dis[i] = told_dis[i];
+		}
+		if (dis[i] != told_dis[i]) {
+			if (first < 0) {
+				first = i;
+			}
+			last = i;
+		}
+	}
+	for (int i = first; first >= 0 && i <= last;
+	     i += AUTOMATION_DIGITALVALUES_VALUES_MAX_LENGTH) {
+		uint8_t len = min(last - i + 1,
+				  AUTOMATION_DIGITALVALUES_VALUES_MAX_LENGTH);
+		if (automation_send_tell_dis(i, &dis[i], len) >= 0) {
+			memcpy(&told_dis[i], &dis[i], len * sizeof(dis[0]));
+		}
+	}
+
+	// analog
+	uint16_t ais[IO_AIS_NUM];
+	first = refresh ? 0 : -1;
+	last = refresh ? (int)IO_AIS_NUM - 1 : -1;
+	for (uint8_t i = 0; i < IO_AIS_NUM; i++) {
+		if (io_get_ai(i, &ais[i]) != IO_OK) {
+			ais[i] = told_ais[i];
+		}
+		if (ai_changed(told_ais[i], ais[i])) {
+			if (first < 0) {
+				first = i;
+			}
+			last = i;
+		}
+	}
+	for (int i = first; first >= 0 && i <= last;
+	     i += AUTOMATION_ANALOGVALUES_VALUES_MAX_LENGTH) {
+		uint8_t len = min(last - i + 1,
+				  AUTOMATION_ANALOGVALUES_VALUES_MAX_LENGTH);
+		if (automation_send_tell_ais(i, &ais[i], len) >= 0) {
+			memcpy(&told_ais[i], &ais[i], len * sizeof(ais[0]));
+		}
+	}
+}
+#endif // ifdef WITH_TELL_INPUTS
+
+// ---------------------------------------------- parameters -------------------
+
+#if UAVCAN_WITH_PARAM_GETSET
+static const param_t slave_params[] = {
+#ifdef WITH_SYNC
+	{
+		.name = "sync.timeout_ms",
+		.type = PARAM_U16,
+		.flags = PARAM_PERSISTENT,
+		.value = &sync_timeout,
+		.def = SYNC_TIMEOUT,
+		.min = 1,
+		.max = 60000,
+	},
+#endif
+#ifdef WITH_TELL_INPUTS
+	{
+		.name = "tell.ai_deadband",
+		.type = PARAM_U16,
+		.flags = PARAM_PERSISTENT,
+		.value = &tell_ai_deadband,
+		.def = TELL_AI_DEADBAND,
+		.min = 0,
+		.max = 65535,
+	},
+	{
+		.name = "tell.refresh_ms",
+		.type = PARAM_U16,
+		.flags = PARAM_PERSISTENT,
+		.value = &tell_refresh_period,
+		.def = TELL_REFRESH_PERIOD,
+		.min = 0,
+		.max = 60000,
+	},
+	{
+		.name = "tell.sample_ms",
+		.type = PARAM_U16,
+		.flags = PARAM_PERSISTENT,
+		.value = &tell_sample_period,
+		.def = TELL_SAMPLE_PERIOD,
+		.min = 0,
+		.max = 60000,
+	},
+#endif
+};
+
+static int params_init(void)
+{
+	return params_register(slave_params,
+			       sizeof(slave_params) / sizeof(slave_params[0]));
+}
+#else
+// no way to set them, defaults are used
+static int params_init(void)
+{
+	return 0;
+}
+#endif // if UAVCAN_WITH_PARAM_GETSET
+
 // not used
 void uavcan_on_node_status(uint8_t source_node_id,
 			   uavcan_protocol_NodeStatus *node_status)
 {
 }
-void automation_on_get_dis_response(uint8_t source_node_id, uint8_t start_index,
-				    bool *values, uint8_t len)
+void automation_on_get_dis_response(uint8_t source_node_id,
+				    uint8_t transfer_id, uint8_t start_index,
+				    const automation_values_t *values)
+{
+}
+void automation_on_get_ais_response(uint8_t source_node_id,
+				    uint8_t transfer_id, uint8_t start_index,
+				    const automation_values_t *values)
 {
 }
-void automation_on_get_ais_response(uint8_t source_node_id, uint8_t start_index,
-				    uint16_t *values, uint8_t len)
+void automation_on_get_values_error(uint8_t source_node_id,
+				    uint8_t transfer_id, uint8_t index,
+				    uint8_t result)
 {
 }
-void automation_on_tell_dis(uint8_t source_node_id, uint8_t index, bool *values,
-			    uint8_t len)
+void automation_on_tell_dis(uint8_t source_node_id, uint8_t index,
+			    const automation_values_t *values)
 {
 }
 void automation_on_tell_ais(uint8_t source_node_id, uint8_t index,
-			    uint16_t *values, uint8_t len)
+			    const automation_values_t *values)
+{
+}
+void automation_on_get_inventory_response(
+	uint8_t source_node_id, uint8_t transfer_id,
+	const automation_GetInventoryResponse *inventory)
+{
+}
+#if UAVCAN_WITH_NODE_TABLE && !defined(WITH_FAILSAFE)
+void uavcan_on_remote_node_event(uint8_t node_id,
+				 uavcan_remote_node_event_t event,
+				 const uavcan_remote_node_t *remote)
 {
 }
+#endif
 
 // ---------------------------------------------- UAVCAN callbacks -------------
 
@@ -202,3 +589,21 @@ uint32_t uavcan_uptime_sec()
 {
 	return hal_uptime_msec() / 1000;
 }
+
+#ifdef POSIX
+// Arduino boards implement these in their HAL
+
+void uavcan_restart(void)
+{
+	hal_restart();
+}
+
+void uavcan_error(const char *fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	vprintf(fmt, args);
+	va_end(args);
+	printf("\n");
+}
+#endif // ifdef POSIX
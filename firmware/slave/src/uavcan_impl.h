@@ -6,6 +6,19 @@ extern "C" {
 
 int uavcan2_init(void);
 void print_frame(const char *direction, const CanardCANFrame *frame);
+void uavcan_tell_inputs(void);
+void uavcan_check_sync(void);
+
+/*
+Value for NodeStatus.vendor_specific_status_code:
+
+    bits 0-7    peak UAVCAN memory pool usage in %
+    bits 8-15   transfers dropped for lack of memory (saturated to 255)
+*/
+uint16_t uavcan_vendor_status(void);
+
+// inputs sampling period (TELL_SAMPLE_PERIOD, tell.sample_ms parameter) [ms]
+extern uint16_t tell_sample_period;
 
 #ifdef __cplusplus
 }